@@ -0,0 +1,136 @@
+#define _GNU_SOURCE
+#include "usrl_ring.h"
+#include "usrl_core.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*
+ * Region init + attach latency.
+ *
+ * Each iteration creates a fresh region with the config.json topic set,
+ * then attaches the way a restarting component does: map, resolve every
+ * topic, init a publisher and a subscriber on each. Resident pages after
+ * attach show how much of the region was actually faulted in.
+ */
+
+#define SHM_PATH "/usrl-bench-init"
+#define DEFAULT_SIZE_MB 512
+#define DEFAULT_ITERS 50
+
+static const UsrlTopicConfig g_topics[] = {
+    {"small_ring_swmr", 128, 64, USRL_RING_TYPE_SWMR, 0},
+    {"large_ring_swmr", 16384, 64, USRL_RING_TYPE_SWMR, 0},
+    {"huge_msg_swmr", 1024, 8192, USRL_RING_TYPE_SWMR, 0},
+    {"mwmr_std", 8192, 64, USRL_RING_TYPE_MWMR, 0},
+    {"mwmr_contention", 128, 64, USRL_RING_TYPE_MWMR, USRL_TOPIC_FAIR},
+    {"tcp_requests", 4096, 4096, USRL_RING_TYPE_SWMR, 0},
+    {"tcp_responses", 4096, 4096, USRL_RING_TYPE_SWMR, 0},
+    {"udp_requests", 4096, 4096, USRL_RING_TYPE_SWMR, 0},
+    {"udp_responses", 4096, 4096, USRL_RING_TYPE_SWMR, 0},
+};
+#define TOPIC_COUNT (sizeof(g_topics) / sizeof(g_topics[0]))
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t resident_kb(void *base, uint64_t size)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    size_t pages = (size + page - 1) / page;
+    unsigned char *vec = malloc(pages);
+    if (!vec) return 0;
+
+    uint64_t resident = 0;
+    if (mincore(base, size, vec) == 0) {
+        for (size_t i = 0; i < pages; i++) resident += (vec[i] & 1);
+    }
+    free(vec);
+    return resident * (uint64_t)page / 1024;
+}
+
+static void report(const char *name, uint64_t *samples, int n)
+{
+    qsort(samples, n, sizeof(uint64_t), cmp_u64);
+    printf("[BENCH] %-7s min %8.1f us | p50 %8.1f us | max %8.1f us\n",
+           name, samples[0] / 1e3, samples[n / 2] / 1e3, samples[n - 1] / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    int size_mb = (argc >= 2) ? atoi(argv[1]) : DEFAULT_SIZE_MB;
+    int iters = (argc >= 3) ? atoi(argv[2]) : DEFAULT_ITERS;
+    if (size_mb <= 0 || iters <= 0) {
+        printf("Usage: %s [size_mb] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t size = (uint64_t)size_mb * 1024 * 1024;
+    uint64_t *init_ns = calloc(iters, sizeof(uint64_t));
+    uint64_t *attach_ns = calloc(iters, sizeof(uint64_t));
+    uint64_t rss_kb = 0;
+
+    printf("[BENCH] Init/attach: %d MB region, %zu topics, %d iterations\n",
+           size_mb, TOPIC_COUNT, iters);
+
+    for (int i = 0; i < iters; i++) {
+        shm_unlink(SHM_PATH);
+
+        uint64_t t0 = now_ns();
+        int rc = usrl_core_init(SHM_PATH, size, g_topics, TOPIC_COUNT);
+        uint64_t t1 = now_ns();
+        if (rc != 0) {
+            printf("[BENCH] Error: usrl_core_init rc=%d\n", rc);
+            shm_unlink(SHM_PATH);
+            return 1;
+        }
+
+        uint64_t t2 = now_ns();
+        void *base = usrl_core_map(SHM_PATH, 0);
+        if (!base) {
+            printf("[BENCH] Error: usrl_core_map failed\n");
+            shm_unlink(SHM_PATH);
+            return 1;
+        }
+        for (size_t k = 0; k < TOPIC_COUNT; k++) {
+            UsrlSubscriber sub;
+            usrl_sub_init(&sub, base, g_topics[k].name);
+            if (g_topics[k].type == USRL_RING_TYPE_MWMR) {
+                UsrlMwmrPublisher mp;
+                usrl_mwmr_pub_init(&mp, base, g_topics[k].name, 1);
+            } else {
+                UsrlPublisher sp;
+                usrl_pub_init(&sp, base, g_topics[k].name, 1);
+            }
+        }
+        uint64_t t3 = now_ns();
+
+        init_ns[i] = t1 - t0;
+        attach_ns[i] = t3 - t2;
+        if (i == iters - 1) rss_kb = resident_kb(base, size);
+
+        usrl_core_unmap(base, size);
+    }
+    shm_unlink(SHM_PATH);
+
+    report("init", init_ns, iters);
+    report("attach", attach_ns, iters);
+    printf("[BENCH] Resident after attach: %lu KB of %d MB\n", rss_kb, size_mb);
+
+    free(init_ns);
+    free(attach_ns);
+    return 0;
+}
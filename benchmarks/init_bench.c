@@ -73,6 +73,7 @@ int main(void)
     fclose(f);
 
     UsrlTopicConfig topics[MAX_CONFIG_TOPICS];
+    memset(topics, 0, sizeof(topics));
     int count = 0;
 
     // Default 128MB
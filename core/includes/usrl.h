@@ -14,6 +14,7 @@
 #include <stddef.h>
 
 #include "usrl_logging.h"
+#include "usrl_schema.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +52,14 @@ typedef struct {
     const char *app_name;
     UsrlLogLevel log_level;
     const char *log_file_path; // NULL for stderr
+    uint32_t log_buffer_kb;    // 0 = synchronous logging; else async, per-thread buffer size
+
+    /* Shared region (optional): NULL = one SHM object per topic.
+     * Otherwise every topic this context creates lives in this region,
+     * e.g. "/usrl-region", with rings sized exactly to their config. */
+    const char *shm_region;
+    uint32_t shm_region_size_mb; // 0 = 256
+    uint32_t max_topics;         // 0 = 256
 } usrl_sys_config_t;
 
 /**
@@ -68,9 +77,13 @@ typedef struct {
     uint64_t rate_limit_hz; // 0 = Unlimited
     bool block_on_full;     // true = Spin wait, false = Drop immediately
     
-    /* Schema (Optional) */
+    /* Schema (Optional): a name given to usrl_schema_register(), bound to
+     * the topic on create (possibly as a new version); or the name of the
+     * schema the topic already has. Messages carry its id and version */
     const char *schema_name;
-    // (In a full implementation, you'd pass schema definition fields here)
+
+    /* Rate limit burst: messages allowed back to back (0/1 = strict pacing) */
+    uint32_t rate_burst;
 } usrl_pub_config_t;
 
 /**
@@ -84,6 +97,20 @@ typedef struct {
     bool healthy;           // Based on internal thresholds
 } usrl_health_t;
 
+/**
+ * @brief Publish-to-consume latency of one subscriber (nanoseconds).
+ * Percentiles are bucket upper edges, accurate to within 12.5%.
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} usrl_latency_t;
+
 /* ============================================================================
  * 3. SYSTEM LIFECYCLE
  * ============================================================================ */
@@ -115,12 +142,33 @@ usrl_pub_t *usrl_pub_create(usrl_ctx_t *ctx, const usrl_pub_config_t *config);
  */
 int usrl_pub_send(usrl_pub_t *pub, const void *data, uint32_t len);
 
+/**
+ * @brief Build a message directly in the next slot, no copy.
+ * usrl_pub_send_begin() returns the slot's payload area (at least len bytes,
+ * the slot's payload size at most), or NULL like a failed send; fill it and
+ * call usrl_pub_send_commit() with the bytes written, or
+ * usrl_pub_send_abort() to drop the message. Every successful begin must end
+ * in one of the two, soon: readers wait on the slot until it does.
+ * usrl_message_build_in() lays a schema message out in the returned area.
+ */
+void *usrl_pub_send_begin(usrl_pub_t *pub, uint32_t len);
+int usrl_pub_send_commit(usrl_pub_t *pub, uint32_t len);
+int usrl_pub_send_abort(usrl_pub_t *pub);
+
 /**
  * @brief Get health metrics for this specific publisher.
  * Wraps usrl_health_get().
  */
 void usrl_pub_get_health(usrl_pub_t *pub, usrl_health_t *out);
 
+/**
+ * @brief Tell usrl-watchdog this publisher is alive, and promise the next
+ * beat within period_ms (0 withdraws the promise). Without a promise an idle
+ * publisher is never reported stalled, only dead. Returns 0, or -1 if the
+ * publisher has no writer entry.
+ */
+int usrl_pub_heartbeat(usrl_pub_t *pub, uint32_t period_ms);
+
 /**
  * @brief Destroy publisher.
  */
@@ -132,19 +180,74 @@ void usrl_pub_destroy(usrl_pub_t *pub);
 
 /**
  * @brief Create a subscriber.
+ * If the topic has a schema it is attached here, once; creation fails when
+ * a schema registered in this process under the same name is not a
+ * compatible version of it. With one registered, the subscriber's schema is
+ * that version, else the newest bound.
  */
 usrl_sub_t *usrl_sub_create(usrl_ctx_t *ctx, const char *topic);
 
+/**
+ * @brief Layout of the topic's messages, or NULL if it has no schema.
+ * Owned by the subscriber.
+ */
+const UsrlSchema *usrl_sub_schema(usrl_sub_t *sub);
+
+/**
+ * @brief Schema version the last received message was written in (0 if its
+ * publisher stamps none). Read it with a UsrlSchemaReader when it differs
+ * from usrl_sub_schema()'s version.
+ */
+uint32_t usrl_sub_schema_version(usrl_sub_t *sub);
+
 /**
  * @brief Receive data.
  */
 int usrl_sub_recv(usrl_sub_t *sub, void *buffer, uint32_t max_len);
 
+/**
+ * @brief Receive the next message in place, no copy (see usrl_sub_peek).
+ * usrl_sub_recv_peek() points *payload into the slot and returns the length,
+ * -11 (no data) or -1. Read it, e.g. through usrl_message_view(), then call
+ * usrl_sub_recv_done(): 0 if the message was intact, -1 if a writer
+ * overwrote it meanwhile and what was read must be discarded.
+ */
+int usrl_sub_recv_peek(usrl_sub_t *sub, const uint8_t **payload);
+int usrl_sub_recv_done(usrl_sub_t *sub);
+
+/**
+ * @brief Receive up to max messages as columns, one array per schema field
+ * (see usrl_sub_drain_columnar). Needs a topic with a schema. A message of
+ * another schema version ends the batch unread; take it with usrl_sub_recv.
+ * Returns the rows received (0 = no data), or -1 if the topic has no schema.
+ */
+int usrl_sub_recv_columnar(usrl_sub_t *sub, void *const cols[], uint32_t max);
+
 /**
  * @brief Get health metrics for this specific subscriber (Lag, throughput).
  */
 void usrl_sub_get_health(usrl_sub_t *sub, usrl_health_t *out);
 
+/**
+ * @brief Start recording end-to-end latency for every message received.
+ * Costs one clock read per message. The histogram lives in shared memory,
+ * so usrl-top can show it too. Returns 0, or -1 if unavailable.
+ */
+int usrl_sub_enable_latency(usrl_sub_t *sub);
+
+/**
+ * @brief Latency percentiles since usrl_sub_enable_latency().
+ * Returns 0, or -1 if latency tracking is not enabled.
+ */
+int usrl_sub_get_latency_histogram(usrl_sub_t *sub, usrl_latency_t *out);
+
+/**
+ * @brief Tell usrl-watchdog this subscriber is alive, and promise the next
+ * beat within period_ms (0 withdraws the promise). Returns 0, or -1 if the
+ * subscriber has no reader entry.
+ */
+int usrl_sub_heartbeat(usrl_sub_t *sub, uint32_t period_ms);
+
 void usrl_sub_destroy(usrl_sub_t *sub);
 
 void usrl_set_default_shm_size_mb(uint32_t mb);
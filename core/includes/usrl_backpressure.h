@@ -3,12 +3,23 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "usrl_core.h"
+#include "usrl_clock.h"
 
+/*
+ * Rate limiter: GCRA (virtual scheduling form of a token bucket).
+ *
+ * Each message advances a theoretical arrival time (tat) by one emission
+ * interval T = 1/rate. A message arriving at `now` conforms if
+ * now >= tat - tolerance, where tolerance = (burst - 1) * T, so up to
+ * `burst` messages may go back to back and the long-run rate is exact.
+ * All times are usrl_ticks().
+ */
 typedef struct {
-    uint64_t publish_quota;          /* messages allowed per window */
-    uint64_t publish_window_ns;      /* window length in ns */
-    uint64_t last_window_start_ns;   /* start time of current window */
-    uint64_t msgs_in_window;         /* count in current window */
+    uint64_t emission_ticks;         /* T; 0 = limiter disabled */
+    uint64_t tolerance_ticks;        /* (burst - 1) * T */
+    uint64_t tat;                    /* theoretical arrival time */
+    uint32_t burst;                  /* max back-to-back messages */
     uint64_t total_throttled;        /* total throttled events */
 } PublishQuota;
 
@@ -27,37 +38,78 @@ typedef struct {
     bool is_lagging;
 } UsrlLagTracker;
 
-/*
- * Fixed-window rate limiter init.
- *
- * Design:
- * - 1ms windows (1,000,000 ns) to keep counters bounded and checks cheap.
- * - publish_quota is msgs allowed per 1ms window.
- * - We round up so low rates (e.g., 50 msg/sec) still allow traffic:
- *     quota_per_ms = ceil(msgs_per_sec / 1000).
- */
+/* msgs_per_sec == 0 disables the limiter; burst 0 is treated as 1 */
+void usrl_quota_init_burst(PublishQuota *quota, uint64_t msgs_per_sec, uint32_t burst);
+
+/* Strict pacing: no bursts, messages spaced by exactly 1/rate */
 static inline void usrl_quota_init(PublishQuota *quota, uint64_t msgs_per_sec)
 {
-    if (!quota) return;
-
-    /* Always initialize */
-    quota->publish_window_ns = 1000000ULL; /* 1 ms */
-    quota->last_window_start_ns = 0;
-    quota->msgs_in_window = 0;
-    quota->total_throttled = 0;
-
-    if (msgs_per_sec == 0) {
-        /* Disabled limiter: allow "effectively infinite" per window */
-        quota->publish_quota = UINT64_MAX;
-        return;
-    }
-
-    uint64_t per_ms = (msgs_per_sec + 999ULL) / 1000ULL; /* ceil division */
-    if (per_ms == 0) per_ms = 1;
-    quota->publish_quota = per_ms;
+    usrl_quota_init_burst(quota, msgs_per_sec, 1);
 }
 
-int usrl_quota_check(PublishQuota *quota); /* returns 1 when throttled, 0 when allowed */
+/*
+ * Non-blocking batch check: admits all `n` messages (returns 0) or none
+ * (returns 1). n > burst never conforms.
+ */
+int usrl_quota_acquire(PublishQuota *quota, uint32_t n);
+
+/* Spin until `n` messages conform, then admit them. Returns ns waited. */
+uint64_t usrl_quota_wait(PublishQuota *quota, uint32_t n);
+
+/* --------------------------------------------------------------------------
+ * Lag policy engine
+ *
+ * A publisher-side handle that watches the slowest registered subscriber of
+ * a topic (UsrlReaderTable) and applies the topic's UsrlBackpressureMode:
+ *
+ *   DROP     : refuse messages while the slowest reader lags >= threshold
+ *   BLOCK    : wait (bounded by block_max_us) for the reader to catch up
+ *   THROTTLE : spin a delay that ramps from 0 at the threshold to
+ *              throttle_max_ns when the reader is a full ring behind
+ *
+ * Lag is sampled every `sample_every` messages while healthy and on every
+ * message once lagging, so the healthy fast path is one decrement. Readers
+ * past the threshold are checked for a dead process (kill(pid, 0)) at most
+ * once per USRL_BP_PROBE_NS, not on every sample.
+ * -------------------------------------------------------------------------- */
+#define USRL_BP_SAMPLE_EVERY 64
+#define USRL_BP_PROBE_NS 1000000     /* min interval between dead-reader probes */
+#define USRL_BP_THROTTLE_MAX_NS 2000 /* default THROTTLE delay at full lag */
+#define USRL_BP_BLOCK_MAX_US 1000    /* default BLOCK bound per message */
+
+typedef struct {
+    RingDesc *desc;
+    UsrlReaderTable *readers;
+    UsrlLagTracker lag;      /* last sample (slowest reader) */
+    uint32_t sample_every;
+    uint32_t countdown;
+    uint64_t probe_ns;       /* last dead-reader probe (usrl_now_ns) */
+    uint64_t total_dropped;  /* DROP refusals */
+    uint64_t total_blocked;  /* BLOCK waits (incl. ones that hit the bound) */
+    uint64_t total_delay_ns; /* THROTTLE/BLOCK time spent */
+} UsrlLagPolicy;
+
+/* Bind to a topic. Returns 0, or -1 if the topic does not exist. */
+int usrl_lag_policy_init(UsrlLagPolicy *lp, void *core_base, const char *topic);
+
+/*
+ * Call before each publish. Returns 1 when the message should be dropped,
+ * 0 when it may be published (possibly after a delay).
+ */
+int usrl_lag_policy_admit(UsrlLagPolicy *lp);
+
+/* Set a topic's policy in the region. threshold 0 = slot_count / 2. */
+int usrl_bp_set_policy(void *core_base, const char *topic, UsrlBackpressureMode mode,
+                       uint32_t lag_threshold);
+
+/* Tune THROTTLE's delay at full lag and BLOCK's per-message bound (0 = default) */
+int usrl_bp_set_limits(void *core_base, const char *topic, uint32_t throttle_max_ns,
+                       uint32_t block_max_us);
+
+/* Busy-wait for `ns` nanoseconds without entering the kernel */
+void usrl_spin_ns(uint64_t ns);
+
+int usrl_quota_check(PublishQuota *quota); /* acquire(1): 1 when throttled, 0 when allowed */
 int usrl_backpressure_check_lag(uint64_t lag, uint64_t threshold);
 uint64_t usrl_backoff_exponential(uint32_t attempt); /* ns */
 uint64_t usrl_backoff_linear(uint64_t lag, uint64_t max_lag); /* us (as currently implemented) */
@@ -0,0 +1,77 @@
+/**
+ * @file usrl_checkpoint.h
+ * @brief Region checkpoint (snapshot to file) and fast restore.
+ */
+
+#ifndef USRL_CHECKPOINT_H
+#define USRL_CHECKPOINT_H
+
+#include "usrl_core.h"
+#include "usrl_schema.h"
+#include <stdint.h>
+
+/* --------------------------------------------------------------------------
+ * File layout
+ *
+ *   UsrlCheckpointHeader
+ *   { UsrlCheckpointTopic, slot_count * slot_size bytes of ring image,
+ *     schema_count UsrlShmSchema (the topic's bound versions, oldest first) } * N
+ *
+ * The ring image is a verbatim copy of the slots. Slots that were being
+ * written while the snapshot ran (or never committed) have seq == 0 in the
+ * image. Restore keeps the run of consecutive seqs ending at w_head and
+ * moves the ring's floor_seq up to where that run starts.
+ * -------------------------------------------------------------------------- */
+#define USRL_CHECKPOINT_MAGIC   0x55534B43  /* 'USKC' */
+#define USRL_CHECKPOINT_VERSION 2
+
+typedef struct
+{
+    uint32_t magic;       /* USRL_CHECKPOINT_MAGIC */
+    uint32_t version;     /* USRL_CHECKPOINT_VERSION */
+    uint32_t layout;      /* USRL_LAYOUT_VERSION of the source region */
+    uint32_t topic_count; /* topic records that follow */
+    uint64_t created_ns;  /* CLOCK_REALTIME at snapshot start */
+} UsrlCheckpointHeader;
+
+typedef struct
+{
+    char name[USRL_MAX_TOPIC_NAME];
+    uint32_t type;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t schema_count; /* UsrlShmSchema records after the image */
+    uint64_t w_head;      /* highest seq captured in the image */
+    uint64_t image_bytes; /* slot_count * slot_size */
+} UsrlCheckpointTopic;
+
+/**
+ * Snapshot every topic of a mapped region into `file_path`.
+ * Safe to run while publishers are active; each slot is copied under its
+ * seqlock and dropped from the image if it changed during the copy.
+ *
+ * Returns number of topics written, or:
+ *  -1 : invalid params / not a USRL region
+ *  -2 : cannot create or write the file
+ *  -3 : out of memory
+ */
+int usrl_checkpoint_save(void *base, const char *file_path);
+
+/**
+ * Restore a checkpoint into a mapped region. Topics are matched by name and
+ * must have the same slot_size; slot_count may differ (slots are re-placed
+ * by sequence). Only topics that have not been published to yet are
+ * restored, and no publisher may start on them until this returns. The
+ * topic's schema versions are bound as well; a topic whose binding conflicts
+ * with the saved one (usrl_schema_check) is left alone.
+ * Subscribers already attached skip to the first restored message.
+ *
+ * Returns number of topics restored, or:
+ *  -1 : invalid params / not a USRL region
+ *  -2 : cannot open or map the file
+ *  -3 : file is not a valid checkpoint, or was saved under another
+ *       region layout version
+ */
+int usrl_checkpoint_restore(void *base, const char *file_path);
+
+#endif /* USRL_CHECKPOINT_H */
@@ -0,0 +1,69 @@
+/**
+ * @file usrl_clock.h
+ * @brief Cheap monotonic tick counter for pacing and timestamps.
+ *
+ * On x86 with an invariant TSC and on aarch64 (CNTVCT) ticks come straight
+ * from the hardware counter (~10-25 cycles, no vDSO call). Everywhere else
+ * they fall back to CLOCK_MONOTONIC nanoseconds. Either way ticks are
+ * monotonic and comparable across threads of one process; convert with
+ * usrl_ticks_to_ns / usrl_ns_to_ticks, never assume 1 tick == 1 ns.
+ *
+ * usrl_clock_init() picks the source and calibrates it (a few ms, once per
+ * process). Call it before taking ticks; the rate limiter and lag policy
+ * do so from their init functions.
+ */
+
+#ifndef USRL_CLOCK_H
+#define USRL_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+typedef struct {
+    bool hw;                 /* ticks come from TSC / CNTVCT */
+    uint64_t ticks_per_sec;  /* 1e9 when falling back to ns */
+    uint64_t mult;           /* ns = ticks * mult >> 32 */
+    uint64_t inv_mult;       /* ticks = ns * inv_mult >> 32 */
+} UsrlClock;
+
+extern UsrlClock usrl_clock;
+
+void usrl_clock_init(void);
+
+static inline uint64_t usrl_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t usrl_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_expect(usrl_clock.hw, 1)) {
+        uint32_t lo, hi;
+        __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+        return ((uint64_t)hi << 32) | lo;
+    }
+#elif defined(__aarch64__)
+    if (__builtin_expect(usrl_clock.hw, 1)) {
+        uint64_t v;
+        __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+        return v;
+    }
+#endif
+    return usrl_clock_ns();
+}
+
+static inline uint64_t usrl_ticks_to_ns(uint64_t ticks)
+{
+    return (uint64_t)(((unsigned __int128)ticks * usrl_clock.mult) >> 32);
+}
+
+static inline uint64_t usrl_ns_to_ticks(uint64_t ns)
+{
+    return (uint64_t)(((unsigned __int128)ns * usrl_clock.inv_mult) >> 32);
+}
+
+#endif /* USRL_CLOCK_H */
@@ -22,10 +22,16 @@
  * Constants & Configuration
  * -------------------------------------------------------------------------- */
 #define USRL_MAGIC 0x5553524C  /* 'USRL' */
+#define USRL_LAYOUT_VERSION 14 /* bumped on any SHM layout change */
 #define USRL_MAX_TOPIC_NAME 64 /* bytes */
 #define USRL_ALIGNMENT 64      /* region alignment (cache line) */
 #define USRL_RING_TYPE_SWMR 0  /* single-writer, multi-reader */
 #define USRL_RING_TYPE_MWMR 1  /* multi-writer, multi-reader */
+#define USRL_MAX_WRITERS 16    /* writer table entries per topic */
+#define USRL_MAX_READERS 16    /* registered subscriber entries per topic */
+
+/* Topic flags (UsrlTopicConfig.flags / TopicEntry.flags) */
+#define USRL_TOPIC_FAIR (1u << 0) /* MWMR: enforce weighted per-writer shares */
 
 /* --------------------------------------------------------------------------
  * Compiler Hints for Optimization
@@ -34,6 +40,27 @@
 #define USRL_UNLIKELY(x) __builtin_expect(!!(x), 0)
 #define USRL_PREFETCH_R(x) __builtin_prefetch((x), 0, 3) /* read, high locality */
 #define USRL_PREFETCH_W(x) __builtin_prefetch((x), 1, 3) /* write, high locality */
+#define USRL_NOINLINE __attribute__((noinline, cold))   /* keep slow paths out of hot loops */
+
+/* --------------------------------------------------------------------------
+ * Memory Ordering (slot seqlock)
+ *
+ * Each slot is a seqlock keyed on SlotHeader.seq:
+ *   writer : seq = claim|BUSY (relaxed); WMB; payload; seq = claim (release)
+ *   reader : s1 = seq (acquire); payload; RMB; s2 = seq (relaxed); s1 == s2
+ *
+ * USRL_SMP_WMB orders the BUSY store before the payload stores and
+ * USRL_SMP_RMB orders the payload loads before the re-check. Both are full
+ * C11 release / acquire fences on every architecture (compiler barriers on
+ * x86, dmb ish / dmb ishld on aarch64). The store-only dmb ishst writer
+ * barrier and relaxed w_head claims are not used until the model-checker
+ * cases in examples/litmus/ have been run against them.
+ * -------------------------------------------------------------------------- */
+#define USRL_SMP_WMB() atomic_thread_fence(memory_order_release)
+#define USRL_SMP_RMB() atomic_thread_fence(memory_order_acquire)
+
+#define USRL_SEQ_BUSY (1ULL << 63) /* set in SlotHeader.seq while a write is in flight */
+#define USRL_HEAD_RESIZING (1ULL << 63) /* set in RingDesc.w_head while a resize runs */
 
 /* --------------------------------------------------------------------------
  * Topic Table Entry
@@ -48,6 +75,10 @@ typedef struct
     uint32_t slot_count;            /* normalized to a power-of-two */
     uint32_t slot_size;             /* size of each slot (including header) */
     uint32_t type;                  /* USRL_RING_TYPE_* */
+    uint32_t flags;                 /* USRL_TOPIC_* */
+    uint64_t writers_offset;        /* offset to this topic's UsrlWriterTable */
+    uint64_t readers_offset;        /* offset to this topic's UsrlReaderTable */
+    atomic_uint_fast64_t schema_offset; /* UsrlShmSchema bound to the topic, 0 = none */
 } TopicEntry;
 
 /* --------------------------------------------------------------------------
@@ -73,50 +104,82 @@ typedef struct
     uint32_t slot_count; /* requested slots (will be rounded to power-of-two) */
     uint32_t slot_size;  /* user payload size (slot header added automatically) */
     uint32_t type;       /* USRL_RING_TYPE_SWMR or USRL_RING_TYPE_MWMR */
+    uint32_t flags;      /* USRL_TOPIC_* (0 for defaults) */
 } UsrlTopicConfig;
 
 /* --------------------------------------------------------------------------
  * Core Header (top of the SHM region)
  *
  * Describes the mapped region: magic/version/size and where the topic table
- * lives along with the topic_count.
+ * lives along with the topic_count. magic is written last during init, so a
+ * mapper that sees USRL_MAGIC also sees a complete topic table.
+ *
+ * generation is never 0. Rings inherit it and every committed slot carries
+ * it, so memory that was never written (or belongs to an older layout of the
+ * same bytes) is rejected without having to be cleared first. A checkpoint
+ * restore moves the ring to the next generation (and bumps its epoch, so
+ * attached handles reload it); slots stamped by a handle that has not
+ * caught up yet are dropped by readers.
+ *
+ * alloc_offset is a bump pointer into the unused tail of the region, used
+ * for structures created after init (e.g. rings grown by usrl_ring_resize).
+ * Space handed out is never returned.
+ *
+ * The topic table has room for topic_capacity entries; topics beyond the
+ * initial set are appended by usrl_core_add_topic under topic_lock (holder
+ * pid) and become visible when topic_count is stored with release.
  * -------------------------------------------------------------------------- */
 typedef struct
 {
     uint32_t magic;              /* must equal USRL_MAGIC */
-    uint32_t version;            /* layout version (starts at 1) */
+    uint32_t version;            /* USRL_LAYOUT_VERSION */
     uint64_t mmap_size;          /* total size of the mapped region */
-    uint64_t topic_table_offset; /* offset to TopicEntry[topic_count] */
-    uint32_t topic_count;        /* number of topics in the table */
-    uint32_t _pad;               /* reserved / alignment */
+    uint64_t topic_table_offset; /* offset to TopicEntry[topic_capacity] */
+    atomic_uint_least32_t topic_count; /* number of topics in the table */
+    uint32_t generation;         /* region generation (non-zero) */
+    atomic_uint_fast64_t alloc_offset; /* next free byte for runtime allocations */
+    uint32_t topic_capacity;     /* TopicEntry slots in the table */
+    atomic_uint_least32_t topic_lock; /* pid adding a topic, 0 = free */
+    atomic_uint_least32_t pub_id_seq; /* last pub_id handed out */
 } CoreHeader;
 
 /* --------------------------------------------------------------------------
  * Slot Header (prefixed at the start of each slot)
  *
  * Designed to be atomically published by writers:
+ *   - seq is set to (claim | USRL_SEQ_BUSY) before the payload is touched.
  *   - seq is written last (memory_order_release) to signal completion.
- *   - readers use seq to detect fully-committed slots.
+ *   - readers use seq to detect fully-committed slots and torn copies.
  *
  * Fields:
  *   seq          : monotonic commit sequence (0 == unused)
  *   timestamp_ns : wall-clock timestamp for the write
- *   payload_len  : number of bytes in the payload
+ *   payload_len  : number of bytes in the payload; USRL_SLOT_ABORTED marks
+ *                  a reservation given back (usrl_pub_abort), which readers
+ *                  step over
  *   pub_id       : publisher id (new field — who wrote this slot)
+ *   gen          : RingDesc.generation at write time; a slot whose gen does
+ *                  not match its ring is treated as empty
+ *   schema_id/ver: schema the payload is laid out in (usrl_pub_set_schema),
+ *                  0 when the writer did not declare one
  * -------------------------------------------------------------------------- */
 typedef struct __attribute__((aligned(64)))
 {
     atomic_uint_fast64_t seq; /* commit sequence; 0 == empty/uninitialized */
     uint64_t timestamp_ns;
     uint32_t payload_len;
-    uint16_t pub_id; /* publisher identity */
-    uint16_t _pad;   /* pad to 8-byte boundary */
+    uint16_t pub_id;     /* publisher identity */
+    uint16_t schema_ver; /* writer's schema version, 0 = none */
+    uint32_t gen;        /* ring generation that wrote this slot */
+    uint32_t schema_id;  /* writer's schema id */
 } SlotHeader;
 
 #ifndef __cplusplus
 _Static_assert(sizeof(SlotHeader) % 8 == 0, "header size alignment wrong");
 #endif
 
+#define USRL_SLOT_ABORTED UINT32_MAX /* payload_len of an aborted reservation */
+
 /* --------------------------------------------------------------------------
  * Ring Descriptor
  *
@@ -128,6 +191,16 @@ _Static_assert(sizeof(SlotHeader) % 8 == 0, "header size alignment wrong");
  * Note: tail/reader state is maintained by subscribers locally (not in the
  * RingDesc) to keep the core small and avoid concurrent writes from readers.
  *
+ * Resize: slot_count/base_offset may change at runtime. epoch is bumped
+ * (release) after the new geometry is in place; handles cache the geometry
+ * and re-read it when their cached epoch no longer matches. While a resize
+ * is running USRL_HEAD_RESIZING is set in w_head, so use usrl_ring_head()
+ * rather than loading w_head directly.
+ *
+ * floor_seq: messages up to it were not carried into the current ring (older
+ * than the window a resize copied). Readers below it jump to it when they
+ * take up the geometry, instead of waiting on slots that will stay empty.
+ *
  * FIX #12: Align to cache line to prevent false sharing on w_head.
  * -------------------------------------------------------------------------- */
 typedef struct __attribute__((aligned(USRL_ALIGNMENT)))
@@ -136,9 +209,148 @@ typedef struct __attribute__((aligned(USRL_ALIGNMENT)))
     uint32_t slot_size;
     uint64_t base_offset;        /* offset to first slot (from region base) */
     atomic_uint_fast64_t w_head; /* writers atomically increment this */
-    uint8_t _pad[32];            /* reserved for future extension */
+    uint32_t generation;         /* slot validity stamp, bumped by restore */
+    atomic_uint_least32_t epoch; /* geometry version, bumped by resize */
+    atomic_uint_fast64_t floor_seq; /* seqs <= floor are gone (resize, restore) */
+    uint8_t _pad[24];            /* reserved for future extension */
 } RingDesc;
 
+/* --------------------------------------------------------------------------
+ * Writer Table
+ *
+ * One per topic, indexed by publisher. An entry is claimed by the first
+ * publisher handle that attaches with a given pub_id (unique within the
+ * region, see usrl_core_pub_id); entries of processes that have exited are
+ * recycled. Counters are written only by the owning handle (plain relaxed
+ * stores, see usrl_writer_count) and read by tools, so per-writer rates are
+ * visible across processes without touching w_head.
+ *
+ * On USRL_TOPIC_FAIR topics the claim stream is cut into windows of
+ * slot_count sequence numbers; within a window a writer may claim
+ * slot_count * weight / total_weight of them while any other writer that
+ * was active in the current or previous window, and claimed within the last
+ * USRL_FAIR_IDLE_NS, is still under its share. Refused claims do not move
+ * w_head, so the window alone never expires a writer that went quiet.
+ * -------------------------------------------------------------------------- */
+/* Liveness word in every writer and reader entry (usrl_heartbeat) */
+typedef struct
+{
+    atomic_uint_fast64_t tick;           /* beats so far */
+    atomic_uint_fast64_t beat_ns;        /* CLOCK_MONOTONIC of the last beat */
+    atomic_uint_least32_t period_ms;     /* promised beat period, 0 = none */
+} UsrlHeartbeat;
+
+typedef struct
+{
+    atomic_uint_least32_t owner;         /* pub_id + 1, 0 = free */
+    atomic_uint_least32_t weight;        /* fair share weight (>= 1) */
+    atomic_uint_fast64_t claimed;        /* sequence numbers claimed */
+    atomic_uint_fast64_t timeouts;       /* publishes that returned TIMEOUT */
+    atomic_uint_fast64_t throttled;      /* publishes refused over fair share */
+    atomic_uint_fast64_t window;         /* fairness window last seen */
+    atomic_uint_fast64_t window_claims;  /* claims made in `window` */
+    atomic_uint_fast64_t published;      /* messages committed */
+    atomic_uint_fast64_t dropped;        /* refused by the facade (rate, lag, full) or aborted */
+    atomic_uint_fast64_t claim_seq;      /* MWMR seq claimed, not yet committed; 0 = none */
+    atomic_uint_fast64_t claim_ns;       /* CLOCK_MONOTONIC of that (or the last) claim */
+    UsrlHeartbeat hb;
+    uint32_t pid;                        /* owning process */
+} __attribute__((aligned(USRL_ALIGNMENT))) UsrlWriterEntry;
+
+typedef struct
+{
+    atomic_uint_least32_t total_weight;  /* sum of entry weights */
+    atomic_uint_least32_t untracked;     /* attaches refused, table full */
+    uint8_t _pad[USRL_ALIGNMENT - 2 * sizeof(atomic_uint_least32_t)];
+    UsrlWriterEntry entries[USRL_MAX_WRITERS];
+} UsrlWriterTable;
+
+/* Snapshot of one writer entry (usrl_writer_stats) */
+typedef struct {
+    uint16_t pub_id;
+    uint32_t pid;
+    uint32_t weight;
+    uint64_t published;
+    uint64_t dropped;
+    uint64_t claimed;
+    uint64_t timeouts;
+    uint64_t throttled;
+} UsrlWriterStats;
+
+/* Owner-only counter bump: a relaxed load/store pair, no locked RMW */
+static inline void usrl_writer_count(atomic_uint_fast64_t *c)
+{
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+/* --------------------------------------------------------------------------
+ * Reader Table
+ *
+ * One per topic. Subscribers that register (usrl_sub_register) publish
+ * their cursor here so publishers can see the slowest reader; the header
+ * holds the topic's backpressure policy (see usrl_backpressure.h). Entries
+ * of processes that died are reclaimed by the publisher side when it finds
+ * them lagging.
+ *
+ * The cursor is stored on every read. The statistics are flushed by the
+ * owning subscriber every USRL_SUB_STATS_EVERY reads, or after as many
+ * empty polls, so they trail the live values by at most that much. Rates
+ * are measured by the reader over windows of at least USRL_SUB_RATE_NS.
+ *
+ * A reader that turns on latency tracking (usrl_sub_latency_enable) gets a
+ * UsrlLatencyHist carved from the region; it stays with the entry and is
+ * reused (zeroed) by later owners.
+ * -------------------------------------------------------------------------- */
+typedef struct
+{
+    atomic_uint_least32_t owner;         /* 1 = in use, 0 = free */
+    uint32_t pid;                        /* registering process */
+    atomic_uint_fast64_t cursor;         /* subscriber last_seq */
+    atomic_uint_fast64_t reads;          /* messages delivered */
+    atomic_uint_fast64_t skips;          /* messages lost to overrun */
+    atomic_uint_fast64_t max_lag;        /* largest head - cursor seen */
+    atomic_uint_fast64_t last_read_ns;   /* CLOCK_MONOTONIC of last flush with reads */
+    atomic_uint_fast64_t read_rate_hz;   /* reads/s over the last window */
+    atomic_uint_fast64_t head_rate_hz;   /* publishes/s seen by this reader */
+    atomic_uint_fast64_t lat_offset;     /* UsrlLatencyHist in the region, 0 = none */
+    UsrlHeartbeat hb;
+} __attribute__((aligned(USRL_ALIGNMENT))) UsrlReaderEntry;
+
+/* Snapshot of one registered reader (usrl_reader_stats) */
+typedef struct {
+    uint32_t pid;
+    uint32_t slot;           /* entry index, for usrl_reader_latency */
+    uint64_t cursor;
+    uint64_t lag;            /* head - cursor, live */
+    uint64_t reads;
+    uint64_t skips;
+    uint64_t max_lag;
+    uint64_t last_read_ns;
+    uint64_t read_rate_hz;
+    uint64_t head_rate_hz;
+} UsrlReaderStats;
+
+#define USRL_SUB_STATS_EVERY 64                 /* reads (or empty polls) per flush */
+#define USRL_SUB_RATE_NS     (100ULL * 1000000ULL) /* shortest rate window */
+#define USRL_FAIR_IDLE_NS    (1000000ULL)          /* no claim for this long: out of the fair share */
+
+typedef struct
+{
+    atomic_uint_least32_t bp_mode;         /* UsrlBackpressureMode */
+    atomic_uint_least32_t lag_threshold;   /* slots; 0 = slot_count / 2 */
+    atomic_uint_least32_t throttle_max_ns; /* THROTTLE: delay at full lag */
+    atomic_uint_least32_t block_max_us;    /* BLOCK: longest single wait */
+    uint8_t _pad[USRL_ALIGNMENT - 4 * sizeof(atomic_uint_least32_t)];
+    UsrlReaderEntry entries[USRL_MAX_READERS];
+} UsrlReaderTable;
+
+/* Published message count (w_head without the resize flag) */
+static inline uint64_t usrl_ring_head(RingDesc *r)
+{
+    return atomic_load_explicit(&r->w_head, memory_order_acquire) & ~USRL_HEAD_RESIZING;
+}
+
 /* --------------------------------------------------------------------------
  * Public API (core)
  *
@@ -148,16 +360,74 @@ typedef struct __attribute__((aligned(USRL_ALIGNMENT)))
  * usrl_core_map   : open and mmap() an existing region for use by a process.
  *
  * usrl_get_topic  : look up a topic by name in a mapped region.
+ *
+ * usrl_core_alloc : carve `bytes` (cache-line aligned) out of the unused tail
+ *                   of a mapped region. Returns the offset, or 0 when full.
+ *
+ * usrl_core_init_ex : as usrl_core_init, with a topic table of `capacity`
+ *                   entries (>= count) so topics can be added later. count
+ *                   may be 0 to create an empty registry region.
+ *
+ * usrl_core_pub_id : hand out a publisher id (1..65535) unique within the
+ *                   region, so SlotHeader.pub_id identifies the writer
+ *                   across processes.
+ *
+ * usrl_writer_attach : find or claim `pub_id`'s entry in a topic's writer
+ *                   table (NULL if full, counted in the table's untracked:
+ *                   such a writer has no counters and no fair share).
+ *
+ * usrl_writer_stats : copy up to `max` active writer entries of a topic.
+ *                   Returns the count, or -1 if the topic is unknown.
+ *
+ * usrl_reader_stats : same for registered readers, with live lag.
+ *
+ * usrl_reader_latency : latency histogram of reader entry `slot`, or NULL
+ *                   if that reader never enabled tracking.
+ *
+ * usrl_core_add_topic : add a topic to a mapped region, sizing its ring to
+ *                   exactly slot_count * slot_size. Safe across processes.
+ *                   Returns 0 added, 1 already present, -1 invalid params,
+ *                   -4 region or topic table full.
  * -------------------------------------------------------------------------- */
 int usrl_core_init(const char *path,
                    uint64_t size,
                    const UsrlTopicConfig *topics,
                    uint32_t count);
 
+int usrl_core_init_ex(const char *path,
+                      uint64_t size,
+                      const UsrlTopicConfig *topics,
+                      uint32_t count,
+                      uint32_t capacity);
+
+int usrl_core_add_topic(void *base, const UsrlTopicConfig *cfg);
+
+uint16_t usrl_core_pub_id(void *base);
+
+UsrlWriterEntry *usrl_writer_attach(void *base, const TopicEntry *t, uint16_t pub_id);
+
+void usrl_writer_detach(void *base, const TopicEntry *t, UsrlWriterEntry *w);
+
+/*
+ * Owner-only: record a beat and promise the next within period_ms (0 drops
+ * the promise). The watchdog reports an entry stalled after two missed
+ * periods; entries without a promise are never stalled, only dead.
+ */
+void usrl_heartbeat(UsrlHeartbeat *hb, uint32_t period_ms);
+
+int usrl_writer_stats(void *base, const char *topic, UsrlWriterStats *out, int max);
+
+int usrl_reader_stats(void *base, const char *topic, UsrlReaderStats *out, int max);
+
+struct UsrlLatencyHist;
+const struct UsrlLatencyHist *usrl_reader_latency(void *base, const char *topic, uint32_t slot);
+
 void *usrl_core_map(const char *path, uint64_t size);
 
 TopicEntry *usrl_get_topic(void *base, const char *name);
 
 void usrl_core_unmap(void *base, size_t size);
 
+uint64_t usrl_core_alloc(void *base, uint64_t bytes);
+
 #endif /* USRL_CORE_H */
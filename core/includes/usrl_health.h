@@ -36,9 +36,67 @@ typedef struct {
 } RingHealth;
 
 RingHealth *usrl_health_get(void *base, const char *topic);
+
+/* As usrl_health_get, into caller storage (no allocation). 0, or -1 if unknown. */
+int usrl_health_fill(void *base, const char *topic, RingHealth *out);
+
+/*
+ * Snapshot every topic of a region in table order, in one pass and without
+ * allocating: out[i] for i < min(cap, topics). Returns the number of topics
+ * in the region (more than cap means the array was too small), -1 on error.
+ */
+int usrl_health_snapshot_all(void *base, RingHealth *out, uint32_t cap);
+
 int usrl_health_check_lag(void *base, const char *topic, uint64_t lag_threshold_slots);
+
+/*
+ * 1 if a writer of the topic has held an MWMR claim for more than
+ * timeout_ms, or died holding one: the slot blocks every writer a lap later.
+ * An idle topic is not a deadlock. 0 otherwise, -1 if the topic is unknown.
+ */
 int usrl_health_detect_deadlock(void *base, const char *topic, uint64_t timeout_ms);
 int usrl_health_export_json(void *base, const char *topic, char *buf, uint32_t max_len);
+
+/* JSON array with one object per topic. Returns length, -1 if buf is too small. */
+int usrl_health_export_json_all(void *base, char *buf, uint32_t max_len);
 void usrl_health_free(RingHealth *health);
 
+/* -----------------------------------------------------------------------------
+ * Liveness: heartbeats, pids and open claims of every writer and reader entry
+ * --------------------------------------------------------------------------- */
+#define USRL_LIVE_DEAD        1 /* process exited without detaching */
+#define USRL_LIVE_STALLED     2 /* promised heartbeat two periods overdue */
+#define USRL_LIVE_CLAIM_STALL 3 /* MWMR claim open longer than the bound */
+
+#define USRL_ROLE_WRITER 0
+#define USRL_ROLE_READER 1
+
+typedef struct {
+    char topic[USRL_MAX_TOPIC_NAME];
+    uint32_t state;  /* USRL_LIVE_* */
+    uint32_t role;   /* USRL_ROLE_* */
+    uint32_t slot;   /* index in the writer / reader table */
+    uint32_t pid;
+    uint16_t pub_id; /* writers only */
+    uint64_t seq;    /* open claim (writers, 0 = none) or cursor (readers) */
+    uint64_t age_ns; /* since the claim, or since the last beat */
+} UsrlLiveness;
+
+/*
+ * List every participant of the region that is dead, stalled, or has held a
+ * claim longer than claim_ms: out[i] for i < min(cap, found). Returns the
+ * number found, -1 on error. Healthy and idle participants are not listed.
+ */
+int usrl_health_liveness(void *base, uint64_t claim_ms, UsrlLiveness *out, uint32_t cap);
+
+/* MWMR control topic usrl-watchdog publishes UsrlWatchdogEvent records to */
+#define USRL_WATCHDOG_TOPIC "usrl.watchdog"
+
+typedef struct {
+    uint64_t time_ns;  /* CLOCK_MONOTONIC when the watchdog saw the change */
+    uint32_t cleared;  /* 0 = raised, 1 = condition went away */
+    uint32_t _pad;
+    UsrlLiveness what;
+} UsrlWatchdogEvent;
+
 #endif /* USRL_HEALTH_H */
@@ -0,0 +1,80 @@
+/**
+ * @file usrl_latency.h
+ * @brief Log-bucketed publish-to-consume latency histogram.
+ *
+ * HDR-style layout: values below 2^USRL_LAT_SUB_BITS ns get a bucket each;
+ * above that every power of two is split into 2^USRL_LAT_SUB_BITS linear
+ * sub-buckets, so any recorded value is known to within 12.5%. Values past
+ * 2^USRL_LAT_MAX_EXP ns (~18 minutes) land in the last bucket.
+ *
+ * A histogram has one writer (the subscriber that owns it), which bumps
+ * counters with relaxed load/store pairs; readers in other processes may
+ * see a histogram that is a few increments behind but never torn counters.
+ */
+
+#ifndef USRL_LATENCY_H
+#define USRL_LATENCY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define USRL_LAT_SUB_BITS 3
+#define USRL_LAT_SUB      (1u << USRL_LAT_SUB_BITS)
+#define USRL_LAT_MAX_EXP  40
+#define USRL_LAT_BUCKETS  ((USRL_LAT_MAX_EXP - USRL_LAT_SUB_BITS + 2) * USRL_LAT_SUB)
+
+typedef struct UsrlLatencyHist
+{
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t sum_ns;
+    atomic_uint_fast64_t max_ns;
+    atomic_uint_fast64_t buckets[USRL_LAT_BUCKETS];
+} UsrlLatencyHist;
+
+/* Percentile summary (usrl_latency_summary) */
+typedef struct
+{
+    uint64_t count;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} UsrlLatencySummary;
+
+static inline uint32_t usrl_latency_bucket(uint64_t ns)
+{
+    if (ns < USRL_LAT_SUB) return (uint32_t)ns;
+    uint32_t e = 63u - (uint32_t)__builtin_clzll(ns);
+    if (e > USRL_LAT_MAX_EXP) return USRL_LAT_BUCKETS - 1;
+    uint32_t sub = (uint32_t)(ns >> (e - USRL_LAT_SUB_BITS)) & (USRL_LAT_SUB - 1);
+    return (e - USRL_LAT_SUB_BITS + 1) * USRL_LAT_SUB + sub;
+}
+
+/* Owner-only: O(1), no locked instructions */
+static inline void usrl_latency_record(UsrlLatencyHist *h, uint64_t ns)
+{
+    atomic_uint_fast64_t *b = &h->buckets[usrl_latency_bucket(ns)];
+    atomic_store_explicit(b, atomic_load_explicit(b, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&h->count, atomic_load_explicit(&h->count, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&h->sum_ns, atomic_load_explicit(&h->sum_ns, memory_order_relaxed) + ns,
+                          memory_order_relaxed);
+    if (ns > atomic_load_explicit(&h->max_ns, memory_order_relaxed))
+        atomic_store_explicit(&h->max_ns, ns, memory_order_relaxed);
+}
+
+/* Highest value that falls in bucket `idx` */
+uint64_t usrl_latency_bucket_max(uint32_t idx);
+
+/* Value at quantile q (0..1), as the upper edge of its bucket, capped at max */
+uint64_t usrl_latency_percentile(const UsrlLatencyHist *h, double q);
+
+void usrl_latency_summary(const UsrlLatencyHist *h, UsrlLatencySummary *out);
+
+/* Owner-only: zero all counters */
+void usrl_latency_reset(UsrlLatencyHist *h);
+
+#endif /* USRL_LATENCY_H */
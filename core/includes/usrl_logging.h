@@ -34,14 +34,32 @@ typedef struct {
 } UsrlTraceEvent;
 
 int usrl_logging_init(const char *log_file, UsrlLogLevel min_level);
+
+/*
+ * Asynchronous backend. Each logging thread formats into its own SPSC ring
+ * of thread_buf_bytes (0 = 256 KB, rounded up to a power of two) and a
+ * background thread writes them out, merged by timestamp, every 2 ms. The
+ * caller never locks or waits on I/O; a full ring drops the record and the
+ * flusher reports how many. Memory is one ring per concurrently logging
+ * thread; rings of exited threads are reused once the flusher has drained
+ * them.
+ */
+int usrl_logging_init_async(const char *log_file, UsrlLogLevel min_level,
+                            uint32_t thread_buf_bytes);
 void usrl_log(UsrlLogLevel level, const char *module, uint32_t line,
              const char *fmt, ...);
 void usrl_log_metric(const char *module, const char *metric_name, int64_t value);
 void usrl_log_lag(const char *topic, uint64_t lag_slots, uint64_t threshold);
 void usrl_log_drop(const char *topic, uint32_t drop_count);
+/* Returns once everything logged before the call is written and flushed */
 void usrl_log_flush(void);
 void usrl_logging_shutdown(void);
 
+/*
+ * Event tracing, recorded in the shared trace rings (usrl_trace.h) together
+ * with every publish and consume. usrl_tracing_shutdown() writes the whole
+ * region to trace_file as Chrome trace JSON.
+ */
 int usrl_tracing_init(const char *trace_file);
 void usrl_trace_event(const char *event_name, const char *publisher,
                      uint64_t sequence, uint32_t payload_size,
@@ -49,6 +67,153 @@ void usrl_trace_event(const char *event_name, const char *publisher,
 void usrl_trace_summary(void);
 void usrl_tracing_shutdown(void);
 
+/* -----------------------------------------------------------------------------
+ * Binary (deferred-format) logging
+ *
+ * USRL_BLOG records a call-site id and the raw argument values; formatting
+ * happens later on the flusher thread (text sinks) or offline in
+ * usrl-logdecode (binary sinks). Up to USRL_BLOG_MAX_ARGS arguments of
+ * integer, floating, pointer or string type; strings are copied, up to
+ * USRL_BLOG_STR_MAX bytes each. Without the async backend the record is
+ * formatted on the spot, like USRL_INFO.
+ * --------------------------------------------------------------------------- */
+#define USRL_BLOG_MAX_ARGS 8
+#define USRL_BLOG_STR_MAX  255
+
+typedef union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void *p;
+    const char *s;
+} UsrlLogArg;
+
+/* One static instance per USRL_BLOG call site */
+typedef struct {
+    const char *fmt;
+    const char *module;
+    const char *file;
+    uint32_t line;
+    uint8_t level;
+    uint8_t nargs;
+    char types[USRL_BLOG_MAX_ARGS + 1]; /* per argument: i u d p s */
+    uint32_t id;                        /* assigned on first use (atomic), 0 = not yet */
+} UsrlLogSite;
+
+extern UsrlLogLevel usrl_log_min_level;
+
+void usrl_blog(UsrlLogSite *site, const UsrlLogArg *args);
+
+/* Binary sink: async backend writing undecoded frames to bin_file (appended) */
+int usrl_logging_init_binary(const char *bin_file, UsrlLogLevel min_level,
+                             uint32_t thread_buf_bytes);
+
+/*
+ * Also publish every frame to an existing MWMR topic, for a log daemon in
+ * another process (usrl-logdecode -t). Slots need USRL_BLOG_FRAME_MAX bytes
+ * of payload. Needs the async backend. Returns 0, -1 if the topic is unknown
+ * or too small.
+ */
+int usrl_logging_publish(void *core_base, const char *topic);
+
+/*
+ * Render fmt with encoded arguments (a USRL_BLOG_LOG frame body). printf
+ * conversions without '*'; length modifiers come from the argument types.
+ * Returns the length written to out (NUL-terminated).
+ */
+uint32_t usrl_log_render(const char *fmt, const char *types, uint32_t nargs,
+                         const void *args, uint32_t args_len, char *out, uint32_t cap);
+
+/* Stream format: a file header, then frames */
+#define USRL_BLOG_MAGIC   0x474F4C42u /* "BLOG" */
+#define USRL_BLOG_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+} UsrlBlogFileHeader;
+
+#define USRL_BLOG_DEF  1 /* u16 line, u8 nargs, u8 level, types[nargs], module\0 file\0 fmt\0 */
+#define USRL_BLOG_LOG  2 /* arguments: i/u/d/p 8 bytes, s = u16 length + bytes */
+#define USRL_BLOG_TEXT 3 /* preformatted text (USRL_INFO and friends) */
+#define USRL_BLOG_DROP 4 /* u64 records lost to full thread buffers */
+
+typedef struct {
+    uint32_t len;  /* whole frame, header included */
+    uint16_t type; /* USRL_BLOG_* */
+    uint16_t level;
+    uint32_t pid;  /* site ids are per process */
+    uint32_t site;
+    uint64_t ts;   /* CLOCK_MONOTONIC ns */
+} UsrlBlogFrame;
+
+#define USRL_BLOG_FRAME_MAX (sizeof(UsrlBlogFrame) + 1024u)
+
+static inline UsrlLogArg usrl_blog_i(int64_t v) { UsrlLogArg a; a.i = v; return a; }
+static inline UsrlLogArg usrl_blog_u(uint64_t v) { UsrlLogArg a; a.u = v; return a; }
+static inline UsrlLogArg usrl_blog_d(double v) { UsrlLogArg a; a.d = v; return a; }
+static inline UsrlLogArg usrl_blog_p(const void *v) { UsrlLogArg a; a.p = v; return a; }
+static inline UsrlLogArg usrl_blog_s(const char *v) { UsrlLogArg a; a.s = v; return a; }
+
+#define USRL_BLOG_TYPE(x) _Generic((x),                                          \
+    char *: 's', const char *: 's',                                              \
+    float: 'd', double: 'd',                                                     \
+    _Bool: 'u', unsigned char: 'u', unsigned short: 'u', unsigned int: 'u',      \
+    unsigned long: 'u', unsigned long long: 'u',                                 \
+    char: 'i', signed char: 'i', short: 'i', int: 'i', long: 'i', long long: 'i', \
+    default: 'p')
+
+#define USRL_BLOG_ARG(x) _Generic((x),                                           \
+    char *: usrl_blog_s, const char *: usrl_blog_s,                              \
+    float: usrl_blog_d, double: usrl_blog_d,                                     \
+    _Bool: usrl_blog_u, unsigned char: usrl_blog_u, unsigned short: usrl_blog_u, \
+    unsigned int: usrl_blog_u, unsigned long: usrl_blog_u,                       \
+    unsigned long long: usrl_blog_u,                                             \
+    char: usrl_blog_i, signed char: usrl_blog_i, short: usrl_blog_i,             \
+    int: usrl_blog_i, long: usrl_blog_i, long long: usrl_blog_i,                 \
+    default: usrl_blog_p)(x)
+
+#define USRL__CAT_(a, b) a##b
+#define USRL__CAT(a, b) USRL__CAT_(a, b)
+#define USRL__NARG(...) USRL__NARG_(_0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define USRL__NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+#define USRL__T0()
+#define USRL__T1(a) USRL_BLOG_TYPE(a),
+#define USRL__T2(a, ...) USRL_BLOG_TYPE(a), USRL__T1(__VA_ARGS__)
+#define USRL__T3(a, ...) USRL_BLOG_TYPE(a), USRL__T2(__VA_ARGS__)
+#define USRL__T4(a, ...) USRL_BLOG_TYPE(a), USRL__T3(__VA_ARGS__)
+#define USRL__T5(a, ...) USRL_BLOG_TYPE(a), USRL__T4(__VA_ARGS__)
+#define USRL__T6(a, ...) USRL_BLOG_TYPE(a), USRL__T5(__VA_ARGS__)
+#define USRL__T7(a, ...) USRL_BLOG_TYPE(a), USRL__T6(__VA_ARGS__)
+#define USRL__T8(a, ...) USRL_BLOG_TYPE(a), USRL__T7(__VA_ARGS__)
+
+#define USRL__A0()
+#define USRL__A1(a) USRL_BLOG_ARG(a),
+#define USRL__A2(a, ...) USRL_BLOG_ARG(a), USRL__A1(__VA_ARGS__)
+#define USRL__A3(a, ...) USRL_BLOG_ARG(a), USRL__A2(__VA_ARGS__)
+#define USRL__A4(a, ...) USRL_BLOG_ARG(a), USRL__A3(__VA_ARGS__)
+#define USRL__A5(a, ...) USRL_BLOG_ARG(a), USRL__A4(__VA_ARGS__)
+#define USRL__A6(a, ...) USRL_BLOG_ARG(a), USRL__A5(__VA_ARGS__)
+#define USRL__A7(a, ...) USRL_BLOG_ARG(a), USRL__A6(__VA_ARGS__)
+#define USRL__A8(a, ...) USRL_BLOG_ARG(a), USRL__A7(__VA_ARGS__)
+
+#define USRL_BLOG(lvl, mod, fmt, ...) do {                                            \
+    if ((lvl) <= usrl_log_min_level) {                                               \
+        static UsrlLogSite usrl__site = {                                            \
+            fmt, mod, __FILE__, __LINE__, (lvl), USRL__NARG(__VA_ARGS__),            \
+            { USRL__CAT(USRL__T, USRL__NARG(__VA_ARGS__))(__VA_ARGS__) 0 }, 0 };      \
+        const UsrlLogArg usrl__args[] = {                                            \
+            USRL__CAT(USRL__A, USRL__NARG(__VA_ARGS__))(__VA_ARGS__) { 0 } };         \
+        usrl_blog(&usrl__site, usrl__args);                                          \
+    }                                                                                \
+} while (0)
+
+#define USRL_BERROR(mod, fmt, ...) USRL_BLOG(USRL_LOG_ERROR, mod, fmt, ##__VA_ARGS__)
+#define USRL_BWARN(mod, fmt, ...) USRL_BLOG(USRL_LOG_WARN, mod, fmt, ##__VA_ARGS__)
+#define USRL_BINFO(mod, fmt, ...) USRL_BLOG(USRL_LOG_INFO, mod, fmt, ##__VA_ARGS__)
+#define USRL_BDEBUG(mod, fmt, ...) USRL_BLOG(USRL_LOG_DEBUG, mod, fmt, ##__VA_ARGS__)
+
 #define USRL_ERROR(mod, fmt, ...) usrl_log(USRL_LOG_ERROR, mod, __LINE__, fmt, ##__VA_ARGS__)
 #define USRL_WARN(mod, fmt, ...) usrl_log(USRL_LOG_WARN, mod, __LINE__, fmt, ##__VA_ARGS__)
 #define USRL_INFO(mod, fmt, ...) usrl_log(USRL_LOG_INFO, mod, __LINE__, fmt, ##__VA_ARGS__)
@@ -12,6 +12,9 @@
 #include <stdbool.h>
 #include <stdatomic.h>
 #include "usrl_core.h"
+#include "usrl_latency.h"
+#include "usrl_trace.h"
+#include "usrl_schema.h"
 
 /* 
  * RING RETURN CODES 
@@ -22,6 +25,8 @@
 #define USRL_RING_FULL       -2   /* Payload too large for slot */
 #define USRL_RING_TRUNC      -3   /* Buffer too small (Reader) */
 #define USRL_RING_TIMEOUT    -4   /* Spinlock timeout (MWMR Writer) */
+#define USRL_RING_QUOTA      -5   /* Over fair share, other writers waiting (MWMR) */
+#define USRL_RING_TORN       -6   /* Peeked slot was overwritten: discard what was read */
 #define USRL_RING_NO_DATA    -11  /* EAGAIN style - Nothing to read */
 
 /* Publisher Handle (SWMR) */
@@ -30,6 +35,16 @@ typedef struct {
     uint8_t *base_ptr;
     uint32_t mask;
     uint16_t pub_id;
+    uint32_t gen;
+    uint32_t epoch;         /* RingDesc.epoch the cached geometry belongs to */
+    uint8_t *core_base;
+    UsrlWriterEntry *writer; /* NULL if the writer table is full */
+    uint32_t trace_topic;    /* usrl_trace_topic() of the topic name */
+    uint32_t schema_id;      /* stamped into every slot (usrl_pub_set_schema) */
+    uint16_t schema_ver;
+    SlotHeader *pending;     /* slot between usrl_pub_reserve and usrl_pub_commit */
+    uint64_t pending_seq;
+    uint64_t pending_ns;
 } UsrlPublisher;
 
 /* Subscriber Handle (Shared SWMR/MWMR) */
@@ -39,6 +54,26 @@ typedef struct {
     uint32_t mask;
     uint64_t last_seq;
     uint64_t skipped_count; /* Internal skip tracker */
+    uint32_t gen;
+    uint32_t epoch;
+    uint8_t *core_base;
+    UsrlReaderTable *readers;
+    UsrlReaderEntry *reader; /* set by usrl_sub_register */
+    uint64_t read_count;     /* messages delivered */
+    uint64_t max_lag;
+    uint32_t stats_pending;  /* reads since the last stats flush */
+    uint32_t idle_polls;     /* empty polls since the last stats flush */
+    uint64_t rate_ns;        /* start of the current rate window */
+    uint64_t rate_reads;
+    uint64_t rate_head;
+    UsrlLatencyHist *lat;    /* set by usrl_sub_latency_enable */
+    uint32_t trace_topic;
+    uint32_t schema_id;      /* schema stamp of the last message delivered */
+    uint16_t schema_ver;
+    SlotHeader *peek;        /* slot between usrl_sub_peek and usrl_sub_peek_done */
+    uint64_t peek_seq;
+    uint64_t peek_head;
+    uint64_t peek_trace_ns;
 } UsrlSubscriber;
 
 /* Publisher Handle (MWMR) */
@@ -47,6 +82,18 @@ typedef struct {
     uint8_t *base_ptr;
     uint32_t mask;
     uint16_t pub_id;
+    uint32_t gen;
+    uint32_t epoch;
+    uint8_t *core_base;
+    UsrlWriterTable *writers; /* NULL if the table is full */
+    UsrlWriterEntry *writer;
+    bool fair;                /* topic has USRL_TOPIC_FAIR */
+    uint32_t trace_topic;
+    uint32_t schema_id;
+    uint16_t schema_ver;
+    SlotHeader *pending;      /* slot between usrl_mwmr_pub_reserve and _commit */
+    uint64_t pending_seq;
+    uint64_t pending_ns;      /* claim time, the slot timestamp */
 } UsrlMwmrPublisher;
 
 /* --------------------------------------------------------------------------
@@ -61,10 +108,103 @@ int usrl_pub_publish(UsrlPublisher *p, const void *data, uint32_t len);
 void usrl_mwmr_pub_init(UsrlMwmrPublisher *p, void *core_base, const char *topic, uint16_t pub_id);
 int usrl_mwmr_pub_publish(UsrlMwmrPublisher *p, const void *data, uint32_t len);
 
+/* Fair share weight for this writer (default 1). Returns 0, or -1 if invalid. */
+int usrl_mwmr_pub_set_weight(UsrlMwmrPublisher *p, uint32_t weight);
+
+/*
+ * Stamp every message this publisher writes with the schema's id and version
+ * (NULL clears the stamp), so readers can tell which layout it is in and
+ * read older or newer versions through a UsrlSchemaReader.
+ */
+void usrl_pub_set_schema(UsrlPublisher *p, const UsrlSchema *schema);
+void usrl_mwmr_pub_set_schema(UsrlMwmrPublisher *p, const UsrlSchema *schema);
+
+/*
+ * Write a message in place: reserve claims the next slot and returns its
+ * payload area (at least len bytes, up to the slot's payload size); fill it,
+ * then commit the bytes written. Readers wait on the slot until the commit,
+ * so keep the two close together. A message that should not go out is
+ * aborted instead: the slot is released as a marker readers step over.
+ * Every reservation must end in one or the other, or readers of the topic
+ * stall on it. One reservation per publisher at a time.
+ * reserve returns NULL if len exceeds the slot, a reservation is open, or
+ * (MWMR, with *rc set) the claim was refused as in usrl_mwmr_pub_publish.
+ * commit returns USRL_RING_OK, USRL_RING_FULL if len exceeds the slot (the
+ * reservation stays open), USRL_RING_ERROR if none is open.
+ * abort returns USRL_RING_OK, or USRL_RING_ERROR if none is open.
+ */
+uint8_t *usrl_pub_reserve(UsrlPublisher *p, uint32_t len);
+int usrl_pub_commit(UsrlPublisher *p, uint32_t len);
+int usrl_pub_abort(UsrlPublisher *p);
+uint8_t *usrl_mwmr_pub_reserve(UsrlMwmrPublisher *p, uint32_t len, int *rc);
+int usrl_mwmr_pub_commit(UsrlMwmrPublisher *p, uint32_t len);
+int usrl_mwmr_pub_abort(UsrlMwmrPublisher *p);
+
+
 /* Subscriber (Common) */
 void usrl_sub_init(UsrlSubscriber *s, void *core_base, const char *topic);
 int usrl_sub_next(UsrlSubscriber *s, uint8_t *out_buf, uint32_t buf_len, uint16_t *out_pub_id);
 
+/*
+ * Read the next message in place. peek points *payload into the slot and
+ * returns its length (or USRL_RING_NO_DATA) without copying; the cursor does
+ * not move. A writer a lap ahead can overwrite the slot meanwhile, so use
+ * what was read only once usrl_sub_peek_done() returns USRL_RING_OK; it
+ * returns USRL_RING_TORN if the message changed underneath (it is then
+ * counted as skipped). Either way the cursor moves past it.
+ */
+int usrl_sub_peek(UsrlSubscriber *s, const uint8_t **payload, uint16_t *out_pub_id);
+int usrl_sub_peek_done(UsrlSubscriber *s);
+
+/*
+ * Read up to max messages laid out by `schema` and store them transposed:
+ * cols[i] is an array of field i's type (field width bytes per row), and
+ * row r of the batch lands at cols[i][r]. NULL columns are skipped; columns
+ * of variable-length fields must be NULL.
+ * A message shorter than the schema, or stamped with another version of it,
+ * ends the batch and is left unread: the next read returns it (read it
+ * through a UsrlSchemaReader). Returns the rows stored (0 when nothing is
+ * new or the next message does not match), USRL_RING_ERROR on invalid
+ * arguments.
+ */
+int usrl_sub_drain_columnar(UsrlSubscriber *s, const UsrlSchema *schema, void *const cols[],
+                            uint32_t max);
+
+/*
+ * Publish this subscriber's cursor in the topic's reader table so lag-aware
+ * publishers account for it. Returns 0, or -1 if the table is full.
+ */
+int usrl_sub_register(UsrlSubscriber *s);
+void usrl_sub_unregister(UsrlSubscriber *s);
+
+/*
+ * Record publish-to-consume latency (now - SlotHeader.timestamp_ns) of every
+ * message this subscriber reads, into a histogram in its reader entry. Needs
+ * a registered subscriber. Returns 0, -1 if not registered, -4 if the region
+ * has no room for the histogram.
+ */
+int usrl_sub_latency_enable(UsrlSubscriber *s);
+
+/*
+ * Online resize (grow only). new_slot_count is rounded up to a power of two.
+ * The new ring is carved from the region tail; the old ring's space is not
+ * reclaimed. Publishers and subscribers pick up the new geometry on their
+ * next call, and subscribers keep their cursor. A claim made before the
+ * resize is waited for while its writer lives, so an open reservation holds
+ * the resize (and every publisher of the topic) until it is committed or
+ * aborted: never resize from a thread that holds one.
+ *
+ * Returns:
+ *  0 : resized
+ * -1 : invalid params / unknown topic / not larger than current ring
+ * -2 : another resize of this ring is in progress
+ * -4 : insufficient SHM space for the new ring
+ */
+int usrl_ring_resize(void *core_base, const char *topic, uint32_t new_slot_count);
+
+/* Internal: block until a running resize of `d` has switched geometry */
+void usrl_ring_wait_resize(RingDesc *d);
+
 /* Telemetry Helpers */
 uint64_t usrl_swmr_total_published(void *ring_desc);
 uint64_t usrl_mwmr_total_published(void *ring_desc);
@@ -3,8 +3,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define USRL_MAX_FIELDS 32
 
 typedef enum {
@@ -16,8 +21,12 @@ typedef enum {
     USRL_FIELD_F32,
     USRL_FIELD_BYTES,
     USRL_FIELD_STRING,
+    USRL_FIELD_VBYTES,  /* variable length, up to size bytes (0 = no limit) */
+    USRL_FIELD_VSTRING,
 } UsrlFieldType;
 
+#define USRL_FIELD_IS_VAR(type) ((type) >= USRL_FIELD_VBYTES)
+
 typedef struct {
     const char *name;
     UsrlFieldType type;
@@ -33,7 +42,9 @@ typedef struct {
     const char *name;
     uint32_t field_count;
     UsrlField fields[USRL_MAX_FIELDS];
-    uint32_t total_size;
+    uint32_t total_size;      /* fixed part; variable fields add their bytes after it */
+    uint32_t var_count;       /* VBYTES / VSTRING fields */
+    uint8_t *defaults; /* total_size bytes, zeroed by finalize (usrl_schema_set_default) */
 } UsrlSchema;
 
 typedef struct {
@@ -43,10 +54,75 @@ typedef struct {
     uint32_t capacity;
 } UsrlMessage;
 
+/*
+ * Field handle: the field's byte offset and its index, resolved once with
+ * usrl_schema_field_id(). The typed accessors below are a single load or
+ * store at msg->data + offset, like a member of a packed struct; they do not
+ * check the field's type.
+ */
+typedef uint32_t UsrlFieldId;
+
+#define USRL_FIELD_INVALID ((UsrlFieldId)0xFFFFFFFFu)
+#define USRL_FIELD_ID(offset, index) (((UsrlFieldId)(offset) << 8) | (UsrlFieldId)(index))
+#define USRL_FIELD_OFFSET(fid) ((fid) >> 8)
+#define USRL_FIELD_INDEX(fid) ((fid) & 0xFFu)
+
+/* Bytes a field occupies in the fixed part (and per row in a column) */
+static inline uint32_t usrl_field_width(const UsrlField *f)
+{
+    return f->type <= USRL_FIELD_F64 ? 8
+         : f->type <= USRL_FIELD_F32 ? 4
+         : USRL_FIELD_IS_VAR(f->type) ? 4
+         : f->size;
+}
+
+/*
+ * Variable-length fields. The fixed part holds one 4-byte entry per field,
+ * {offset, length} of its bytes, which follow the fixed part in the order
+ * they were set. A message is total_size bytes plus its variable data, so
+ * short values no longer pay for the longest one, and offsets are limited to
+ * 64 KB. A view points into the payload, wherever it is (slot, receive
+ * buffer, message), and is only valid while that payload is.
+ */
+typedef struct {
+    uint16_t offset; /* from the start of the payload; 0 = empty */
+    uint16_t len;
+} UsrlVarRef;
+
+typedef struct {
+    const uint8_t *ptr; /* NULL if empty or out of bounds */
+    uint32_t len;
+} UsrlVarView;
+
+/* View of the variable field whose entry is at `entry` in a payload of len bytes */
+static inline UsrlVarView usrl_var_ref_view(const uint8_t *payload, uint32_t len,
+                                            const uint8_t *entry)
+{
+    UsrlVarRef ref;
+    UsrlVarView v = {NULL, 0};
+    memcpy(&ref, entry, sizeof(ref));
+    if (ref.len && (uint32_t)ref.offset + ref.len <= len) {
+        v.ptr = payload + ref.offset;
+        v.len = ref.len;
+    }
+    return v;
+}
+
+/* View of variable field fid of a received payload, no copy */
+static inline UsrlVarView usrl_var_view(const uint8_t *payload, uint32_t len, UsrlFieldId fid)
+{
+    if (USRL_FIELD_OFFSET(fid) + sizeof(UsrlVarRef) > len) {
+        UsrlVarView none = {NULL, 0};
+        return none;
+    }
+    return usrl_var_ref_view(payload, len, payload + USRL_FIELD_OFFSET(fid));
+}
+
 UsrlSchema *usrl_schema_create(uint32_t schema_id, const char *name);
 int usrl_schema_add_field(UsrlSchema *schema, const char *field_name,
                          UsrlFieldType type, uint32_t size);
 int usrl_schema_finalize(UsrlSchema *schema);
+/* capacity covers the fixed part and any variable data (at least total_size) */
 UsrlMessage *usrl_message_create(UsrlSchema *schema, uint32_t capacity);
 int usrl_message_set(UsrlMessage *msg, const char *field_name,
                     const void *value, uint32_t len);
@@ -55,6 +131,250 @@ int usrl_message_get(UsrlMessage *msg, const char *field_name,
 int usrl_message_encode(UsrlMessage *msg, uint8_t *out_buf, uint32_t max_len);
 int usrl_message_decode(UsrlMessage *msg, const uint8_t *data, uint32_t len);
 void usrl_message_free(UsrlMessage *msg);
+
+/*
+ * Messages over memory they do not own, for the hot path: no allocation and
+ * no copy. A view wraps a received payload (a peeked slot, a receive buffer)
+ * for the typed getters; data is NULL if len is shorter than the schema.
+ * Views are read-only: capacity is 0, so usrl_message_set_var() refuses.
+ * build_in starts an empty message in dst (capacity bytes, e.g. from
+ * usrl_pub_reserve()): the fixed part is zeroed and len = total_size; send
+ * msg.len bytes. Neither is passed to usrl_message_free().
+ */
+UsrlMessage usrl_message_view(const UsrlSchema *schema, const uint8_t *payload, uint32_t len);
+UsrlMessage usrl_message_build_in(const UsrlSchema *schema, void *dst, uint32_t capacity);
+
+/*
+ * Bump allocator for messages that must own their data, e.g. kept past the
+ * next receive. Allocation is a pointer bump; everything is released at
+ * once by usrl_arena_reset(). init with buf = NULL allocates size bytes,
+ * otherwise the arena uses buf (stack, static, a huge page).
+ */
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    bool owned; /* base was allocated by usrl_arena_init */
+} UsrlArena;
+
+int usrl_arena_init(UsrlArena *arena, void *buf, size_t size);
+void *usrl_arena_alloc(UsrlArena *arena, size_t size);   /* 8-byte aligned, NULL when full */
+void usrl_arena_reset(UsrlArena *arena);
+void usrl_arena_destroy(UsrlArena *arena);
+
+/* usrl_message_create() from an arena: NULL when full, never freed on its own */
+UsrlMessage *usrl_arena_message(UsrlArena *arena, UsrlSchema *schema, uint32_t capacity);
+
+/* Handle of a field by name, or USRL_FIELD_INVALID */
+UsrlFieldId usrl_schema_field_id(const UsrlSchema *schema, const char *field_name);
+
+/*
+ * BYTES / STRING fields: copies up to the field size, returns bytes copied or
+ * -1. On VBYTES / VSTRING fields these call usrl_message_set_var() and copy
+ * the value out of usrl_message_get_var().
+ */
+int usrl_message_set_bytes(UsrlMessage *msg, UsrlFieldId fid, const void *value, uint32_t len);
+int usrl_message_get_bytes(const UsrlMessage *msg, UsrlFieldId fid, void *out_value,
+                           uint32_t max_len);
+
+/*
+ * Append the value of a variable field after the message's data and point
+ * the field at it; msg->len grows by len. Setting the field again reuses its
+ * bytes when the new value fits before the next variable value (the last one
+ * always fits, capacity allowing); otherwise the value is appended and the
+ * old bytes stay behind unused until usrl_message_reset().
+ * Returns len, or -1 if it exceeds the field's size, the message capacity or
+ * the 64 KB offset range.
+ */
+int usrl_message_set_var(UsrlMessage *msg, UsrlFieldId fid, const void *value, uint32_t len);
+
+/* Empty every variable field and drop their data (fixed fields are kept) */
+void usrl_message_reset(UsrlMessage *msg);
+
+static inline UsrlVarView usrl_message_get_var(const UsrlMessage *msg, UsrlFieldId fid)
+{
+    return usrl_var_view(msg->data, msg->len, fid);
+}
+
+#define USRL_SCHEMA_ACCESSORS(suffix, ctype)                                              \
+    static inline void usrl_message_set_##suffix(UsrlMessage *msg, UsrlFieldId fid,      \
+                                                 ctype v)                                 \
+    {                                                                                     \
+        memcpy(msg->data + USRL_FIELD_OFFSET(fid), &v, sizeof(v));                        \
+    }                                                                                     \
+    static inline ctype usrl_message_get_##suffix(const UsrlMessage *msg, UsrlFieldId fid) \
+    {                                                                                     \
+        ctype v;                                                                          \
+        memcpy(&v, msg->data + USRL_FIELD_OFFSET(fid), sizeof(v));                        \
+        return v;                                                                         \
+    }
+
+USRL_SCHEMA_ACCESSORS(u64, uint64_t)
+USRL_SCHEMA_ACCESSORS(i64, int64_t)
+USRL_SCHEMA_ACCESSORS(f64, double)
+USRL_SCHEMA_ACCESSORS(u32, uint32_t)
+USRL_SCHEMA_ACCESSORS(i32, int32_t)
+USRL_SCHEMA_ACCESSORS(f32, float)
 void usrl_schema_free(UsrlSchema *schema);
 
+/*
+ * Schemas in the region. A topic carries one schema, possibly in several
+ * versions: each is written once by usrl_schema_bind() into space from
+ * usrl_core_alloc() and linked from TopicEntry.schema_offset through
+ * next_offset, oldest first. Names are stored inline so any process (and the
+ * tools) can rebuild a layout with usrl_schema_attach().
+ */
+#define USRL_SCHEMA_NAME_MAX 32
+
+typedef struct {
+    char name[USRL_SCHEMA_NAME_MAX];
+    uint32_t type;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t fingerprint;
+} UsrlShmField;
+
+typedef struct {
+    uint32_t schema_id;
+    uint32_t version;
+    uint32_t fingerprint;
+    uint32_t field_count;
+    uint32_t total_size;
+    uint32_t _pad;
+    uint64_t next_offset; /* next bound version, 0 = none (atomic) */
+    char name[USRL_SCHEMA_NAME_MAX];
+    UsrlShmField fields[USRL_MAX_FIELDS];
+} UsrlShmSchema;
+
+/*
+ * Bind a finalized schema to a topic of a mapped region. Binding the same
+ * version again is a no-op. A new version of the bound schema (same id and
+ * name) is added if it is compatible with every bound version: fields may be
+ * added, removed or moved, but a field kept under the same name keeps its
+ * type and width. Versions run 1..65535.
+ * Returns 0, -1 invalid (unknown topic, names too long, messages larger than
+ * a slot), -2 another schema, a changed field, or a bound version with a
+ * different fingerprint or layout (field sizes, offsets), -4 region full.
+ */
+int usrl_schema_bind(void *base, const char *topic, const UsrlSchema *schema);
+
+/* 0 if usrl_schema_bind() would accept the schema (or has), else as bind */
+int usrl_schema_check(void *base, const char *topic, const UsrlSchema *schema);
+
+/*
+ * Heap copy of the newest version bound to a topic (free with
+ * usrl_schema_free), or NULL if it has none or the stored descriptor does
+ * not match its fingerprint.
+ */
+UsrlSchema *usrl_schema_attach(void *base, const char *topic);
+
+/* Same for one bound version */
+UsrlSchema *usrl_schema_attach_version(void *base, const char *topic, uint32_t version);
+
+/*
+ * Walk the versions bound to a topic, oldest first: the descriptor after
+ * `prev` (the first for NULL), or NULL at the end. Points into the region.
+ */
+const UsrlShmSchema *usrl_schema_next_desc(void *base, const char *topic,
+                                           const UsrlShmSchema *prev);
+
+/* Heap schema rebuilt from a descriptor copied out of a region, as attach */
+UsrlSchema *usrl_schema_from_desc(const UsrlShmSchema *desc);
+
+/*
+ * Value a reader sees for a field the writer's version does not have
+ * (default zero). Returns bytes copied, or -1.
+ */
+int usrl_schema_set_default(UsrlSchema *schema, UsrlFieldId fid, const void *value,
+                            uint32_t len);
+
+/*
+ * Reading across versions. A UsrlSchemaMap maps each field of the reader's
+ * schema to its offset in one writer version's payload, or to the reader's
+ * default when that version lacks it. Maps are built once per writer version
+ * a reader meets, then fields are read in place from the received payload:
+ *
+ *     int len = usrl_sub_next(&sub, buf, sizeof(buf), NULL);
+ *     const UsrlSchemaMap *m = usrl_schema_reader_map(&rd, sub.schema_ver, len);
+ *     if (m) px = usrl_map_get_f64(m, buf, f_px);
+ *
+ * Unstamped messages (version 0) are read in the reader's own layout. A
+ * version that cannot be read (not bound, or a changed field) is cached too,
+ * and looked up again only once the region has allocated something since
+ * (a version bound later).
+ */
+#define USRL_SCHEMA_MAPS 8           /* writer versions cached per reader */
+#define USRL_FIELD_MISSING 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t version;  /* writer version this map reads */
+    uint32_t size;     /* payload bytes that version needs, UINT32_MAX: unreadable */
+    uint64_t stamp;    /* CoreHeader.alloc_offset when an unreadable map was cached */
+    const uint8_t *defaults;
+    uint32_t src[USRL_MAX_FIELDS]; /* reader field -> writer offset, or USRL_FIELD_MISSING */
+} UsrlSchemaMap;
+
+typedef struct {
+    const UsrlSchema *schema; /* the reader's layout */
+    void *base;
+    char topic[64];
+    uint32_t count;           /* maps built so far */
+    UsrlSchemaMap self;       /* writer version == reader version */
+    UsrlSchemaMap maps[USRL_SCHEMA_MAPS];
+} UsrlSchemaReader;
+
+/* schema must be finalized and outlive the reader. Returns 0, -1 invalid. */
+int usrl_schema_reader_init(UsrlSchemaReader *r, void *base, const char *topic,
+                            const UsrlSchema *schema);
+
+/*
+ * Map for messages of writer `version`, len bytes long. NULL if that version
+ * is not bound to the topic, has another field type, or len is too short.
+ */
+const UsrlSchemaMap *usrl_schema_reader_map(UsrlSchemaReader *r, uint32_t version,
+                                            uint32_t len);
+
+/* Field of a received payload, in place, or its default */
+static inline const uint8_t *usrl_map_field(const UsrlSchemaMap *m, const uint8_t *payload,
+                                            UsrlFieldId fid)
+{
+    uint32_t src = m->src[USRL_FIELD_INDEX(fid)];
+    return src == USRL_FIELD_MISSING ? m->defaults + USRL_FIELD_OFFSET(fid) : payload + src;
+}
+
+#define USRL_SCHEMA_MAP_ACCESSOR(suffix, ctype)                                          \
+    static inline ctype usrl_map_get_##suffix(const UsrlSchemaMap *m,                    \
+                                              const uint8_t *payload, UsrlFieldId fid)   \
+    {                                                                                    \
+        ctype v;                                                                         \
+        memcpy(&v, usrl_map_field(m, payload, fid), sizeof(v));                          \
+        return v;                                                                        \
+    }
+
+USRL_SCHEMA_MAP_ACCESSOR(u64, uint64_t)
+USRL_SCHEMA_MAP_ACCESSOR(i64, int64_t)
+USRL_SCHEMA_MAP_ACCESSOR(f64, double)
+USRL_SCHEMA_MAP_ACCESSOR(u32, uint32_t)
+USRL_SCHEMA_MAP_ACCESSOR(i32, int32_t)
+USRL_SCHEMA_MAP_ACCESSOR(f32, float)
+
+/* Variable field of a received payload of len bytes; empty if the version lacks it */
+static inline UsrlVarView usrl_map_get_var(const UsrlSchemaMap *m, const uint8_t *payload,
+                                           uint32_t len, UsrlFieldId fid)
+{
+    return usrl_var_ref_view(payload, len, usrl_map_field(m, payload, fid));
+}
+
+/*
+ * Process-local registry used by the usrl.h facade to resolve
+ * usrl_pub_config_t.schema_name. The registry keeps the pointer; the schema
+ * must stay alive while registered. Returns 0, -1 invalid or full.
+ */
+int usrl_schema_register(UsrlSchema *schema);
+UsrlSchema *usrl_schema_find(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* USRL_SCHEMA_H */
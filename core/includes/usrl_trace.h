@@ -0,0 +1,104 @@
+/**
+ * @file usrl_trace.h
+ * @brief Per-message flight recorder in shared memory.
+ *
+ * The trace region (default "/usrl-trace") holds one ring of fixed 32-byte
+ * records per tracing thread, from any number of processes. While tracing
+ * is on, every publish and every delivered message appends a record with
+ * the topic, seq, time and duration: a few plain stores to a thread-owned
+ * line, no lock and no system call. Rings wrap, keeping the newest records.
+ *
+ * usrl_trace_export_chrome() (and the usrl-trace tool) turns the region
+ * into Chrome trace / Perfetto JSON, one slice per publish and consume and
+ * a flow arrow from each publish to every consume of the same topic+seq,
+ * across processes. Timestamps are CLOCK_MONOTONIC, shared by the host.
+ */
+
+#ifndef USRL_TRACE_H
+#define USRL_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define USRL_TRACE_SHM      "/usrl-trace"
+#define USRL_TRACE_MAGIC    0x52545355u /* "USTR" */
+#define USRL_TRACE_VERSION  1
+#define USRL_TRACE_RINGS    64       /* default tracing threads */
+#define USRL_TRACE_RECORDS  16384    /* default records per ring (power of two) */
+#define USRL_TRACE_NAMES    1024     /* topic / event names */
+#define USRL_TRACE_NAME_MAX 60
+
+/* Record kinds */
+#define USRL_TRACE_PUB  1 /* publish: arg = payload bytes */
+#define USRL_TRACE_SUB  2 /* message delivered: arg = payload bytes */
+#define USRL_TRACE_USER 3 /* usrl_trace_event(): arg = payload size */
+
+typedef struct {
+    uint64_t ts;      /* start, ns */
+    uint64_t seq;
+    uint32_t topic;   /* usrl_trace_topic() of the name */
+    uint32_t dur_ns;
+    uint16_t kind;
+    uint16_t pub_id;
+    uint32_t arg;
+} UsrlTraceRec;
+
+typedef struct {
+    uint32_t hash; /* 0 while being written */
+    char name[USRL_TRACE_NAME_MAX];
+} UsrlTraceName;
+
+/* Ring header; ring_records UsrlTraceRec follow it */
+typedef struct {
+    uint64_t head;    /* records ever written (atomic) */
+    uint32_t owner;   /* pid of the live owner, 0 = free (atomic) */
+    uint32_t pid;     /* last owner, kept after release for the exporter */
+    uint32_t tid;
+    char thread[20];
+    uint8_t _pad[24];
+} UsrlTraceRing;
+
+typedef struct {
+    uint32_t magic;   /* written last */
+    uint32_t version;
+    uint32_t ring_count;
+    uint32_t ring_records;
+    uint32_t name_cap;
+    uint32_t name_count; /* atomic */
+    uint64_t names_offset;
+    uint64_t rings_offset;
+    uint64_t size;
+} UsrlTraceHeader;
+
+extern int usrl_trace_on;
+
+static inline bool usrl_tracing(void)
+{
+    return __builtin_expect(__atomic_load_n(&usrl_trace_on, __ATOMIC_RELAXED), 0);
+}
+
+/*
+ * Create or attach the trace region and start recording in this process.
+ * NULL / 0 take the defaults. Returns 0, -1 if the region cannot be created
+ * or has another geometry in use.
+ */
+int usrl_trace_open(const char *shm_name, uint32_t rings, uint32_t records);
+
+/* Stop recording in this process; the region and its records stay */
+void usrl_trace_close(void);
+
+/* Stable id of a topic or event name; registers it in the region when open */
+uint32_t usrl_trace_topic(const char *name);
+
+/* Append a record to the calling thread's ring (no-op when not tracing) */
+void usrl_trace_rec(uint32_t kind, uint32_t topic, uint64_t seq, uint16_t pub_id,
+                    uint64_t ts, uint64_t end, uint32_t arg);
+
+/*
+ * Write the region as Chrome trace JSON (loads in chrome://tracing and
+ * ui.perfetto.dev). Returns the number of records exported, -1 if the
+ * region cannot be mapped, -2 on I/O errors.
+ */
+int usrl_trace_export_chrome(const char *shm_name, const char *out_path);
+
+#endif /* USRL_TRACE_H */
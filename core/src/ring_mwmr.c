@@ -29,26 +29,154 @@ static inline void backoff(int iter) {
     else sched_yield();
 }
 
+static inline uint64_t writer_share(const UsrlWriterEntry *w, uint64_t slots, uint32_t total) {
+    uint32_t weight = atomic_load_explicit(&w->weight, memory_order_relaxed);
+    if (total == 0) return slots;
+    uint64_t share = slots * weight / total;
+    return share ? share : 1;
+}
+
+/*
+ * Called only once this writer has used up its share of the window: the
+ * claim is refused if some other active writer is still below its own
+ * share. A writer is active if it claimed in this or the previous window and
+ * within USRL_FAIR_IDLE_NS: refused claims do not advance w_head, so a
+ * writer that went quiet would otherwise hold the window open for good.
+ * Spare capacity is handed out once the others are idle.
+ */
+static USRL_NOINLINE bool others_waiting(UsrlMwmrPublisher *p, uint64_t win, uint64_t slots) {
+    UsrlWriterTable *wt = p->writers;
+    uint32_t total = atomic_load_explicit(&wt->total_weight, memory_order_relaxed);
+    uint64_t now = usrl_timestamp_ns();
+
+    for (int i = 0; i < USRL_MAX_WRITERS; i++) {
+        UsrlWriterEntry *e = &wt->entries[i];
+        if (e == p->writer || atomic_load_explicit(&e->owner, memory_order_relaxed) == 0)
+            continue;
+
+        uint64_t e_win = atomic_load_explicit(&e->window, memory_order_relaxed);
+        if (e_win + 1 < win) continue; /* idle */
+        uint64_t e_ns = atomic_load_explicit(&e->claim_ns, memory_order_relaxed);
+        if (now > e_ns && now - e_ns > USRL_FAIR_IDLE_NS) continue; /* quiet */
+
+        uint64_t used = (e_win == win)
+            ? atomic_load_explicit(&e->window_claims, memory_order_relaxed) : 0;
+        if (used < writer_share(e, slots, total)) return true;
+    }
+    return false;
+}
+
+/* Fair share gate, run before claiming. Returns true if this claim may proceed. */
+static inline bool fair_admit(UsrlMwmrPublisher *p, uint64_t slots) {
+    UsrlWriterEntry *w = p->writer;
+    uint64_t head = atomic_load_explicit(&p->desc->w_head, memory_order_relaxed) & ~USRL_HEAD_RESIZING;
+    uint64_t win = head / slots;
+
+    uint64_t used = atomic_load_explicit(&w->window_claims, memory_order_relaxed);
+    if (atomic_load_explicit(&w->window, memory_order_relaxed) != win) {
+        atomic_store_explicit(&w->window, win, memory_order_relaxed);
+        used = 0;
+    }
+
+    uint32_t total = atomic_load_explicit(&p->writers->total_weight, memory_order_relaxed);
+    if (USRL_UNLIKELY(used >= writer_share(w, slots, total)) && others_waiting(p, win, slots)) {
+        atomic_store_explicit(&w->window_claims, used, memory_order_relaxed);
+        return false;
+    }
+
+    atomic_store_explicit(&w->window_claims, used + 1, memory_order_relaxed);
+    return true;
+}
+
 void usrl_mwmr_pub_init(UsrlMwmrPublisher *p, void *core_base, const char *topic, uint16_t pub_id) {
     if (!p || !core_base || !topic) return;
     TopicEntry *t = usrl_get_topic(core_base, topic);
     if (!t) return;
     if (t->type != USRL_RING_TYPE_MWMR) return;
 
+    p->core_base = (uint8_t *)core_base;
     p->desc = (RingDesc *)((uint8_t *)core_base + t->ring_desc_offset);
+    p->epoch = atomic_load_explicit(&p->desc->epoch, memory_order_acquire);
     p->base_ptr = (uint8_t *)core_base + p->desc->base_offset;
     p->mask = p->desc->slot_count - 1;
     p->pub_id = pub_id;
+    p->gen = p->desc->generation;
+
+    p->writers = (UsrlWriterTable *)((uint8_t *)core_base + t->writers_offset);
+    p->writer = usrl_writer_attach(core_base, t, pub_id);
+    /* Without an entry there is no share to enforce: usrl-ctl shows it as untracked */
+    p->fair = (t->flags & USRL_TOPIC_FAIR) && p->writer;
+    p->trace_topic = usrl_trace_topic(t->name);
+    p->schema_id = 0;
+    p->schema_ver = 0;
+    p->pending = NULL;
 }
 
-int usrl_mwmr_pub_publish(UsrlMwmrPublisher *p, const void *data, uint32_t len) {
-    if (USRL_UNLIKELY(!p || !p->desc || !data)) return USRL_RING_ERROR;
+void usrl_mwmr_pub_set_schema(UsrlMwmrPublisher *p, const UsrlSchema *schema) {
+    if (!p) return;
+    p->schema_id = schema ? schema->schema_id : 0;
+    p->schema_ver = schema ? (uint16_t)schema->version : 0;
+}
+
+int usrl_mwmr_pub_set_weight(UsrlMwmrPublisher *p, uint32_t weight) {
+    if (!p || !p->writer || weight == 0) return -1;
+    uint32_t old = atomic_exchange_explicit(&p->writer->weight, weight, memory_order_relaxed);
+    atomic_fetch_add_explicit(&p->writers->total_weight, weight - old, memory_order_relaxed);
+    return 0;
+}
+
+/*
+ * The open claim goes in the writer entry so a watchdog can spot a writer
+ * stalled between claim and commit: that slot blocks every writer a lap
+ * later. Owner-only stores; claim_ns is published by the release on seq.
+ */
+static inline void mwmr_claim_begin(UsrlWriterEntry *w, uint64_t seq, uint64_t now) {
+    atomic_store_explicit(&w->claim_ns, now, memory_order_relaxed);
+    atomic_store_explicit(&w->claim_seq, seq, memory_order_release);
+    usrl_writer_count(&w->claimed);
+}
+
+static inline void mwmr_claim_end(UsrlWriterEntry *w, atomic_uint_fast64_t *outcome) {
+    atomic_store_explicit(&w->claim_seq, 0, memory_order_relaxed);
+    usrl_writer_count(outcome);
+}
+
+static USRL_NOINLINE void mwmr_pub_refresh(UsrlMwmrPublisher *p) {
     RingDesc *d = p->desc;
+    usrl_ring_wait_resize(d);
+    p->epoch = atomic_load_explicit(&d->epoch, memory_order_acquire);
+    p->base_ptr = p->core_base + d->base_offset;
+    p->mask = d->slot_count - 1;
+    p->gen = d->generation;
+}
 
-    if (USRL_UNLIKELY(len > (d->slot_size - sizeof(SlotHeader)))) return USRL_RING_FULL;
+/*
+ * Claim the next seq and take its slot. Returns the slot, open for the
+ * payload, or NULL with *rc set (USRL_RING_QUOTA / USRL_RING_TIMEOUT).
+ */
+static inline SlotHeader *mwmr_claim(UsrlMwmrPublisher *p, uint64_t *out_seq, uint64_t *out_ns,
+                                     int *rc) {
+    RingDesc *d = p->desc;
+
+    if (p->fair && USRL_UNLIKELY(!fair_admit(p, (uint64_t)p->mask + 1))) {
+        usrl_writer_count(&p->writer->throttled);
+        *rc = USRL_RING_QUOTA;
+        return NULL;
+    }
 
+    /*
+     * The slot CAS below orders the payload; acq_rel on the claim is for
+     * resize, so a claim made after the switch sees the new geometry.
+     */
     uint64_t old_head = atomic_fetch_add_explicit(&d->w_head, 1, memory_order_acq_rel);
-    uint64_t commit_seq = old_head + 1;
+    if (USRL_UNLIKELY((old_head & USRL_HEAD_RESIZING) ||
+                      atomic_load_explicit(&d->epoch, memory_order_relaxed) != p->epoch)) {
+        mwmr_pub_refresh(p);
+    }
+    uint64_t commit_seq = (old_head & ~USRL_HEAD_RESIZING) + 1;
+    uint64_t slots = (uint64_t)p->mask + 1;
+    uint64_t now = usrl_timestamp_ns(); /* claim time, also the slot timestamp */
+    if (p->writer) mwmr_claim_begin(p->writer, commit_seq, now);
 
     uint32_t idx = (uint32_t)((commit_seq - 1) & p->mask);
     uint8_t *slot = p->base_ptr + ((uint64_t)idx * d->slot_size);
@@ -56,33 +184,122 @@ int usrl_mwmr_pub_publish(UsrlMwmrPublisher *p, const void *data, uint32_t len)
 
     int iter = 0;
     const int max_iter = 100000;
+    uint64_t my_gen = commit_seq / slots;
 
+    /*
+     * Take the slot by swapping in claim|BUSY. Acquire on success pairs with
+     * the previous lap's release commit, so two writers a lap apart can never
+     * interleave their payload bytes.
+     */
+    uint64_t current_seq = atomic_load_explicit(&hdr->seq, memory_order_relaxed);
     while (1) {
-        uint64_t current_seq = atomic_load_explicit(&hdr->seq, memory_order_acquire);
-
-        if (current_seq == 0) break;
+        uint64_t current_gen = (current_seq & ~USRL_SEQ_BUSY) / slots;
 
-        uint64_t my_gen = commit_seq / d->slot_count;
-        uint64_t current_gen = current_seq / d->slot_count;
+        /* A later lap already owns the slot: our claim can never land */
+        if (USRL_UNLIKELY(current_seq != 0 && current_gen > my_gen)) {
+            if (p->writer) mwmr_claim_end(p->writer, &p->writer->timeouts);
+            *rc = USRL_RING_TIMEOUT;
+            return NULL;
+        }
 
-        if (current_gen < my_gen) break;
+        if (!(current_seq & USRL_SEQ_BUSY) &&
+            (current_seq == 0 || current_gen < my_gen)) {
+            if (atomic_compare_exchange_weak_explicit(&hdr->seq, &current_seq,
+                                                      commit_seq | USRL_SEQ_BUSY,
+                                                      memory_order_acquire,
+                                                      memory_order_relaxed))
+                break;
+            continue;
+        }
 
         backoff(iter++);
         if (USRL_UNLIKELY(iter > max_iter)) {
-            return USRL_RING_TIMEOUT; /* Standardized Timeout */
+            if (p->writer) mwmr_claim_end(p->writer, &p->writer->timeouts);
+            *rc = USRL_RING_TIMEOUT; /* Standardized Timeout */
+            return NULL;
         }
+        current_seq = atomic_load_explicit(&hdr->seq, memory_order_relaxed);
     }
 
+    USRL_SMP_WMB();
     USRL_PREFETCH_W(slot + sizeof(SlotHeader));
 
-    memcpy(slot + sizeof(SlotHeader), data, len);
+    *out_seq = commit_seq;
+    *out_ns = now;
+    return hdr;
+}
+
+static inline void mwmr_commit(UsrlMwmrPublisher *p, SlotHeader *hdr, uint64_t commit_seq,
+                               uint64_t now, uint32_t len) {
     hdr->payload_len = len;
     hdr->pub_id = p->pub_id;
-    hdr->timestamp_ns = usrl_timestamp_ns();
+    hdr->schema_ver = p->schema_ver;
+    hdr->gen = p->gen;
+    hdr->schema_id = p->schema_id;
+    hdr->timestamp_ns = now;
 
-    atomic_thread_fence(memory_order_release);
     atomic_store_explicit(&hdr->seq, commit_seq, memory_order_release);
+    if (p->writer) mwmr_claim_end(p->writer, &p->writer->published);
+    if (USRL_UNLIKELY(usrl_tracing()))
+        usrl_trace_rec(USRL_TRACE_PUB, p->trace_topic, commit_seq, p->pub_id, now,
+                       usrl_timestamp_ns(), len);
+}
+
+int usrl_mwmr_pub_publish(UsrlMwmrPublisher *p, const void *data, uint32_t len) {
+    if (USRL_UNLIKELY(!p || !p->desc || !data)) return USRL_RING_ERROR;
+    if (USRL_UNLIKELY(len > (p->desc->slot_size - sizeof(SlotHeader)))) return USRL_RING_FULL;
 
+    uint64_t commit_seq, now;
+    int rc = USRL_RING_ERROR;
+    SlotHeader *hdr = mwmr_claim(p, &commit_seq, &now, &rc);
+    if (!hdr) return rc;
+    memcpy(hdr + 1, data, len);
+    mwmr_commit(p, hdr, commit_seq, now, len);
+    return USRL_RING_OK;
+}
+
+/*
+ * The claim stays open in the writer entry until the commit, so a writer
+ * sitting on a reservation shows up like any stalled writer.
+ */
+uint8_t *usrl_mwmr_pub_reserve(UsrlMwmrPublisher *p, uint32_t len, int *rc) {
+    int err = USRL_RING_ERROR;
+    if (USRL_UNLIKELY(!p || !p->desc || p->pending)) goto fail;
+    err = USRL_RING_FULL;
+    if (USRL_UNLIKELY(len > (p->desc->slot_size - sizeof(SlotHeader)))) goto fail;
+
+    p->pending = mwmr_claim(p, &p->pending_seq, &p->pending_ns, &err);
+    if (!p->pending) goto fail;
+    return (uint8_t *)(p->pending + 1);
+
+fail:
+    if (rc) *rc = err;
+    return NULL;
+}
+
+int usrl_mwmr_pub_commit(UsrlMwmrPublisher *p, uint32_t len) {
+    if (USRL_UNLIKELY(!p || !p->pending)) return USRL_RING_ERROR;
+    if (USRL_UNLIKELY(len > (p->desc->slot_size - sizeof(SlotHeader)))) return USRL_RING_FULL;
+
+    mwmr_commit(p, p->pending, p->pending_seq, p->pending_ns, len);
+    p->pending = NULL;
+    return USRL_RING_OK;
+}
+
+/* Release the claim with no message in it: the slot is free for the next lap */
+int usrl_mwmr_pub_abort(UsrlMwmrPublisher *p) {
+    if (USRL_UNLIKELY(!p || !p->pending)) return USRL_RING_ERROR;
+
+    SlotHeader *hdr = p->pending;
+    hdr->payload_len = USRL_SLOT_ABORTED;
+    hdr->pub_id = p->pub_id;
+    hdr->schema_ver = 0;
+    hdr->gen = p->gen;
+    hdr->schema_id = 0;
+    hdr->timestamp_ns = p->pending_ns;
+    atomic_store_explicit(&hdr->seq, p->pending_seq, memory_order_release);
+    if (p->writer) mwmr_claim_end(p->writer, &p->writer->dropped);
+    p->pending = NULL;
     return USRL_RING_OK;
 }
 
@@ -95,6 +312,5 @@ void usrl_mwmr_sub_init(UsrlSubscriber *s, void *core_base, const char *topic) {
 
 uint64_t usrl_mwmr_total_published(void *ring_desc) {
     if (!ring_desc) return 0;
-    RingDesc *d = (RingDesc *)ring_desc;
-    return atomic_load_explicit(&d->w_head, memory_order_acquire);
+    return usrl_ring_head((RingDesc *)ring_desc);
 }
@@ -0,0 +1,162 @@
+/**
+ * @file ring_resize.c
+ * @brief Online ring growth for SWMR and MWMR topics.
+ *
+ * Protocol (all state lives in the RingDesc):
+ *   1. Resizer sets USRL_HEAD_RESIZING in w_head (fetch_or). The value it
+ *      gets back, H, splits claims: seq <= H belong to the old ring, seq > H
+ *      to the new one. Writers that see the flag in their claim wait.
+ *   2. Resizer waits for claims <= H to commit, then copies the retained
+ *      window (H - old_slots, H] into the new ring at the same seqs. It
+ *      keeps waiting while the claim's writer is alive (an open
+ *      reservation holds the resize up until it is committed or aborted);
+ *      a claim whose writer died, or that no writer entry accounts for
+ *      after USRL_RESIZE_DRAIN_NS, is left in the new ring as an aborted
+ *      slot so readers step over it instead of waiting on it.
+ *   3. Resizer publishes base_offset/slot_count, bumps epoch (release) and
+ *      clears the flag (release). Waiting writers proceed on the new ring.
+ *
+ * Subscribers notice the epoch change and remap; since seqs are continuous
+ * and the window was copied, their cursor carries over unchanged. A cursor
+ * below the window moves up to floor_seq: those messages were not copied.
+ */
+
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+
+/* How long to wait for a claim <= H that no live writer accounts for */
+#define USRL_RESIZE_DRAIN_NS (100ULL * 1000000ULL)
+
+static inline uint64_t usrl_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t next_power_of_two_u32(uint32_t v) {
+    if (v == 0) return 1;
+    v--;
+    v |= v >> 1;
+    v |= v >> 2;
+    v |= v >> 4;
+    v |= v >> 8;
+    v |= v >> 16;
+    return ++v;
+}
+
+void usrl_ring_wait_resize(RingDesc *d) {
+    while (atomic_load_explicit(&d->w_head, memory_order_acquire) & USRL_HEAD_RESIZING) {
+        sched_yield();
+    }
+}
+
+static bool pid_alive(uint32_t pid) {
+    return pid != 0 && (kill((pid_t)pid, 0) == 0 || errno != ESRCH);
+}
+
+/*
+ * Can claim `want` still be committed? An MWMR claim is held by the entry
+ * whose claim_seq it is; a SWMR topic has one writer, so any live entry
+ * may hold it. A claim no entry accounts for (untracked writer) is not.
+ */
+static bool claim_live(const TopicEntry *t, const UsrlWriterTable *wt, uint64_t want) {
+    for (int i = 0; i < USRL_MAX_WRITERS; i++) {
+        const UsrlWriterEntry *e = &wt->entries[i];
+        if (atomic_load_explicit(&e->owner, memory_order_relaxed) == 0) continue;
+        if (t->type == USRL_RING_TYPE_MWMR) {
+            if (atomic_load_explicit(&e->claim_seq, memory_order_relaxed) == want)
+                return pid_alive(e->pid);
+        } else if (pid_alive(e->pid)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Wait until claim `want` has committed to `hdr`. Returns false if it never will. */
+static bool drain_slot(const TopicEntry *t, const UsrlWriterTable *wt, SlotHeader *hdr,
+                       uint64_t want, uint64_t deadline) {
+    for (;;) {
+        uint64_t seq = atomic_load_explicit(&hdr->seq, memory_order_acquire);
+        if (seq == want) return true;
+        /* A writer that timed out leaves an older seq behind for good */
+        if (!(seq & USRL_SEQ_BUSY) && seq > want) return false;
+        if (usrl_timestamp_ns() > deadline && !claim_live(t, wt, want)) return false;
+        sched_yield();
+    }
+}
+
+int usrl_ring_resize(void *core_base, const char *topic, uint32_t new_slot_count) {
+    if (!core_base || !topic || new_slot_count == 0) return -1;
+
+    TopicEntry *t = usrl_get_topic(core_base, topic);
+    if (!t) return -1;
+    RingDesc *d = (RingDesc *)((uint8_t *)core_base + t->ring_desc_offset);
+
+    uint32_t new_slots = next_power_of_two_u32(new_slot_count);
+    if (new_slots == 0 || new_slots <= d->slot_count) return -1;
+
+    uint64_t prev = atomic_fetch_or_explicit(&d->w_head, USRL_HEAD_RESIZING,
+                                             memory_order_acq_rel);
+    if (prev & USRL_HEAD_RESIZING) return -2;
+
+    uint64_t old_slots = d->slot_count;
+    uint64_t new_offset = usrl_core_alloc(core_base, (uint64_t)new_slots * d->slot_size);
+    if (new_offset == 0) {
+        atomic_fetch_and_explicit(&d->w_head, ~USRL_HEAD_RESIZING, memory_order_release);
+        return -4;
+    }
+
+    uint8_t *old_ring = (uint8_t *)core_base + d->base_offset;
+    uint8_t *new_ring = (uint8_t *)core_base + new_offset;
+    uint64_t new_mask = new_slots - 1;
+    uint64_t floor_seq = (prev > old_slots) ? prev - old_slots : 0;
+    /* Seqs at or below the current floor (a restore) were never in this ring */
+    uint64_t cur_floor = atomic_load_explicit(&d->floor_seq, memory_order_relaxed);
+    if (cur_floor > floor_seq) floor_seq = cur_floor < prev ? cur_floor : prev;
+    uint64_t deadline = usrl_timestamp_ns() + USRL_RESIZE_DRAIN_NS;
+    const UsrlWriterTable *wt = (const UsrlWriterTable *)((uint8_t *)core_base + t->writers_offset);
+
+    /* The new ring has never been written, so its slots start out empty */
+    for (uint64_t seq = floor_seq + 1; seq <= prev; seq++) {
+        uint8_t *src = old_ring + ((seq - 1) % old_slots) * (uint64_t)d->slot_size;
+        uint8_t *dst = new_ring + ((seq - 1) & new_mask) * (uint64_t)d->slot_size;
+        SlotHeader *sh = (SlotHeader *)src;
+        SlotHeader *dh = (SlotHeader *)dst;
+
+        if (!drain_slot(t, wt, sh, seq, deadline)) {
+            /* Never coming: readers step over it rather than wait */
+            dh->payload_len = USRL_SLOT_ABORTED;
+            dh->gen = d->generation;
+            atomic_store_explicit(&dh->seq, seq, memory_order_relaxed);
+            continue;
+        }
+
+        /* A stale-generation slot is copied as is: readers drop it */
+        memcpy(dst + sizeof(SlotHeader), src + sizeof(SlotHeader),
+               d->slot_size - sizeof(SlotHeader));
+        dh->timestamp_ns = sh->timestamp_ns;
+        dh->payload_len = sh->payload_len;
+        dh->pub_id = sh->pub_id;
+        dh->schema_id = sh->schema_id;
+        dh->schema_ver = sh->schema_ver;
+        dh->gen = sh->gen;
+        atomic_store_explicit(&dh->seq, seq, memory_order_relaxed);
+    }
+
+    /* Switch: geometry, then epoch, then let writers through */
+    if (floor_seq > atomic_load_explicit(&d->floor_seq, memory_order_relaxed))
+        atomic_store_explicit(&d->floor_seq, floor_seq, memory_order_relaxed);
+    d->base_offset = new_offset;
+    d->slot_count = new_slots;
+    t->slot_count = new_slots;
+    atomic_fetch_add_explicit(&d->epoch, 1, memory_order_release);
+    atomic_fetch_and_explicit(&d->w_head, ~USRL_HEAD_RESIZING, memory_order_release);
+
+    return 0;
+}
@@ -8,6 +8,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
 
 /* Debug macros omitted for brevity */
 
@@ -21,21 +24,50 @@ void usrl_pub_init(UsrlPublisher *p, void *core_base, const char *topic, uint16_
     if (!p || !core_base || !topic) return;
     TopicEntry *t = usrl_get_topic(core_base, topic);
     if (!t) return;
+    p->core_base = (uint8_t *)core_base;
     p->desc = (RingDesc *)((uint8_t *)core_base + t->ring_desc_offset);
+    p->epoch = atomic_load_explicit(&p->desc->epoch, memory_order_acquire);
     p->base_ptr = (uint8_t *)core_base + p->desc->base_offset;
     p->mask = p->desc->slot_count - 1;
     p->pub_id = pub_id;
+    p->gen = p->desc->generation;
+    p->writer = usrl_writer_attach(core_base, t, pub_id);
+    p->trace_topic = usrl_trace_topic(t->name);
+    p->schema_id = 0;
+    p->schema_ver = 0;
+    p->pending = NULL;
 }
 
-int usrl_pub_publish(UsrlPublisher *p, const void *data, uint32_t len) {
-    if (USRL_UNLIKELY(!p || !p->desc || !data)) return USRL_RING_ERROR;
+void usrl_pub_set_schema(UsrlPublisher *p, const UsrlSchema *schema) {
+    if (!p) return;
+    p->schema_id = schema ? schema->schema_id : 0;
+    p->schema_ver = schema ? (uint16_t)schema->version : 0;
+}
+
+/* Claim landed on a ring that is being (or was) resized: move to the new one */
+static USRL_NOINLINE void pub_refresh(UsrlPublisher *p) {
     RingDesc *d = p->desc;
+    usrl_ring_wait_resize(d);
+    p->epoch = atomic_load_explicit(&d->epoch, memory_order_acquire);
+    p->base_ptr = p->core_base + d->base_offset;
+    p->mask = d->slot_count - 1;
+    p->gen = d->generation;
+}
 
-    /* Check size */
-    if (USRL_UNLIKELY(len > (d->slot_size - sizeof(SlotHeader)))) return USRL_RING_FULL;
+/* Claim the next seq and open its slot's seqlock; the payload is written next */
+static inline SlotHeader *pub_claim(UsrlPublisher *p, uint64_t *out_seq) {
+    RingDesc *d = p->desc;
 
+    /*
+     * Readers synchronize on the slot seq below; the claim is acq_rel so a
+     * claim made after a resize finished also observes the new geometry.
+     */
     uint64_t old_head = atomic_fetch_add_explicit(&d->w_head, 1, memory_order_acq_rel);
-    uint64_t commit_seq = old_head + 1;
+    if (USRL_UNLIKELY((old_head & USRL_HEAD_RESIZING) ||
+                      atomic_load_explicit(&d->epoch, memory_order_relaxed) != p->epoch)) {
+        pub_refresh(p);
+    }
+    uint64_t commit_seq = (old_head & ~USRL_HEAD_RESIZING) + 1;
 
     uint32_t idx = (uint32_t)((commit_seq - 1) & p->mask);
     uint8_t *slot = p->base_ptr + ((uint64_t)idx * d->slot_size);
@@ -43,14 +75,78 @@ int usrl_pub_publish(UsrlPublisher *p, const void *data, uint32_t len) {
 
     USRL_PREFETCH_W(slot + sizeof(SlotHeader));
 
-    memcpy(slot + sizeof(SlotHeader), data, len);
+    /* Open the seqlock so a reader still copying the previous lap sees a change */
+    atomic_store_explicit(&hdr->seq, commit_seq | USRL_SEQ_BUSY, memory_order_relaxed);
+    USRL_SMP_WMB();
+
+    *out_seq = commit_seq;
+    return hdr;
+}
+
+static inline void pub_commit(UsrlPublisher *p, SlotHeader *hdr, uint64_t commit_seq,
+                              uint32_t len, uint64_t trace_ns) {
     hdr->payload_len = len;
     hdr->pub_id = p->pub_id;
+    hdr->schema_ver = p->schema_ver;
+    hdr->gen = p->gen;
+    hdr->schema_id = p->schema_id;
     hdr->timestamp_ns = usrl_timestamp_ns();
 
-    atomic_thread_fence(memory_order_release);
+    /* Release store alone orders the payload before the commit */
     atomic_store_explicit(&hdr->seq, commit_seq, memory_order_release);
-    
+    if (p->writer) usrl_writer_count(&p->writer->published);
+    if (USRL_UNLIKELY(trace_ns))
+        usrl_trace_rec(USRL_TRACE_PUB, p->trace_topic, commit_seq, p->pub_id, trace_ns,
+                       hdr->timestamp_ns, len);
+}
+
+int usrl_pub_publish(UsrlPublisher *p, const void *data, uint32_t len) {
+    if (USRL_UNLIKELY(!p || !p->desc || !data)) return USRL_RING_ERROR;
+    RingDesc *d = p->desc;
+
+    /* Check size */
+    if (USRL_UNLIKELY(len > (d->slot_size - sizeof(SlotHeader)))) return USRL_RING_FULL;
+    uint64_t trace_ns = usrl_tracing() ? usrl_timestamp_ns() : 0;
+
+    uint64_t commit_seq;
+    SlotHeader *hdr = pub_claim(p, &commit_seq);
+    memcpy(hdr + 1, data, len);
+    pub_commit(p, hdr, commit_seq, len, trace_ns);
+    return USRL_RING_OK;
+}
+
+uint8_t *usrl_pub_reserve(UsrlPublisher *p, uint32_t len) {
+    if (USRL_UNLIKELY(!p || !p->desc || p->pending)) return NULL;
+    if (USRL_UNLIKELY(len > (p->desc->slot_size - sizeof(SlotHeader)))) return NULL;
+
+    p->pending_ns = usrl_tracing() ? usrl_timestamp_ns() : 0;
+    p->pending = pub_claim(p, &p->pending_seq);
+    return (uint8_t *)(p->pending + 1);
+}
+
+int usrl_pub_commit(UsrlPublisher *p, uint32_t len) {
+    if (USRL_UNLIKELY(!p || !p->pending)) return USRL_RING_ERROR;
+    if (USRL_UNLIKELY(len > (p->desc->slot_size - sizeof(SlotHeader)))) return USRL_RING_FULL;
+
+    pub_commit(p, p->pending, p->pending_seq, len, p->pending_ns);
+    p->pending = NULL;
+    return USRL_RING_OK;
+}
+
+/* Release the claimed seq with no message in it, so readers do not wait on it */
+int usrl_pub_abort(UsrlPublisher *p) {
+    if (USRL_UNLIKELY(!p || !p->pending)) return USRL_RING_ERROR;
+
+    SlotHeader *hdr = p->pending;
+    hdr->payload_len = USRL_SLOT_ABORTED;
+    hdr->pub_id = p->pub_id;
+    hdr->schema_ver = 0;
+    hdr->gen = p->gen;
+    hdr->schema_id = 0;
+    hdr->timestamp_ns = usrl_timestamp_ns();
+    atomic_store_explicit(&hdr->seq, p->pending_seq, memory_order_release);
+    if (p->writer) usrl_writer_count(&p->writer->dropped);
+    p->pending = NULL;
     return USRL_RING_OK;
 }
 
@@ -58,30 +154,195 @@ void usrl_sub_init(UsrlSubscriber *s, void *core_base, const char *topic) {
     if (!s || !core_base || !topic) return;
     TopicEntry *t = usrl_get_topic(core_base, topic);
     if (!t) return;
+    s->core_base = (uint8_t *)core_base;
     s->desc = (RingDesc *)((uint8_t *)core_base + t->ring_desc_offset);
+    s->epoch = atomic_load_explicit(&s->desc->epoch, memory_order_acquire);
     s->base_ptr = (uint8_t *)core_base + s->desc->base_offset;
     s->mask = s->desc->slot_count - 1;
-    s->last_seq = 0;
+    s->last_seq = atomic_load_explicit(&s->desc->floor_seq, memory_order_relaxed);
     s->skipped_count = 0;
+    s->gen = s->desc->generation;
+    s->readers = (UsrlReaderTable *)((uint8_t *)core_base + t->readers_offset);
+    s->reader = NULL;
+    s->read_count = 0;
+    s->max_lag = 0;
+    s->stats_pending = 0;
+    s->idle_polls = 0;
+    s->rate_ns = 0;
+    s->lat = NULL;
+    s->trace_topic = usrl_trace_topic(t->name);
+    s->schema_id = 0;
+    s->schema_ver = 0;
+    s->peek = NULL;
 }
 
-int usrl_sub_next(UsrlSubscriber *s, uint8_t *out_buf, uint32_t buf_len, uint16_t *out_pub_id) {
-    if (USRL_UNLIKELY(!s || !s->desc || !out_buf)) return USRL_RING_ERROR;
+int usrl_sub_register(UsrlSubscriber *s) {
+    if (!s || !s->readers) return -1;
+    if (s->reader) return 0;
+
+    /* Second pass takes over entries left by processes that have exited */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < USRL_MAX_READERS; i++) {
+            UsrlReaderEntry *e = &s->readers->entries[i];
+            uint32_t expected = 0;
+            if (pass == 1) {
+                if (e->pid == 0 || kill((pid_t)e->pid, 0) == 0 || errno != ESRCH) continue;
+                expected = 1;
+            }
+            if (atomic_compare_exchange_strong_explicit(&e->owner, &expected, 1,
+                                                        memory_order_acq_rel,
+                                                        memory_order_relaxed)) {
+                e->pid = (uint32_t)getpid();
+                atomic_store_explicit(&e->reads, s->read_count, memory_order_relaxed);
+                atomic_store_explicit(&e->skips, s->skipped_count, memory_order_relaxed);
+                atomic_store_explicit(&e->max_lag, s->max_lag, memory_order_relaxed);
+                atomic_store_explicit(&e->last_read_ns, 0, memory_order_relaxed);
+                atomic_store_explicit(&e->read_rate_hz, 0, memory_order_relaxed);
+                atomic_store_explicit(&e->head_rate_hz, 0, memory_order_relaxed);
+                atomic_store_explicit(&e->hb.tick, 0, memory_order_relaxed);
+                atomic_store_explicit(&e->hb.beat_ns, 0, memory_order_relaxed);
+                atomic_store_explicit(&e->hb.period_ms, 0, memory_order_relaxed);
+                uint64_t lat_off = atomic_load_explicit(&e->lat_offset, memory_order_acquire);
+                if (lat_off) usrl_latency_reset((UsrlLatencyHist *)(s->core_base + lat_off));
+                atomic_store_explicit(&e->cursor, s->last_seq, memory_order_release);
+                s->reader = e;
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+void usrl_sub_unregister(UsrlSubscriber *s) {
+    if (!s || !s->reader) return;
+    atomic_store_explicit(&s->reader->owner, 0, memory_order_release);
+    s->reader = NULL;
+    s->lat = NULL;
+}
+
+int usrl_sub_latency_enable(UsrlSubscriber *s) {
+    if (!s || !s->reader) return -1;
+    if (s->lat) return 0;
+
+    /* The histogram belongs to the entry: allocate once, reuse on re-register */
+    UsrlReaderEntry *e = s->reader;
+    uint64_t off = atomic_load_explicit(&e->lat_offset, memory_order_acquire);
+    if (off == 0) {
+        off = usrl_core_alloc(s->core_base, sizeof(UsrlLatencyHist));
+        if (off == 0) return -4;
+        atomic_store_explicit(&e->lat_offset, off, memory_order_release);
+    }
+    s->lat = (UsrlLatencyHist *)(s->core_base + off);
+    return 0;
+}
 
+/* Messages up to the ring's floor are gone: count them and move past */
+static inline void sub_clamp_floor(UsrlSubscriber *s) {
+    uint64_t floor = atomic_load_explicit(&s->desc->floor_seq, memory_order_relaxed);
+    if (s->last_seq >= floor) return;
+    s->skipped_count += floor - s->last_seq;
+    s->last_seq = floor;
+    if (s->reader) atomic_store_explicit(&s->reader->cursor, floor, memory_order_relaxed);
+}
+
+/*
+ * Ring was resized or restored: switch to the new geometry and generation.
+ * Sequence numbers are continuous across a resize and the retained window
+ * was copied over, so the cursor stays as it is unless it was below that
+ * window.
+ */
+static USRL_NOINLINE void sub_refresh(UsrlSubscriber *s) {
     RingDesc *d = s->desc;
-    uint64_t w_head = atomic_load_explicit(&d->w_head, memory_order_acquire);
+    s->epoch = atomic_load_explicit(&d->epoch, memory_order_acquire);
+    s->base_ptr = s->core_base + d->base_offset;
+    s->mask = d->slot_count - 1;
+    s->gen = d->generation;
+    sub_clamp_floor(s);
+}
+
+/* Publish this reader's counters and, once per window, its rates */
+static USRL_NOINLINE void sub_stats_flush(UsrlSubscriber *s, uint64_t w_head) {
+    UsrlReaderEntry *e = s->reader;
+    uint64_t now = usrl_timestamp_ns();
+    uint64_t lag = (w_head > s->last_seq) ? w_head - s->last_seq : 0;
+    if (lag > s->max_lag) s->max_lag = lag;
+
+    atomic_store_explicit(&e->reads, s->read_count, memory_order_relaxed);
+    atomic_store_explicit(&e->skips, s->skipped_count, memory_order_relaxed);
+    atomic_store_explicit(&e->max_lag, s->max_lag, memory_order_relaxed);
+    if (s->stats_pending) atomic_store_explicit(&e->last_read_ns, now, memory_order_relaxed);
+
+    uint64_t dt = now - s->rate_ns;
+    if (dt >= USRL_SUB_RATE_NS) {
+        if (s->rate_ns) {
+            atomic_store_explicit(&e->read_rate_hz,
+                                  (s->read_count - s->rate_reads) * 1000000000ULL / dt,
+                                  memory_order_relaxed);
+            atomic_store_explicit(&e->head_rate_hz,
+                                  (w_head - s->rate_head) * 1000000000ULL / dt,
+                                  memory_order_relaxed);
+        }
+        s->rate_ns = now;
+        s->rate_reads = s->read_count;
+        s->rate_head = w_head;
+    }
+
+    s->stats_pending = 0;
+    s->idle_polls = 0;
+}
+
+/*
+ * Find message last_seq + 1: its committed slot, or NULL if there is none to
+ * read yet. Lag jumps and overwritten slots are accounted for here.
+ */
+static inline SlotHeader *sub_locate(UsrlSubscriber *s, uint64_t *out_seq, uint64_t *out_head) {
+    RingDesc *d = s->desc;
+    if (USRL_UNLIKELY(atomic_load_explicit(&d->epoch, memory_order_relaxed) != s->epoch)) {
+        sub_refresh(s);
+    }
+
+again:;
+
+    /* w_head only bounds the search, the slot seq carries visibility */
+    uint64_t raw_head = atomic_load_explicit(&d->w_head, memory_order_acquire);
+    uint64_t w_head = raw_head & ~USRL_HEAD_RESIZING;
     uint64_t next = s->last_seq + 1;
 
-    if (next > w_head) return USRL_RING_NO_DATA; /* Nothing new */
+    /*
+     * While a resize is switching rings, claims past the copied window land
+     * in the new ring, so anything missing from the old one is not lost
+     * yet: hold the cursor instead of jumping.
+     */
+    bool resizing = (raw_head & USRL_HEAD_RESIZING) != 0;
+
+    if (next > w_head) {
+        /* Caught up: a quiet topic still gets its stats out */
+        if (s->reader && USRL_UNLIKELY(++s->idle_polls >= USRL_SUB_STATS_EVERY))
+            sub_stats_flush(s, w_head);
+        return NULL; /* Nothing new */
+    }
 
     /* Lag Jump */
-    if (w_head - next >= d->slot_count) {
-        uint64_t new_start = w_head - d->slot_count + 1;
+    uint64_t slots = (uint64_t)s->mask + 1;
+    if (w_head - next >= slots) {
+        if (resizing) return NULL;
+        /*
+         * A head from after a resize seen with the old geometry would jump
+         * by the old slot count. The fence pairs with the release that
+         * cleared USRL_HEAD_RESIZING, so a grown ring's epoch shows here.
+         */
+        atomic_thread_fence(memory_order_acquire);
+        if (USRL_UNLIKELY(atomic_load_explicit(&d->epoch, memory_order_relaxed) != s->epoch)) {
+            sub_refresh(s);
+            goto again;
+        }
+        if (w_head - s->last_seq > s->max_lag) s->max_lag = w_head - s->last_seq;
+        uint64_t new_start = w_head - slots + 1;
         s->skipped_count += (new_start - next);
         s->last_seq = new_start - 1;
         next = new_start;
-        w_head = atomic_load_explicit(&d->w_head, memory_order_acquire);
-        if (next > w_head) return USRL_RING_NO_DATA;
+        w_head = atomic_load_explicit(&d->w_head, memory_order_acquire) & ~USRL_HEAD_RESIZING;
+        if (next > w_head) return NULL;
     }
 
     uint32_t idx = (uint32_t)((next - 1) & s->mask);
@@ -91,24 +352,87 @@ int usrl_sub_next(UsrlSubscriber *s, uint8_t *out_buf, uint32_t buf_len, uint16_
 
     uint64_t seq = atomic_load_explicit(&hdr->seq, memory_order_acquire);
 
-    if (seq == 0 || seq < next) return USRL_RING_NO_DATA;
+    if (USRL_UNLIKELY(seq & USRL_SEQ_BUSY)) {
+        uint64_t claim = seq & ~USRL_SEQ_BUSY;
+        if (claim <= next || resizing) return NULL; /* still being written */
+        /* A later lap is overwriting our slot: the message is gone */
+        s->skipped_count += (claim - next);
+        s->last_seq = claim - 1;
+        return NULL;
+    }
+
+    if (seq == 0 || seq < next) return NULL;
 
     if (seq > next) {
+        if (resizing) return NULL;
         s->skipped_count += (seq - next);
         s->last_seq = seq - 1;
-        return USRL_RING_NO_DATA;
+        return NULL;
+    }
+
+    /* Stale bytes from before this ring generation: never committed here */
+    if (USRL_UNLIKELY(hdr->gen != s->gen)) {
+        /* Restored under us: reload the generation before judging the slot */
+        if (atomic_load_explicit(&d->epoch, memory_order_acquire) != s->epoch) return NULL;
+        s->skipped_count++;
+        s->last_seq = next;
+        return NULL;
+    }
+
+    /* Aborted reservation: no message was ever there, not a loss */
+    if (USRL_UNLIKELY(hdr->payload_len == USRL_SLOT_ABORTED)) {
+        s->last_seq = next;
+        goto again;
+    }
+
+    *out_seq = seq;
+    *out_head = w_head;
+    return hdr;
+}
+
+/* Message `seq` was read intact: advance and account for it */
+static inline void sub_delivered(UsrlSubscriber *s, uint64_t next, uint64_t w_head,
+                                 uint16_t pub_id, uint64_t pub_ns, uint32_t payload_len,
+                                 uint64_t trace_ns) {
+    s->last_seq = next;
+    s->read_count++;
+    if (s->lat || USRL_UNLIKELY(trace_ns)) {
+        uint64_t now = usrl_timestamp_ns();
+        if (s->lat) usrl_latency_record(s->lat, (now > pub_ns) ? now - pub_ns : 0);
+        if (trace_ns)
+            usrl_trace_rec(USRL_TRACE_SUB, s->trace_topic, next, pub_id, trace_ns, now,
+                           payload_len);
+    }
+    if (s->reader) {
+        atomic_store_explicit(&s->reader->cursor, next, memory_order_relaxed);
+        if (USRL_UNLIKELY(++s->stats_pending >= USRL_SUB_STATS_EVERY)) sub_stats_flush(s, w_head);
     }
+}
+
+int usrl_sub_next(UsrlSubscriber *s, uint8_t *out_buf, uint32_t buf_len, uint16_t *out_pub_id) {
+    if (USRL_UNLIKELY(!s || !s->desc || !out_buf)) return USRL_RING_ERROR;
+
+    uint64_t seq, w_head;
+    SlotHeader *hdr = sub_locate(s, &seq, &w_head);
+    if (!hdr) return USRL_RING_NO_DATA;
+    /* Empty polls are not traced: the span starts at the slot found */
+    uint64_t trace_ns = usrl_tracing() ? usrl_timestamp_ns() : 0;
+    uint64_t next = seq;
 
     uint32_t payload_len = hdr->payload_len;
     if (USRL_UNLIKELY(payload_len > buf_len)) {
         s->last_seq = next;
+        if (s->reader) atomic_store_explicit(&s->reader->cursor, next, memory_order_relaxed);
         return USRL_RING_TRUNC; /* Buffer too small */
     }
 
-    memcpy(out_buf, slot + sizeof(SlotHeader), payload_len);
-    if (out_pub_id) *out_pub_id = hdr->pub_id;
+    memcpy(out_buf, hdr + 1, payload_len);
+    uint16_t pub_id = hdr->pub_id;
+    uint64_t pub_ns = hdr->timestamp_ns;
+    uint32_t schema_id = hdr->schema_id;
+    uint16_t schema_ver = hdr->schema_ver;
 
-    atomic_thread_fence(memory_order_acquire);
+    USRL_SMP_RMB();
     uint64_t post_seq = atomic_load_explicit(&hdr->seq, memory_order_relaxed);
 
     if (USRL_UNLIKELY(post_seq != seq)) {
@@ -117,12 +441,135 @@ int usrl_sub_next(UsrlSubscriber *s, uint8_t *out_buf, uint32_t buf_len, uint16_
         return USRL_RING_NO_DATA;
     }
 
-    s->last_seq = next;
+    if (out_pub_id) *out_pub_id = pub_id;
+    s->schema_id = schema_id;
+    s->schema_ver = schema_ver;
+    sub_delivered(s, next, w_head, pub_id, pub_ns, payload_len, trace_ns);
     return (int)payload_len; /* Safe to return 0 for empty payload */
 }
 
+/*
+ * Zero-copy read: the payload is used where it lies in the slot. The writer
+ * may lap the reader meanwhile, so nothing read is trusted until
+ * usrl_sub_peek_done() confirms the slot still holds the same message.
+ */
+static inline int sub_peek(UsrlSubscriber *s, const uint8_t **payload, uint16_t *out_pub_id) {
+    uint64_t seq, w_head;
+    SlotHeader *hdr = sub_locate(s, &seq, &w_head);
+    if (!hdr) return USRL_RING_NO_DATA;
+    uint64_t trace_ns = usrl_tracing() ? usrl_timestamp_ns() : 0;
+
+    uint32_t payload_len = hdr->payload_len;
+    if (USRL_UNLIKELY(payload_len > s->desc->slot_size - sizeof(SlotHeader))) {
+        s->skipped_count++; /* torn header */
+        s->last_seq = w_head;
+        return USRL_RING_NO_DATA;
+    }
+
+    s->peek = hdr;
+    s->peek_seq = seq;
+    s->peek_head = w_head;
+    s->peek_trace_ns = trace_ns;
+    s->schema_id = hdr->schema_id;
+    s->schema_ver = hdr->schema_ver;
+    if (out_pub_id) *out_pub_id = hdr->pub_id;
+    *payload = (const uint8_t *)(hdr + 1);
+    return (int)payload_len;
+}
+
+static inline int sub_peek_done(UsrlSubscriber *s) {
+    SlotHeader *hdr = s->peek;
+    s->peek = NULL;
+
+    uint16_t pub_id = hdr->pub_id;
+    uint64_t pub_ns = hdr->timestamp_ns;
+    uint32_t payload_len = hdr->payload_len;
+
+    USRL_SMP_RMB();
+    if (USRL_UNLIKELY(atomic_load_explicit(&hdr->seq, memory_order_relaxed) != s->peek_seq)) {
+        s->skipped_count++;
+        s->last_seq = s->peek_head;
+        return USRL_RING_TORN;
+    }
+    sub_delivered(s, s->peek_seq, s->peek_head, pub_id, pub_ns, payload_len, s->peek_trace_ns);
+    return USRL_RING_OK;
+}
+
+int usrl_sub_peek(UsrlSubscriber *s, const uint8_t **payload, uint16_t *out_pub_id) {
+    if (USRL_UNLIKELY(!s || !s->desc || !payload)) return USRL_RING_ERROR;
+    return sub_peek(s, payload, out_pub_id);
+}
+
+int usrl_sub_peek_done(UsrlSubscriber *s) {
+    if (USRL_UNLIKELY(!s || !s->peek)) return USRL_RING_ERROR;
+    return sub_peek_done(s);
+}
+
+/*
+ * Columnar drain: each row is peeked in place and its fields are stored
+ * straight into their columns, so a message is copied once. What a row left
+ * in the columns counts only once the peek is confirmed (as with
+ * usrl_sub_peek_done); a torn row does not advance the row index, so the
+ * next row lands on top of it.
+ *
+ * The first row the schema does not describe (short, or another version) is
+ * left unread and ends the batch.
+ */
+typedef struct {
+    uint8_t *dst;    /* the column */
+    uint32_t offset; /* of the field in the payload */
+    uint32_t width;
+} UsrlDrainCol;
+
+static inline void drain_row(const UsrlDrainCol *dc, uint32_t ncols, uint32_t row,
+                             const uint8_t *payload) {
+    for (uint32_t c = 0; c < ncols; c++) {
+        uint32_t w = dc[c].width;
+        uint8_t *dst = dc[c].dst + (size_t)row * w;
+        const uint8_t *src = payload + dc[c].offset;
+
+        /* Constant widths compile to a single load and store */
+        switch (w) {
+            case 8: memcpy(dst, src, 8); break;
+            case 4: memcpy(dst, src, 4); break;
+            default: memcpy(dst, src, w); break;
+        }
+    }
+}
+
+int usrl_sub_drain_columnar(UsrlSubscriber *s, const UsrlSchema *schema, void *const cols[],
+                            uint32_t max) {
+    if (!s || !s->desc || !schema || !cols || schema->total_size == 0) return USRL_RING_ERROR;
+
+    /* Resolve the wanted columns once, not per row */
+    UsrlDrainCol dc[USRL_MAX_FIELDS];
+    uint32_t ncols = 0;
+    for (uint32_t f = 0; f < schema->field_count && f < USRL_MAX_FIELDS; f++) {
+        if (!cols[f]) continue;
+        const UsrlField *fd = &schema->fields[f];
+        /* Variable fields have no fixed column width; read those rows with views */
+        if (USRL_FIELD_IS_VAR(fd->type)) return USRL_RING_ERROR;
+        dc[ncols++] = (UsrlDrainCol){(uint8_t *)cols[f], fd->offset, usrl_field_width(fd)};
+    }
+
+    uint32_t done = 0;
+    while (done < max) {
+        const uint8_t *payload;
+        int n = sub_peek(s, &payload, NULL);
+        if (n < 0) break;
+        if ((uint32_t)n < schema->total_size ||
+            (s->schema_ver && (s->schema_id != schema->schema_id ||
+                               s->schema_ver != schema->version))) {
+            s->peek = NULL; /* leave it for the caller's schema reader */
+            break;
+        }
+        drain_row(dc, ncols, done, payload);
+        if (sub_peek_done(s) == USRL_RING_OK) done++; /* else overwritten: reuse the row */
+    }
+    return (int)done;
+}
+
 uint64_t usrl_swmr_total_published(void *ring_desc) {
     if (!ring_desc) return 0;
-    RingDesc *d = (RingDesc *)ring_desc;
-    return atomic_load_explicit(&d->w_head, memory_order_acquire);
+    return usrl_ring_head((RingDesc *)ring_desc);
 }
@@ -16,9 +16,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
-/* For shm size discovery (publisher/subscriber) */
+/* For SHM object identity and size (mapping cache) */
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -30,8 +31,6 @@
 
 uint64_t usrl_swmr_total_published(void *ring_desc);
 
-static uint32_t g_pub_id_seq = 1;
-
 /* ============================================================================
  * DEFAULT SHM SIZING (SETTER)
  * ============================================================================ */
@@ -50,54 +49,143 @@ static size_t usrl__choose_shm_size(size_t ring_size)
     return (ring_size > min_default) ? ring_size : min_default;
 }
 
-/* usrl_backoff_exponential returns ns; usleep expects us */
-static inline useconds_t usrl__ns_to_us_ceil(uint64_t ns)
+/* ============================================================================
+ * MAPPING CACHE
+ *
+ * One mapping per SHM object per process, shared by every handle on it and
+ * refcounted. Only the first handle on an object pays for shm_open/fstat/
+ * mmap; the last one to go unmaps it.
+ * ============================================================================ */
+
+typedef struct usrl_map {
+    struct usrl_map *next;
+    dev_t dev;          /* identity of the SHM object: a path that was */
+    ino_t ino;          /* unlinked and re-created is a different object */
+    void *base;
+    size_t size;
+    uint32_t refs;
+} usrl_map_t;
+
+static pthread_mutex_t g_map_lock = PTHREAD_MUTEX_INITIALIZER;
+static usrl_map_t *g_maps;
+
+/* Open the object currently behind `path`; returns the fd or -1 */
+static int usrl__map_open(const char *path, struct stat *st)
 {
-    if (ns == 0) return 0;
-    uint64_t us = (ns + 999ull) / 1000ull;
-    if (us == 0) us = 1;
-    if (us > 10000000ull) us = 10000000ull;
-    return (useconds_t)us;
+    int fd = shm_open(path, O_RDWR, 0666);
+    if (fd < 0) return -1;
+    if (fstat(fd, st) != 0 || st->st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
 }
 
-/* ============================================================================
- * SHM size helper (shared)
- * ============================================================================ */
+static usrl_map_t *usrl__map_find(const struct stat *st)
+{
+    for (usrl_map_t *m = g_maps; m; m = m->next) {
+        if (m->dev == st->st_dev && m->ino == st->st_ino) return m;
+    }
+    return NULL;
+}
 
-static size_t usrl__shm_object_size_bytes(const char *shm_path)
+/* Take a reference on an existing mapping of `path`; NULL if not mapped */
+static void *usrl__map_cached(const char *path)
 {
-    int fd = shm_open(shm_path, O_RDONLY, 0);
-    if (fd < 0) return 0;
+    struct stat st;
+    int fd = usrl__map_open(path, &st);
+    if (fd < 0) return NULL;
+    close(fd);
 
+    pthread_mutex_lock(&g_map_lock);
+    usrl_map_t *m = usrl__map_find(&st);
+    if (m) m->refs++;
+    pthread_mutex_unlock(&g_map_lock);
+    return m ? m->base : NULL;
+}
+
+/* Take a reference on `path`, mapping the whole object on first use */
+static void *usrl__map_acquire(const char *path)
+{
     struct stat st;
-    if (fstat(fd, &st) != 0) {
+    int fd = usrl__map_open(path, &st);
+    if (fd < 0) return NULL;
+
+    pthread_mutex_lock(&g_map_lock);
+    usrl_map_t *m = usrl__map_find(&st);
+    if (m) {
+        m->refs++;
+        pthread_mutex_unlock(&g_map_lock);
         close(fd);
-        return 0;
+        return m->base;
     }
+
+    /* Map the object we just identified, at its actual size (munmap matches) */
+    size_t size = (size_t)st.st_size;
+    void *base = MAP_FAILED;
+    m = calloc(1, sizeof(*m));
+    if (m) base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     close(fd);
 
-    if (st.st_size <= 0) return 0;
-    return (size_t)st.st_size;
+    if (base == MAP_FAILED) {
+        free(m);
+        pthread_mutex_unlock(&g_map_lock);
+        return NULL;
+    }
+
+    m->dev = st.st_dev;
+    m->ino = st.st_ino;
+    m->base = base;
+    m->size = size;
+    m->refs = 1;
+    m->next = g_maps;
+    g_maps = m;
+    pthread_mutex_unlock(&g_map_lock);
+    return base;
+}
+
+static void usrl__map_release(void *base)
+{
+    pthread_mutex_lock(&g_map_lock);
+    for (usrl_map_t **pp = &g_maps; *pp; pp = &(*pp)->next) {
+        usrl_map_t *m = *pp;
+        if (m->base != base) continue;
+        if (--m->refs == 0) {
+            *pp = m->next;
+            munmap(m->base, m->size);
+            free(m);
+        }
+        break;
+    }
+    pthread_mutex_unlock(&g_map_lock);
 }
 
 /* ============================================================================
  * INTERNAL STRUCTURES
  * ============================================================================ */
 
-struct usrl_ctx { char name[64]; };
+struct usrl_ctx {
+    char name[64];
+    void *region;       /* shared topic region (cached mapping), or NULL */
+    char region_path[128];
+};
 
 struct usrl_pub {
     usrl_ctx_t *ctx;
     UsrlPublisher core;
     UsrlMwmrPublisher core_mw;
     PublishQuota quota;
+    UsrlLagPolicy lag_policy;
     bool block_on_full;
     bool use_limiter;
     bool is_mwmr;
     char topic[64];
     void *shm_base;
-    size_t map_size;
+    bool own_map;       /* holds a mapping cache reference on shm_base */
     uint64_t local_drops;
+    UsrlWriterEntry *writer; /* this publisher's counters in the region */
+    uint64_t health_ns;      /* previous usrl_pub_get_health call */
+    uint64_t health_published;
 };
 
 struct usrl_sub {
@@ -105,12 +193,68 @@ struct usrl_sub {
     UsrlSubscriber core;
     char topic[64];
     void *shm_base;
-    size_t map_size;
+    bool own_map;       /* holds a mapping cache reference on shm_base */
+    UsrlSchema *schema; /* attached from the topic, NULL if it has none */
     uint64_t local_ops;
     uint64_t local_skips;
     uint64_t local_errors;
 };
 
+/* ============================================================================
+ * SHARED REGION
+ * ============================================================================ */
+
+#define USRL_REGION_DEFAULT_MB     256u
+#define USRL_REGION_DEFAULT_TOPICS 256u
+
+static int usrl__region_open(usrl_ctx_t *ctx, const usrl_sys_config_t *config)
+{
+    uint32_t mb  = config->shm_region_size_mb ? config->shm_region_size_mb : USRL_REGION_DEFAULT_MB;
+    uint32_t cap = config->max_topics ? config->max_topics : USRL_REGION_DEFAULT_TOPICS;
+
+    strncpy(ctx->region_path, config->shm_region, sizeof(ctx->region_path) - 1);
+
+    int irc = usrl_core_init_ex(ctx->region_path, (uint64_t)mb * 1024u * 1024u, NULL, 0, cap);
+    if (irc < 0) {
+        USRL_ERROR("API", "Region init failed path=%s rc=%d errno=%d",
+                   ctx->region_path, irc, errno);
+        return -1;
+    }
+
+    void *base = usrl__map_acquire(ctx->region_path);
+    if (!base) {
+        USRL_ERROR("API", "Region mmap failed path=%s errno=%d", ctx->region_path, errno);
+        return -1;
+    }
+
+    /* Another process may still be laying out a region it just created */
+    CoreHeader *hdr = (CoreHeader *)base;
+    for (int i = 0; i < 1000 && hdr->magic != USRL_MAGIC; i++) usleep(1000);
+    if (hdr->magic != USRL_MAGIC || hdr->version != USRL_LAYOUT_VERSION) {
+        USRL_ERROR("API", "Region %s is not a v%u USRL region", ctx->region_path,
+                   (unsigned)USRL_LAYOUT_VERSION);
+        usrl__map_release(base);
+        return -1;
+    }
+
+    ctx->region = base;
+    USRL_INFO("API", "Attached region %s (%llu MB, %u topics max)", ctx->region_path,
+              (unsigned long long)(hdr->mmap_size >> 20), hdr->topic_capacity);
+    return 0;
+}
+
+/* Returns 0 if the topic now exists in the context's region */
+static int usrl__region_add(usrl_ctx_t *ctx, const UsrlTopicConfig *tcfg)
+{
+    int rc = usrl_core_add_topic(ctx->region, tcfg);
+    if (rc == 0) USRL_DEBUG("API", "Added topic=%s to %s", tcfg->name, ctx->region_path);
+    if (rc == -4) {
+        USRL_WARN("API", "Region %s full; topic=%s gets its own SHM object",
+                  ctx->region_path, tcfg->name);
+    }
+    return (rc >= 0) ? 0 : -1;
+}
+
 /* ============================================================================
  * LIFECYCLE
  * ============================================================================ */
@@ -118,7 +262,11 @@ struct usrl_sub {
 usrl_ctx_t *usrl_init(const usrl_sys_config_t *config)
 {
     if (!config) return NULL;
-    usrl_logging_init(config->log_file_path, config->log_level);
+    if (config->log_buffer_kb)
+        usrl_logging_init_async(config->log_file_path, config->log_level,
+                                config->log_buffer_kb * 1024u);
+    else
+        usrl_logging_init(config->log_file_path, config->log_level);
 
     usrl_ctx_t *ctx = calloc(1, sizeof(usrl_ctx_t));
     if (!ctx) return NULL;
@@ -127,6 +275,13 @@ usrl_ctx_t *usrl_init(const usrl_sys_config_t *config)
     else strcpy(ctx->name, "usrl_app");
     ctx->name[63] = '\0';
 
+    if (config->shm_region && config->shm_region[0]) {
+        if (usrl__region_open(ctx, config) != 0) {
+            free(ctx);
+            return NULL;
+        }
+    }
+
     USRL_INFO("API", "USRL System Initialized: %s", ctx->name);
     return ctx;
 }
@@ -135,6 +290,7 @@ void usrl_shutdown(usrl_ctx_t *ctx)
 {
     if (!ctx) return;
     USRL_INFO("API", "USRL System Shutdown: %s", ctx->name);
+    if (ctx->region) usrl__map_release(ctx->region);
     usrl_logging_shutdown();
     free(ctx);
 }
@@ -143,6 +299,41 @@ void usrl_shutdown(usrl_ctx_t *ctx)
  * PUBLISHER
  * ============================================================================ */
 
+/*
+ * Checked once per publisher: a schema registered in this process is bound
+ * to the topic (as a new version, or equal to the one bound); an
+ * unregistered name must be the name of the topic's schema, and its newest
+ * version is stamped. stamp receives the id and version to stamp.
+ */
+static int usrl__pub_schema(void *base, const usrl_pub_config_t *config, UsrlSchema *stamp)
+{
+    UsrlSchema *local = usrl_schema_find(config->schema_name);
+    if (local) {
+        int rc = usrl_schema_bind(base, config->topic, local);
+        if (rc == -2)
+            USRL_ERROR("API", "Schema mismatch topic=%s: '%s' v%u fp=%08x conflicts with a bound version",
+                       config->topic, local->name, local->version, local->fingerprint);
+        else if (rc != 0)
+            USRL_ERROR("API", "Cannot bind schema '%s' to topic=%s rc=%d", local->name,
+                       config->topic, rc);
+        stamp->schema_id = local->schema_id;
+        stamp->version = local->version;
+        return rc;
+    }
+
+    UsrlSchema *bound = usrl_schema_attach(base, config->topic);
+    int rc = (bound && strcmp(bound->name, config->schema_name) == 0) ? 0 : -1;
+    if (rc != 0)
+        USRL_ERROR("API", "Schema '%s' is not registered and topic=%s is bound to '%s'",
+                   config->schema_name, config->topic, bound ? bound->name : "(none)");
+    else {
+        stamp->schema_id = bound->schema_id;
+        stamp->version = bound->version;
+    }
+    usrl_schema_free(bound);
+    return rc;
+}
+
 usrl_pub_t *usrl_pub_create(usrl_ctx_t *ctx, const usrl_pub_config_t *config)
 {
     if (!ctx || !config || !config->topic) return NULL;
@@ -150,12 +341,6 @@ usrl_pub_t *usrl_pub_create(usrl_ctx_t *ctx, const usrl_pub_config_t *config)
     uint32_t sc = (config->slot_count > 0) ? config->slot_count : 4096;
     uint32_t ss = (config->slot_size  > 0) ? config->slot_size  : 1024;
 
-    size_t ring_size = (size_t)sc * (size_t)ss + (1024u * 1024u);
-    size_t requested_shm_size = usrl__choose_shm_size(ring_size);
-
-    char shm_path[128];
-    snprintf(shm_path, sizeof(shm_path), "/usrl-%s", config->topic);
-
     UsrlTopicConfig tcfg;
     memset(&tcfg, 0, sizeof(tcfg));
     strncpy(tcfg.name, config->topic, 63);
@@ -164,6 +349,26 @@ usrl_pub_t *usrl_pub_create(usrl_ctx_t *ctx, const usrl_pub_config_t *config)
     tcfg.slot_size  = ss;
     tcfg.type = (config->ring_type == USRL_RING_MWMR) ? USRL_RING_TYPE_MWMR : USRL_RING_TYPE_SWMR;
 
+    void *base = NULL;
+    bool own_map = false;
+
+    /* Shared region: the ring lives in ctx->region, which outlives the pub */
+    if (ctx->region && usrl__region_add(ctx, &tcfg) == 0) {
+        base = ctx->region;
+        goto attached;
+    }
+
+    char shm_path[128];
+    snprintf(shm_path, sizeof(shm_path), "/usrl-%s", config->topic);
+
+    /* Mapped already in this process: the topic exists, skip init entirely */
+    own_map = true;
+    base = usrl__map_cached(shm_path);
+    if (base) goto attached;
+
+    size_t ring_size = (size_t)sc * (size_t)ss + (1024u * 1024u);
+    size_t requested_shm_size = usrl__choose_shm_size(ring_size);
+
     int irc = usrl_core_init(shm_path, requested_shm_size, &tcfg, 1);
     if (irc < 0) {
         USRL_ERROR("API", "Core init failed topic=%s rc=%d errno=%d", config->topic, irc, errno);
@@ -173,69 +378,103 @@ usrl_pub_t *usrl_pub_create(usrl_ctx_t *ctx, const usrl_pub_config_t *config)
         USRL_DEBUG("API", "Core exists topic=%s; attaching", config->topic);
     }
 
-    /* Map using actual SHM object size (avoid mismatched munmap sizes later). */
-    size_t obj_size = usrl__shm_object_size_bytes(shm_path);
-    if (obj_size == 0) {
-        USRL_ERROR("API", "Publisher cannot open/fstat topic=%s path=%s errno=%d",
+    base = usrl__map_acquire(shm_path);
+    if (!base) {
+        USRL_ERROR("API", "Publisher cannot map topic=%s path=%s errno=%d",
                    config->topic, shm_path, errno);
         return NULL;
     }
 
-    void *base = usrl_core_map(shm_path, obj_size);
-    if (!base) {
-        USRL_ERROR("API", "Publisher mmap failed topic=%s size=%zu errno=%d",
-                   config->topic, obj_size, errno);
+attached:;
+    UsrlSchema stamp;
+    memset(&stamp, 0, sizeof(stamp));
+    if (config->schema_name && usrl__pub_schema(base, config, &stamp) != 0) {
+        if (own_map) usrl__map_release(base);
         return NULL;
     }
 
     usrl_pub_t *pub = calloc(1, sizeof(usrl_pub_t));
     if (!pub) {
-        munmap(base, obj_size);
+        if (own_map) usrl__map_release(base);
         return NULL;
     }
 
     pub->ctx = ctx;
     pub->shm_base = base;
-    pub->map_size = obj_size;
+    pub->own_map = own_map;
     pub->block_on_full = config->block_on_full;
     pub->is_mwmr = (config->ring_type == USRL_RING_MWMR);
     strncpy(pub->topic, config->topic, 63);
     pub->topic[63] = '\0';
 
     if (config->rate_limit_hz > 0) {
-        usrl_quota_init(&pub->quota, (uint64_t)config->rate_limit_hz);
+        usrl_quota_init_burst(&pub->quota, (uint64_t)config->rate_limit_hz, config->rate_burst);
         pub->use_limiter = true;
     }
 
-    uint32_t my_id = __sync_fetch_and_add(&g_pub_id_seq, 1);
+    /* Region-wide id, so SlotHeader.pub_id tells writers of other processes apart */
+    uint16_t my_id = usrl_core_pub_id(base);
 
     if (pub->is_mwmr) usrl_mwmr_pub_init(&pub->core_mw, base, config->topic, my_id);
     else             usrl_pub_init(&pub->core,    base, config->topic, my_id);
+    if (config->schema_name) {
+        if (pub->is_mwmr) usrl_mwmr_pub_set_schema(&pub->core_mw, &stamp);
+        else             usrl_pub_set_schema(&pub->core, &stamp);
+    }
+    pub->writer = pub->is_mwmr ? pub->core_mw.writer : pub->core.writer;
+
+    /* A fair topic cannot hold a writer it has no table entry for to its share */
+    TopicEntry *te = usrl_get_topic(base, config->topic);
+    if (!pub->writer && te && (te->flags & USRL_TOPIC_FAIR)) {
+        USRL_ERROR("API", "Writer table full topic=%s: cannot enforce its fair share",
+                   config->topic);
+        if (own_map) usrl__map_release(base);
+        free(pub);
+        return NULL;
+    }
+
+    usrl_lag_policy_init(&pub->lag_policy, base, config->topic);
 
     return pub;
 }
 
-int usrl_pub_send(usrl_pub_t *pub, const void *data, uint32_t len)
+static inline void usrl__pub_drop(usrl_pub_t *pub)
 {
-    if (!pub || !data) return -1;
+    pub->local_drops++;
+    if (pub->writer) usrl_writer_count(&pub->writer->dropped);
+}
 
-    /* usrl_quota_check(): 1 = THROTTLED, 0 = allowed */
+/* Rate limit and lag policy, checked before every message: 0 = go ahead */
+static inline int usrl__pub_admit(usrl_pub_t *pub)
+{
+    /* Rate limit: blocking publishers spin to their exact slot, others drop */
     if (pub->use_limiter) {
-        if (usrl_quota_check(&pub->quota)) {
-            if (pub->block_on_full) {
-                useconds_t us = usrl__ns_to_us_ceil(usrl_backoff_exponential(1));
-                if (us) usleep(us);
-            } else {
-                pub->local_drops++;
-                return -1;
-            }
+        if (pub->block_on_full) {
+            usrl_quota_wait(&pub->quota, 1);
+        } else if (usrl_quota_check(&pub->quota)) {
+            usrl__pub_drop(pub);
+            return -1;
         }
     }
 
+    /* Topic lag policy (region-wide, set with usrl_bp_set_policy): 1 = drop */
+    if (usrl_lag_policy_admit(&pub->lag_policy)) {
+        usrl__pub_drop(pub);
+        return -1;
+    }
+    return 0;
+}
+
+int usrl_pub_send(usrl_pub_t *pub, const void *data, uint32_t len)
+{
+    if (!pub || !data) return -1;
+    if (usrl__pub_admit(pub) != 0) return -1;
+
     int res;
     if (pub->is_mwmr) {
         res = usrl_mwmr_pub_publish(&pub->core_mw, data, len);
-        while ((res == USRL_RING_FULL || res == USRL_RING_TIMEOUT) && pub->block_on_full) {
+        while ((res == USRL_RING_FULL || res == USRL_RING_TIMEOUT || res == USRL_RING_QUOTA) &&
+               pub->block_on_full) {
             usleep(1);
             res = usrl_mwmr_pub_publish(&pub->core_mw, data, len);
         }
@@ -249,32 +488,99 @@ int usrl_pub_send(usrl_pub_t *pub, const void *data, uint32_t len)
 
     if (res == USRL_RING_OK) return 0;
 
-    if (res == USRL_RING_FULL) pub->local_drops++;
+    if (res == USRL_RING_FULL || res == USRL_RING_QUOTA) usrl__pub_drop(pub);
     return -1;
 }
 
+void *usrl_pub_send_begin(usrl_pub_t *pub, uint32_t len)
+{
+    if (!pub) return NULL;
+    if (usrl__pub_admit(pub) != 0) return NULL;
+
+    if (!pub->is_mwmr) {
+        uint8_t *buf = usrl_pub_reserve(&pub->core, len);
+        if (!buf) usrl__pub_drop(pub);
+        return buf;
+    }
+
+    int res = USRL_RING_ERROR;
+    uint8_t *buf = usrl_mwmr_pub_reserve(&pub->core_mw, len, &res);
+    while (!buf && (res == USRL_RING_TIMEOUT || res == USRL_RING_QUOTA) && pub->block_on_full) {
+        usleep(1);
+        buf = usrl_mwmr_pub_reserve(&pub->core_mw, len, &res);
+    }
+    if (!buf && (res == USRL_RING_FULL || res == USRL_RING_QUOTA)) usrl__pub_drop(pub);
+    return buf;
+}
+
+int usrl_pub_send_commit(usrl_pub_t *pub, uint32_t len)
+{
+    if (!pub) return -1;
+    int res = pub->is_mwmr ? usrl_mwmr_pub_commit(&pub->core_mw, len)
+                           : usrl_pub_commit(&pub->core, len);
+    return res == USRL_RING_OK ? 0 : -1;
+}
+
+int usrl_pub_send_abort(usrl_pub_t *pub)
+{
+    if (!pub) return -1;
+    int res = pub->is_mwmr ? usrl_mwmr_pub_abort(&pub->core_mw) : usrl_pub_abort(&pub->core);
+    if (res != USRL_RING_OK) return -1;
+    pub->local_drops++; /* the core counted it in the writer entry */
+    return 0;
+}
+
 void usrl_pub_get_health(usrl_pub_t *pub, usrl_health_t *out)
 {
     if (!pub || !out) return;
 
-    RingHealth *rh = usrl_health_get(pub->shm_base, pub->topic);
-    if (rh) {
-        out->operations = rh->pub_health.total_published;
-        out->rate_hz    = rh->pub_health.publish_rate_hz;
+    /* This publisher's own counters; the rate covers the time since the last call */
+    if (pub->writer) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        uint64_t published = atomic_load_explicit(&pub->writer->published, memory_order_relaxed);
+
+        out->operations = published;
+        out->rate_hz = (pub->health_ns && now > pub->health_ns)
+            ? (published - pub->health_published) * 1000000000ULL / (now - pub->health_ns) : 0;
+        out->errors = atomic_load_explicit(&pub->writer->dropped, memory_order_relaxed) +
+                      atomic_load_explicit(&pub->writer->timeouts, memory_order_relaxed);
+        out->lag = 0;
+        out->healthy = (out->errors == 0);
+
+        pub->health_ns = now;
+        pub->health_published = published;
+        return;
+    }
+
+    RingHealth rh;
+    if (usrl_health_fill(pub->shm_base, pub->topic, &rh) == 0) {
+        out->operations = rh.pub_health.total_published;
+        out->rate_hz    = rh.pub_health.publish_rate_hz;
         out->errors     = pub->local_drops;
         out->lag        = 0;
         out->healthy    = (out->errors == 0);
-        usrl_health_free(rh);
     } else {
         memset(out, 0, sizeof(*out));
         out->errors = pub->local_drops;
     }
 }
 
+int usrl_pub_heartbeat(usrl_pub_t *pub, uint32_t period_ms)
+{
+    if (!pub || !pub->writer) return -1;
+    usrl_heartbeat(&pub->writer->hb, period_ms);
+    return 0;
+}
+
 void usrl_pub_destroy(usrl_pub_t *pub)
 {
     if (!pub) return;
-    if (pub->shm_base && pub->map_size > 0) munmap(pub->shm_base, pub->map_size);
+    /* A detached entry is not reported dead by the watchdog */
+    if (pub->writer) usrl_writer_detach(pub->shm_base, usrl_get_topic(pub->shm_base, pub->topic),
+                                        pub->writer);
+    if (pub->own_map) usrl__map_release(pub->shm_base);
     free(pub);
 }
 
@@ -286,36 +592,78 @@ usrl_sub_t *usrl_sub_create(usrl_ctx_t *ctx, const char *topic)
 {
     if (!ctx || !topic) return NULL;
 
+    void *base = NULL;
+    bool own_map = false;
+
+    /* Topics the region does not hold (yet) fall back to their own object */
+    if (ctx->region && usrl_get_topic(ctx->region, topic)) {
+        base = ctx->region;
+        goto attached;
+    }
+
     char shm_path[128];
     snprintf(shm_path, sizeof(shm_path), "/usrl-%s", topic);
 
-    size_t map_size = usrl__shm_object_size_bytes(shm_path);
-    if (map_size == 0) {
-        USRL_ERROR("API", "Subscriber cannot open/fstat topic='%s' (path=%s) errno=%d",
+    base = usrl__map_acquire(shm_path);
+    if (!base) {
+        USRL_ERROR("API", "Subscriber cannot map topic='%s' (path=%s) errno=%d",
                    topic, shm_path, errno);
         return NULL;
     }
-
-    void *base = usrl_core_map(shm_path, map_size);
-    if (!base) {
-        USRL_ERROR("API", "Subscriber mmap failed topic='%s' size=%zu errno=%d",
-                   topic, map_size, errno);
-        return NULL;
+    own_map = true;
+
+attached:;
+    /*
+     * Validate the layout once here, so receiving never has to. A schema
+     * registered locally may be another version of the bound one, as long
+     * as the two are compatible; it is bound if no writer has yet, and the
+     * subscriber then sees its own version.
+     */
+    UsrlSchema *schema = usrl_schema_attach(base, topic);
+    if (schema) {
+        const UsrlSchema *local = usrl_schema_find(schema->name);
+        if (local && usrl_schema_check(base, topic, local) != 0) {
+            USRL_ERROR("API", "Schema mismatch topic='%s': bound '%s' v%u fp=%08x, local v%u fp=%08x",
+                       topic, schema->name, schema->version, schema->fingerprint, local->version,
+                       local->fingerprint);
+            usrl_schema_free(schema);
+            if (own_map) usrl__map_release(base);
+            return NULL;
+        }
+        if (local && local->version != schema->version) {
+            int rc = usrl_schema_bind(base, topic, local);
+            UsrlSchema *own = (rc == 0) ? usrl_schema_attach_version(base, topic, local->version)
+                                        : NULL;
+            usrl_schema_free(schema);
+            if (!own) {
+                USRL_ERROR("API", "Cannot bind schema '%s' v%u to topic='%s' rc=%d", local->name,
+                           local->version, topic, rc);
+                if (own_map) usrl__map_release(base);
+                return NULL;
+            }
+            schema = own;
+        }
     }
 
     usrl_sub_t *sub = calloc(1, sizeof(usrl_sub_t));
     if (!sub) {
-        munmap(base, map_size);
+        usrl_schema_free(schema);
+        if (own_map) usrl__map_release(base);
         return NULL;
     }
 
     sub->ctx = ctx;
     sub->shm_base = base;
-    sub->map_size = map_size;
+    sub->own_map = own_map;
+    sub->schema = schema;
     strncpy(sub->topic, topic, 63);
     sub->topic[63] = '\0';
 
     usrl_sub_init(&sub->core, base, topic);
+    if (sub->core.desc && usrl_sub_register(&sub->core) != 0) {
+        USRL_WARN("API", "Reader table full topic='%s'; lag policy will not see this subscriber",
+                  topic);
+    }
     return sub;
 }
 
@@ -341,13 +689,53 @@ int usrl_sub_recv(usrl_sub_t *sub, void *buffer, uint32_t max_len)
     return ret;
 }
 
+int usrl_sub_recv_peek(usrl_sub_t *sub, const uint8_t **payload)
+{
+    if (!sub || !payload) return -1;
+
+    int ret = usrl_sub_peek(&sub->core, payload, NULL);
+    if (ret == USRL_RING_NO_DATA) return -11;
+    if (ret < 0) {
+        sub->local_errors++;
+        return -1;
+    }
+    return ret;
+}
+
+int usrl_sub_recv_done(usrl_sub_t *sub)
+{
+    if (!sub) return -1;
+
+    int ret = usrl_sub_peek_done(&sub->core);
+    if (ret == USRL_RING_OK) {
+        sub->local_ops++;
+        return 0;
+    }
+    if (ret == USRL_RING_TORN) sub->local_skips++;
+    return -1;
+}
+
+int usrl_sub_recv_columnar(usrl_sub_t *sub, void *const cols[], uint32_t max)
+{
+    if (!sub || !sub->schema || !cols) return -1;
+
+    int n = usrl_sub_drain_columnar(&sub->core, sub->schema, cols, max);
+    if (n < 0) {
+        sub->local_errors++;
+        return -1;
+    }
+    sub->local_ops += (uint64_t)n;
+    return n;
+}
+
 void usrl_sub_get_health(usrl_sub_t *sub, usrl_health_t *out)
 {
     if (!sub || !out) return;
 
     out->operations = sub->local_ops;
     out->errors     = sub->local_skips + sub->local_errors + sub->core.skipped_count;
-    out->rate_hz    = 0;
+    out->rate_hz    = sub->core.reader
+        ? atomic_load_explicit(&sub->core.reader->read_rate_hz, memory_order_relaxed) : 0;
 
     if (sub->core.desc) {
         uint64_t w_head = usrl_swmr_total_published(sub->core.desc);
@@ -360,9 +748,55 @@ void usrl_sub_get_health(usrl_sub_t *sub, usrl_health_t *out)
     out->healthy = (out->lag < 100 && out->errors == 0);
 }
 
+int usrl_sub_enable_latency(usrl_sub_t *sub)
+{
+    if (!sub) return -1;
+    int rc = usrl_sub_latency_enable(&sub->core);
+    if (rc != 0) {
+        USRL_WARN("API", "Latency tracking unavailable topic='%s' rc=%d", sub->topic, rc);
+        return -1;
+    }
+    return 0;
+}
+
+int usrl_sub_get_latency_histogram(usrl_sub_t *sub, usrl_latency_t *out)
+{
+    if (!sub || !out || !sub->core.lat) return -1;
+
+    UsrlLatencySummary s;
+    usrl_latency_summary(sub->core.lat, &s);
+    out->count   = s.count;
+    out->mean_ns = s.mean_ns;
+    out->p50_ns  = s.p50_ns;
+    out->p90_ns  = s.p90_ns;
+    out->p99_ns  = s.p99_ns;
+    out->p999_ns = s.p999_ns;
+    out->max_ns  = s.max_ns;
+    return 0;
+}
+
+int usrl_sub_heartbeat(usrl_sub_t *sub, uint32_t period_ms)
+{
+    if (!sub || !sub->core.reader) return -1;
+    usrl_heartbeat(&sub->core.reader->hb, period_ms);
+    return 0;
+}
+
 void usrl_sub_destroy(usrl_sub_t *sub)
 {
     if (!sub) return;
-    if (sub->shm_base && sub->map_size > 0) munmap(sub->shm_base, sub->map_size);
+    usrl_sub_unregister(&sub->core);
+    if (sub->own_map) usrl__map_release(sub->shm_base);
+    usrl_schema_free(sub->schema);
     free(sub);
 }
+
+const UsrlSchema *usrl_sub_schema(usrl_sub_t *sub)
+{
+    return sub ? sub->schema : NULL;
+}
+
+uint32_t usrl_sub_schema_version(usrl_sub_t *sub)
+{
+    return sub ? sub->core.schema_ver : 0;
+}
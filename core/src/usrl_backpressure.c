@@ -1,6 +1,18 @@
 #include "usrl_backpressure.h"
 #include <time.h>
 #include <stdint.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/types.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX() __asm__ volatile("pause" ::: "memory")
+#elif defined(__aarch64__) || defined(__arm__)
+#define CPU_RELAX() __asm__ volatile("yield" ::: "memory")
+#else
+#define CPU_RELAX() do {} while (0)
+#endif
 
 static inline uint64_t usrl_now_ns(void)
 {
@@ -9,29 +21,91 @@ static inline uint64_t usrl_now_ns(void)
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-/* NOTE:
- * Returns 1 when THROTTLED (exceeded), 0 when allowed.
- */
-int usrl_quota_check(PublishQuota *quota)
+void usrl_quota_init_burst(PublishQuota *quota, uint64_t msgs_per_sec, uint32_t burst)
 {
-    if (!quota) return 0;
+    if (!quota) return;
 
-    uint64_t now = usrl_now_ns();
+    usrl_clock_init();
+
+    if (burst == 0) burst = 1;
+    quota->burst = burst;
+    quota->tat = 0;
+    quota->total_throttled = 0;
+
+    if (msgs_per_sec == 0) {
+        quota->emission_ticks = 0;
+        quota->tolerance_ticks = 0;
+        return;
+    }
+
+    uint64_t t = usrl_clock.ticks_per_sec / msgs_per_sec;
+    quota->emission_ticks = t ? t : 1;
+    quota->tolerance_ticks = (uint64_t)(burst - 1) * quota->emission_ticks;
+}
 
-    if (now - quota->last_window_start_ns > quota->publish_window_ns) {
-        quota->last_window_start_ns = now;
-        quota->msgs_in_window = 0;
+/* Earliest tick at which `n` more messages conform */
+static inline uint64_t quota_ready_at(const PublishQuota *quota, uint32_t n)
+{
+    uint64_t need = quota->tat + (uint64_t)(n - 1) * quota->emission_ticks;
+    return (need > quota->tolerance_ticks) ? need - quota->tolerance_ticks : 0;
+}
+
+static inline void quota_commit(PublishQuota *quota, uint64_t now, uint32_t n)
+{
+    uint64_t base = (quota->tat > now) ? quota->tat : now;
+    quota->tat = base + (uint64_t)n * quota->emission_ticks;
+}
+
+int usrl_quota_acquire(PublishQuota *quota, uint32_t n)
+{
+    if (!quota || quota->emission_ticks == 0 || n == 0) return 0;
+
+    if (n > quota->burst) {
+        quota->total_throttled++;
+        return 1;
     }
 
-    if (quota->msgs_in_window >= quota->publish_quota) {
+    uint64_t now = usrl_ticks();
+    if (now < quota_ready_at(quota, n)) {
         quota->total_throttled++;
         return 1;
     }
 
-    quota->msgs_in_window++;
+    quota_commit(quota, now, n);
     return 0;
 }
 
+/* NOTE:
+ * Returns 1 when THROTTLED (exceeded), 0 when allowed.
+ */
+int usrl_quota_check(PublishQuota *quota)
+{
+    return usrl_quota_acquire(quota, 1);
+}
+
+uint64_t usrl_quota_wait(PublishQuota *quota, uint32_t n)
+{
+    if (!quota || quota->emission_ticks == 0 || n == 0) return 0;
+
+    uint64_t start = usrl_ticks();
+    uint64_t now = start;
+
+    /* Larger batches than the bucket holds go through burst-sized chunks */
+    while (n > 0) {
+        uint32_t chunk = (n > quota->burst) ? quota->burst : n;
+        uint64_t ready = quota_ready_at(quota, chunk);
+        while (now < ready) {
+            CPU_RELAX();
+            now = usrl_ticks();
+        }
+        quota_commit(quota, now, chunk);
+        n -= chunk;
+    }
+
+    if (now != start) quota->total_throttled++;
+    return usrl_ticks_to_ns(now - start);
+}
+
 int usrl_backpressure_check_lag(uint64_t lag, uint64_t threshold)
 {
     return (lag > threshold) ? 1 : 0;
@@ -55,3 +129,174 @@ uint64_t usrl_backoff_linear(uint64_t lag, uint64_t max_lag)
     if (lag >= max_lag) return 100000;
     return (lag * 100000) / max_lag;
 }
+
+/* =============================================================================
+ * LAG POLICY ENGINE
+ * ============================================================================= */
+
+void usrl_spin_ns(uint64_t ns)
+{
+    if (ns == 0) return;
+    uint64_t deadline = usrl_ticks() + usrl_ns_to_ticks(ns);
+    while (usrl_ticks() < deadline) CPU_RELAX();
+}
+
+int usrl_bp_set_policy(void *core_base, const char *topic, UsrlBackpressureMode mode,
+                       uint32_t lag_threshold)
+{
+    if (!core_base || !topic || (uint32_t)mode > USRL_BP_THROTTLE) return -1;
+    TopicEntry *t = usrl_get_topic(core_base, topic);
+    if (!t) return -1;
+
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)core_base + t->readers_offset);
+    atomic_store_explicit(&rt->lag_threshold, lag_threshold, memory_order_relaxed);
+    atomic_store_explicit(&rt->bp_mode, (uint32_t)mode, memory_order_release);
+    return 0;
+}
+
+int usrl_bp_set_limits(void *core_base, const char *topic, uint32_t throttle_max_ns,
+                       uint32_t block_max_us)
+{
+    if (!core_base || !topic) return -1;
+    TopicEntry *t = usrl_get_topic(core_base, topic);
+    if (!t) return -1;
+
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)core_base + t->readers_offset);
+    atomic_store_explicit(&rt->throttle_max_ns, throttle_max_ns, memory_order_relaxed);
+    atomic_store_explicit(&rt->block_max_us, block_max_us, memory_order_relaxed);
+    return 0;
+}
+
+int usrl_lag_policy_init(UsrlLagPolicy *lp, void *core_base, const char *topic)
+{
+    if (!lp || !core_base || !topic) return -1;
+    TopicEntry *t = usrl_get_topic(core_base, topic);
+    if (!t) return -1;
+
+    lp->desc = (RingDesc *)((uint8_t *)core_base + t->ring_desc_offset);
+    lp->readers = (UsrlReaderTable *)((uint8_t *)core_base + t->readers_offset);
+    lp->lag = (UsrlLagTracker){0};
+    lp->sample_every = USRL_BP_SAMPLE_EVERY;
+    lp->countdown = 1; /* sample on the first message */
+    lp->probe_ns = 0;
+    lp->total_dropped = 0;
+    lp->total_blocked = 0;
+    lp->total_delay_ns = 0;
+    usrl_clock_init();
+    return 0;
+}
+
+/* A registered reader whose process is gone would stall BLOCK forever */
+static bool reader_dead(UsrlReaderEntry *e)
+{
+    if (e->pid == 0 || kill((pid_t)e->pid, 0) == 0 || errno != ESRCH) return false;
+
+    uint32_t expected = 1;
+    atomic_compare_exchange_strong_explicit(&e->owner, &expected, 0,
+                                            memory_order_acq_rel, memory_order_relaxed);
+    return true;
+}
+
+/* A lagging reader is probed once per interval, not once per sample */
+static bool probe_due(UsrlLagPolicy *lp)
+{
+    uint64_t now = usrl_now_ns();
+    if (now - lp->probe_ns < USRL_BP_PROBE_NS) return false;
+    lp->probe_ns = now;
+    return true;
+}
+
+static void lag_sample(UsrlLagPolicy *lp)
+{
+    RingDesc *d = lp->desc;
+    UsrlReaderTable *rt = lp->readers;
+    uint64_t head = usrl_ring_head(d);
+    uint64_t slots = d->slot_count;
+
+    uint64_t thr = atomic_load_explicit(&rt->lag_threshold, memory_order_relaxed);
+    if (thr == 0 || thr >= slots) thr = slots / 2;
+
+    uint64_t slowest = head;
+    int probe = -1; /* decided at the first reader past the threshold */
+    for (int i = 0; i < USRL_MAX_READERS; i++) {
+        UsrlReaderEntry *e = &rt->entries[i];
+        if (atomic_load_explicit(&e->owner, memory_order_acquire) == 0) continue;
+
+        uint64_t cursor = atomic_load_explicit(&e->cursor, memory_order_relaxed);
+        if (cursor >= slowest) continue;
+        if (head - cursor > thr) {
+            if (probe < 0) probe = probe_due(lp);
+            if (probe && reader_dead(e)) continue;
+        }
+        slowest = cursor;
+    }
+
+    uint64_t lag = head - slowest;
+    if (lag > slots) lag = slots; /* a lapped reader has lost the rest already */
+
+    lp->lag.writer_pos = head;
+    lp->lag.subscriber_pos = slowest;
+    lp->lag.lag_slots = lag;
+    lp->lag.lag_threshold = thr;
+    lp->lag.is_lagging = usrl_backpressure_check_lag(lag, thr);
+}
+
+int usrl_lag_policy_admit(UsrlLagPolicy *lp)
+{
+    if (!lp || !lp->readers) return 0;
+    if (!lp->lag.is_lagging && --lp->countdown != 0) return 0;
+    lp->countdown = lp->sample_every;
+
+    UsrlReaderTable *rt = lp->readers;
+    uint32_t mode = atomic_load_explicit(&rt->bp_mode, memory_order_acquire);
+    if (mode == USRL_BP_NONE) {
+        lp->lag.is_lagging = false;
+        return 0;
+    }
+
+    lag_sample(lp);
+    if (!lp->lag.is_lagging) return 0;
+
+    switch (mode) {
+    case USRL_BP_DROP:
+        lp->total_dropped++;
+        return 1;
+
+    case USRL_BP_THROTTLE: {
+        uint64_t max_ns = atomic_load_explicit(&rt->throttle_max_ns, memory_order_relaxed);
+        if (max_ns == 0) max_ns = USRL_BP_THROTTLE_MAX_NS;
+
+        /* usrl_backoff_linear ramps 0..100000 over [threshold, full ring] */
+        uint64_t span = (uint64_t)lp->desc->slot_count - lp->lag.lag_threshold;
+        uint64_t ramp = usrl_backoff_linear(lp->lag.lag_slots - lp->lag.lag_threshold,
+                                            span ? span : 1);
+        uint64_t delay = ramp * max_ns / 100000ULL;
+        usrl_spin_ns(delay);
+        lp->total_delay_ns += delay;
+        return 0;
+    }
+
+    case USRL_BP_BLOCK: {
+        uint64_t max_us = atomic_load_explicit(&rt->block_max_us, memory_order_relaxed);
+        if (max_us == 0) max_us = USRL_BP_BLOCK_MAX_US;
+
+        uint64_t start = usrl_now_ns();
+        uint64_t deadline = start + max_us * 1000ULL;
+        uint64_t now = start;
+        uint32_t iter = 0;
+
+        lp->total_blocked++;
+        while (lp->lag.is_lagging && now < deadline) {
+            usrl_spin_ns(200);
+            if ((++iter & 63) == 0) sched_yield(); /* let a same-core reader run */
+            lag_sample(lp);
+            now = usrl_now_ns();
+        }
+        lp->total_delay_ns += now - start;
+        return 0;
+    }
+
+    default:
+        return 0;
+    }
+}
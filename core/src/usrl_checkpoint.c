@@ -0,0 +1,351 @@
+/**
+ * @file usrl_checkpoint.c
+ * @brief Region checkpoint / restore.
+ */
+
+#include "usrl_checkpoint.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define USRL_CKPT_CHUNK (4u * 1024u * 1024u) /* staging buffer per write() */
+
+static uint64_t usrl_realtime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * Save
+ * -------------------------------------------------------------------------- */
+
+/* Payload fits the slot, or the slot is an aborted reservation readers skip */
+static int slot_len_ok(uint32_t len, uint32_t slot_size)
+{
+    return len == USRL_SLOT_ABORTED || len <= slot_size - sizeof(SlotHeader);
+}
+
+/*
+ * Copy one slot under its seqlock. Returns the committed seq captured, or 0
+ * if the slot was empty, stale, or rewritten while we copied it (in which
+ * case the staged header is zeroed so restore skips it).
+ */
+static uint64_t stage_slot(const RingDesc *r, const uint8_t *slot, uint8_t *dst)
+{
+    const SlotHeader *src = (const SlotHeader *)slot;
+    SlotHeader *out = (SlotHeader *)dst;
+
+    uint64_t s1 = atomic_load_explicit((atomic_uint_fast64_t *)&src->seq, memory_order_acquire);
+    memcpy(dst, slot, r->slot_size);
+    USRL_SMP_RMB();
+    uint64_t s2 = atomic_load_explicit((atomic_uint_fast64_t *)&src->seq, memory_order_relaxed);
+
+    if (s1 == 0 || s1 != s2 || (s1 & USRL_SEQ_BUSY) || out->gen != r->generation ||
+        !slot_len_ok(out->payload_len, r->slot_size)) {
+        memset(dst, 0, sizeof(SlotHeader));
+        return 0;
+    }
+
+    atomic_store_explicit(&out->seq, s1, memory_order_relaxed);
+    return s1;
+}
+
+int usrl_checkpoint_save(void *base, const char *file_path)
+{
+    if (!base || !file_path) return -1;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC) return -1;
+    atomic_thread_fence(memory_order_acquire);
+
+    size_t stage_size = USRL_CKPT_CHUNK;
+    uint8_t *stage = malloc(stage_size);
+    if (!stage) return -3;
+
+    int fd = open(file_path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) {
+        free(stage);
+        return -2;
+    }
+
+    UsrlCheckpointHeader ch;
+    memset(&ch, 0, sizeof(ch));
+    ch.magic = USRL_CHECKPOINT_MAGIC;
+    ch.version = USRL_CHECKPOINT_VERSION;
+    ch.layout = hdr->version;
+    /* Topics added while we run are left for the next checkpoint */
+    ch.topic_count = atomic_load_explicit(&hdr->topic_count, memory_order_acquire);
+    ch.created_ns = usrl_realtime_ns();
+
+    if (write_all(fd, &ch, sizeof(ch)) != 0) goto fail_io;
+
+    TopicEntry *topics = (TopicEntry *)((uint8_t *)base + hdr->topic_table_offset);
+
+    for (uint32_t i = 0; i < ch.topic_count; i++) {
+        TopicEntry *t = &topics[i];
+        RingDesc *r = (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
+        uint8_t *slots = (uint8_t *)base + r->base_offset;
+
+        /*
+         * The record's w_head is only known after the image is taken, so
+         * write a placeholder now and patch it once the ring is staged.
+         */
+        UsrlCheckpointTopic ct;
+        memset(&ct, 0, sizeof(ct));
+        memcpy(ct.name, t->name, USRL_MAX_TOPIC_NAME);
+        ct.type = t->type;
+        ct.slot_count = r->slot_count;
+        ct.slot_size = r->slot_size;
+        ct.image_bytes = (uint64_t)r->slot_count * r->slot_size;
+
+        /* The stage holds at least one slot, however large */
+        if (r->slot_size > stage_size) {
+            uint8_t *grown = realloc(stage, r->slot_size);
+            if (!grown) {
+                free(stage);
+                close(fd);
+                return -3;
+            }
+            stage = grown;
+            stage_size = r->slot_size;
+        }
+
+        off_t rec_pos = lseek(fd, 0, SEEK_CUR);
+        if (rec_pos < 0 || write_all(fd, &ct, sizeof(ct)) != 0) goto fail_io;
+
+        uint64_t max_seq = 0;
+        uint32_t staged = 0;
+        for (uint32_t k = 0; k < r->slot_count; k++) {
+            if ((uint64_t)(staged + 1) * r->slot_size > stage_size) {
+                if (write_all(fd, stage, (size_t)staged * r->slot_size) != 0) goto fail_io;
+                staged = 0;
+            }
+            uint64_t seq = stage_slot(r, slots + (uint64_t)k * r->slot_size,
+                                      stage + (uint64_t)staged * r->slot_size);
+            if (seq > max_seq) max_seq = seq;
+            staged++;
+        }
+        if (staged && write_all(fd, stage, (size_t)staged * r->slot_size) != 0) goto fail_io;
+
+        /* Schema versions follow the image, so restore can bind them again */
+        for (const UsrlShmSchema *d = usrl_schema_next_desc(base, t->name, NULL); d;
+             d = usrl_schema_next_desc(base, t->name, d)) {
+            UsrlShmSchema copy = *d;
+            copy.next_offset = 0;
+            if (write_all(fd, &copy, sizeof(copy)) != 0) goto fail_io;
+            ct.schema_count++;
+        }
+
+        /*
+         * Restore keeps only the consecutive seqs ending at w_head; anything
+         * below the first hole was copied before the writers lapped it and
+         * is not part of one consistent window.
+         */
+        ct.w_head = max_seq;
+        if (pwrite(fd, &ct, sizeof(ct), rec_pos) != (ssize_t)sizeof(ct)) goto fail_io;
+    }
+
+    free(stage);
+    if (fsync(fd) != 0 || close(fd) != 0) return -2;
+    return (int)ch.topic_count;
+
+fail_io:
+    free(stage);
+    close(fd);
+    return -2;
+}
+
+/* --------------------------------------------------------------------------
+ * Restore
+ * -------------------------------------------------------------------------- */
+
+/* Image slot holding `seq`, or NULL if it is missing, torn or malformed */
+static const SlotHeader *image_slot(const UsrlCheckpointTopic *ct, const uint8_t *image,
+                                    uint64_t seq)
+{
+    const SlotHeader *sh =
+        (const SlotHeader *)(image + ((seq - 1) % ct->slot_count) * (uint64_t)ct->slot_size);
+    uint64_t s = atomic_load_explicit((atomic_uint_fast64_t *)&sh->seq, memory_order_relaxed);
+    if (s != seq || !slot_len_ok(sh->payload_len, ct->slot_size)) return NULL;
+    return sh;
+}
+
+static void restore_topic(void *base, TopicEntry *t, const UsrlCheckpointTopic *ct,
+                          const uint8_t *image)
+{
+    RingDesc *r = (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
+    uint8_t *slots = (uint8_t *)base + r->base_offset;
+    uint64_t mask = r->slot_count - 1;
+
+    /*
+     * The restored ring is a new generation: a writer that attached before
+     * the restore and commits after it stamps the old one, and readers drop
+     * that slot instead of mixing it into the restored window.
+     */
+    uint32_t gen = r->generation + 1;
+    if (gen == 0) gen = 1;
+
+    /*
+     * Slots torn during the save leave holes, and a reader can not step over
+     * a hole. Keep only the run of consecutive seqs ending at w_head, bounded
+     * by what the live ring can hold; everything at or below floor_seq is
+     * reported to readers as skipped.
+     */
+    uint64_t window = (ct->slot_count < r->slot_count) ? ct->slot_count : r->slot_count;
+    uint64_t floor_seq = ct->w_head;
+    while (floor_seq > 0 && ct->w_head - floor_seq < window &&
+           image_slot(ct, image, floor_seq) != NULL) {
+        floor_seq--;
+    }
+    if (floor_seq == ct->w_head) return; /* nothing consistent to restore */
+
+    for (uint64_t seq = floor_seq + 1; seq <= ct->w_head; seq++) {
+        const SlotHeader *sh = image_slot(ct, image, seq);
+        uint8_t *dst = slots + ((seq - 1) & mask) * (uint64_t)r->slot_size;
+        SlotHeader *dh = (SlotHeader *)dst;
+
+        memcpy(dst + sizeof(SlotHeader), (const uint8_t *)sh + sizeof(SlotHeader),
+               r->slot_size - sizeof(SlotHeader));
+        dh->timestamp_ns = sh->timestamp_ns;
+        dh->payload_len = sh->payload_len;
+        dh->pub_id = sh->pub_id;
+        dh->schema_id = sh->schema_id;
+        dh->schema_ver = sh->schema_ver;
+        dh->gen = gen;
+        atomic_store_explicit(&dh->seq, seq, memory_order_release);
+    }
+
+    /*
+     * Readers attached before the restore sit at seq 0: raise the floor and
+     * bump the epoch so they refresh (picking up the generation) and clamp
+     * to it. The head goes last so readers never look past restored slots.
+     */
+    r->generation = gen;
+    atomic_store_explicit(&r->floor_seq, floor_seq, memory_order_relaxed);
+    atomic_fetch_add_explicit(&r->epoch, 1, memory_order_release);
+    atomic_store_explicit(&r->w_head, ct->w_head, memory_order_release);
+}
+
+/*
+ * Bind the saved schema versions. All are checked before any is bound, so a
+ * conflicting topic is left as it was. Returns 0, -2 conflict, -3 corrupt
+ * descriptor, or a usrl_schema_bind error.
+ */
+static int restore_schemas(void *base, const char *topic, const UsrlShmSchema *descs,
+                           uint32_t count)
+{
+    for (int bind = 0; bind < 2; bind++) {
+        for (uint32_t k = 0; k < count; k++) {
+            UsrlSchema *s = usrl_schema_from_desc(&descs[k]);
+            if (!s) return -3;
+            int rc = bind ? usrl_schema_bind(base, topic, s) : usrl_schema_check(base, topic, s);
+            usrl_schema_free(s);
+            if (rc != 0) return rc;
+        }
+    }
+    return 0;
+}
+
+int usrl_checkpoint_restore(void *base, const char *file_path)
+{
+    if (!base || !file_path) return -1;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC) return -1;
+    atomic_thread_fence(memory_order_acquire);
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) return -2;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -2;
+    }
+    if (st.st_size < (off_t)sizeof(UsrlCheckpointHeader)) {
+        close(fd);
+        return -3;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    const uint8_t *map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -2;
+    madvise((void *)map, file_size, MADV_SEQUENTIAL);
+
+    const UsrlCheckpointHeader *ch = (const UsrlCheckpointHeader *)map;
+    /* Slot and ring images are only meaningful under the layout that wrote them */
+    if (ch->magic != USRL_CHECKPOINT_MAGIC || ch->version != USRL_CHECKPOINT_VERSION ||
+        ch->layout != hdr->version) {
+        munmap((void *)map, file_size);
+        return -3;
+    }
+
+    int restored = 0;
+    size_t pos = sizeof(*ch);
+
+    for (uint32_t i = 0; i < ch->topic_count; i++) {
+        if (pos + sizeof(UsrlCheckpointTopic) > file_size) goto corrupt;
+        const UsrlCheckpointTopic *ct = (const UsrlCheckpointTopic *)(map + pos);
+        pos += sizeof(*ct);
+
+        if (ct->image_bytes != (uint64_t)ct->slot_count * ct->slot_size ||
+            ct->slot_size < sizeof(SlotHeader) ||
+            pos + ct->image_bytes > file_size) goto corrupt;
+
+        const uint8_t *image = map + pos;
+        pos += ct->image_bytes;
+
+        const UsrlShmSchema *descs = (const UsrlShmSchema *)(map + pos);
+        if (pos + (uint64_t)ct->schema_count * sizeof(UsrlShmSchema) > file_size) goto corrupt;
+        pos += (size_t)ct->schema_count * sizeof(UsrlShmSchema);
+
+        char name[USRL_MAX_TOPIC_NAME];
+        memcpy(name, ct->name, USRL_MAX_TOPIC_NAME);
+        name[USRL_MAX_TOPIC_NAME - 1] = '\0';
+
+        TopicEntry *t = usrl_get_topic(base, name);
+        if (!t || t->slot_size != ct->slot_size) continue;
+
+        RingDesc *r = (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
+        if (atomic_load_explicit(&r->w_head, memory_order_acquire) != 0) continue;
+
+        int rc = restore_schemas(base, name, descs, ct->schema_count);
+        if (rc == -3) goto corrupt;
+        if (rc != 0) continue;
+
+        restore_topic(base, t, ct, image);
+        restored++;
+    }
+
+    munmap((void *)map, file_size);
+    return restored;
+
+corrupt:
+    munmap((void *)map, file_size);
+    return -3;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file usrl_clock.c
+ * @brief Tick source selection and calibration.
+ */
+
+#include "usrl_clock.h"
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#define USRL_CLOCK_CALIBRATE_NS 5000000ULL /* 5 ms */
+
+/* Until usrl_clock_init() runs, ticks are nanoseconds */
+UsrlClock usrl_clock = {false, 1000000000ULL, 1ULL << 32, 1ULL << 32};
+
+static pthread_once_t g_clock_once = PTHREAD_ONCE_INIT;
+
+#if defined(__x86_64__) || defined(__i386__)
+/* CPUID.80000007H:EDX[8]: TSC rate is constant across P/C-states */
+static bool tsc_invariant(void)
+{
+    unsigned a, b, c, d;
+    if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+    __get_cpuid(0x80000007, &a, &b, &c, &d);
+    return (d & (1u << 8)) != 0;
+}
+
+static inline uint64_t read_tsc(void)
+{
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static uint64_t calibrate_tsc(void)
+{
+    uint64_t t0 = usrl_clock_ns();
+    uint64_t c0 = read_tsc();
+    uint64_t t1;
+    do {
+        t1 = usrl_clock_ns();
+    } while (t1 - t0 < USRL_CLOCK_CALIBRATE_NS);
+    uint64_t c1 = read_tsc();
+
+    return (uint64_t)(((unsigned __int128)(c1 - c0) * 1000000000ULL) / (t1 - t0));
+}
+#endif
+
+static void clock_setup(void)
+{
+    uint64_t rate = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (tsc_invariant()) rate = calibrate_tsc();
+#elif defined(__aarch64__)
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(rate));
+#endif
+
+    if (rate == 0) return; /* keep the CLOCK_MONOTONIC fallback */
+
+    usrl_clock.ticks_per_sec = rate;
+    usrl_clock.mult = (1000000000ULL << 32) / rate;
+    usrl_clock.inv_mult = (uint64_t)(((unsigned __int128)rate << 32) / 1000000000ULL);
+    usrl_clock.hw = true;
+}
+
+void usrl_clock_init(void)
+{
+    pthread_once(&g_clock_once, clock_setup);
+}
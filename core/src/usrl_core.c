@@ -1,4 +1,6 @@
 #include "usrl_core.h"
+#include "usrl_latency.h"
+#include "usrl_clock.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,6 +10,8 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <sched.h>
+#include <signal.h>
 
 /**
  * @file usrl_core.c
@@ -40,6 +44,51 @@ static uint32_t next_power_of_two_u32(uint32_t v)
     return ++v;
 }
 
+/* Size a topic's ring from its config */
+static void topic_geometry(const UsrlTopicConfig *cfg, uint32_t *slots, uint32_t *slot_size)
+{
+    *slots = next_power_of_two_u32(cfg->slot_count);
+    *slot_size = (uint32_t)usrl_align_up(sizeof(SlotHeader) + cfg->slot_size, 8);
+}
+
+/* Fill a topic entry and its ring descriptor; all offsets already placed */
+static void topic_fill(void *base, const CoreHeader *hdr, TopicEntry *t,
+                       const UsrlTopicConfig *cfg, uint64_t desc_off,
+                       uint64_t writers_off, uint64_t readers_off, uint64_t slots_off)
+{
+    uint32_t slots_pow2, slot_sz_aligned;
+    topic_geometry(cfg, &slots_pow2, &slot_sz_aligned);
+
+    strncpy(t->name, cfg->name, USRL_MAX_TOPIC_NAME - 1);
+    t->name[USRL_MAX_TOPIC_NAME - 1] = '\0';
+
+    t->ring_desc_offset = desc_off;
+    t->type = cfg->type;
+    t->flags = cfg->flags;
+    t->writers_offset = writers_off;
+    t->readers_offset = readers_off;
+    atomic_store_explicit(&t->schema_offset, 0, memory_order_relaxed);
+    t->slot_count = slots_pow2;
+    t->slot_size = slot_sz_aligned;
+
+    RingDesc *r = (RingDesc *)((uint8_t *)base + desc_off);
+    r->slot_count = slots_pow2;
+    r->slot_size = slot_sz_aligned;
+    r->base_offset = slots_off;
+    r->generation = hdr->generation;
+    atomic_store_explicit(&r->w_head, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->floor_seq, 0, memory_order_relaxed);
+}
+
+int usrl_core_init(
+    const char *path,
+    uint64_t size,
+    const UsrlTopicConfig *topics,
+    uint32_t count)
+{
+    return usrl_core_init_ex(path, size, topics, count, count);
+}
+
 /**
  * usrl_core_init return codes (recommended convention)
  *  0  : created and initialized
@@ -49,16 +98,18 @@ static uint32_t next_power_of_two_u32(uint32_t v)
  * -3  : mmap failed
  * -4  : insufficient SHM space for requested layout
  */
-int usrl_core_init(
+int usrl_core_init_ex(
     const char *path,
     uint64_t size,
     const UsrlTopicConfig *topics,
-    uint32_t count)
+    uint32_t count,
+    uint32_t capacity)
 {
-    DEBUG_PRINT_CORE("init path=%s size=%llu topics=%u\n",
-                     path, (unsigned long long)size, count);
+    DEBUG_PRINT_CORE("init path=%s size=%llu topics=%u capacity=%u\n",
+                     path, (unsigned long long)size, count, capacity);
 
-    if (!path || size < 4096 || !topics || count == 0) return -1;
+    if (!path || size < 4096 || (count && !topics) || capacity == 0 || count > capacity)
+        return -1;
 
     /* Create fresh shared memory object only if it does NOT exist */
     int fd = shm_open(path, O_CREAT | O_RDWR | O_EXCL, 0666);
@@ -85,26 +136,48 @@ int usrl_core_init(
         return -3;
     }
 
-    memset(base, 0, size);
-
+    /*
+     * A freshly ftruncate()d object is already zero-filled, so nothing below
+     * touches slot memory: only the header, topic table and ring descriptors
+     * are written (O(topics) pages faulted instead of the whole region).
+     * Slots are validated against the ring generation instead of being
+     * cleared.
+     */
     CoreHeader *hdr = (CoreHeader *)base;
-    hdr->magic = USRL_MAGIC;
-    hdr->version = 1;
+    hdr->version = USRL_LAYOUT_VERSION;
     hdr->mmap_size = size;
+    hdr->generation = 1;
 
     uint64_t current_offset = usrl_align_up(sizeof(CoreHeader), USRL_ALIGNMENT);
 
     hdr->topic_table_offset = current_offset;
-    hdr->topic_count = count;
+    hdr->topic_capacity = capacity;
+    atomic_store_explicit(&hdr->topic_count, count, memory_order_relaxed);
 
     uint64_t ring_desc_start = usrl_align_up(
-        current_offset + (sizeof(TopicEntry) * count),
+        current_offset + (sizeof(TopicEntry) * capacity),
         USRL_ALIGNMENT);
 
-    uint64_t slots_start = usrl_align_up(
+    uint64_t writers_start = usrl_align_up(
         ring_desc_start + (sizeof(RingDesc) * count),
         USRL_ALIGNMENT);
 
+    uint64_t readers_start = usrl_align_up(
+        writers_start + (sizeof(UsrlWriterTable) * count),
+        USRL_ALIGNMENT);
+
+    uint64_t slots_start = usrl_align_up(
+        readers_start + (sizeof(UsrlReaderTable) * count),
+        USRL_ALIGNMENT);
+
+    if (slots_start > size) {
+        DEBUG_PRINT_CORE("OOM metadata for %u topics needs=%llu bytes\n",
+                         count, (unsigned long long)slots_start);
+        munmap(base, size);
+        close(fd);
+        return -4;
+    }
+
     uint64_t next_free_slot_offset = slots_start;
 
     for (uint32_t i = 0; i < count; ++i) {
@@ -112,26 +185,13 @@ int usrl_core_init(
                                        hdr->topic_table_offset +
                                        (i * sizeof(TopicEntry)));
 
-        strncpy(t->name, topics[i].name, USRL_MAX_TOPIC_NAME - 1);
-        t->name[USRL_MAX_TOPIC_NAME - 1] = '\0';
-
-        t->ring_desc_offset = ring_desc_start + (i * sizeof(RingDesc));
+        topic_fill(base, hdr, t, &topics[i],
+                   ring_desc_start + (i * sizeof(RingDesc)),
+                   writers_start + (i * sizeof(UsrlWriterTable)),
+                   readers_start + (i * sizeof(UsrlReaderTable)),
+                   next_free_slot_offset);
 
-        uint32_t slots_pow2 = next_power_of_two_u32(topics[i].slot_count);
-        uint32_t slot_sz_aligned =
-            (uint32_t)usrl_align_up(sizeof(SlotHeader) + topics[i].slot_size, 8);
-
-        t->type = topics[i].type;
-        t->slot_count = slots_pow2;
-        t->slot_size = slot_sz_aligned;
-
-        RingDesc *r = (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
-        r->slot_count = slots_pow2;
-        r->slot_size = slot_sz_aligned;
-        r->base_offset = next_free_slot_offset;
-        atomic_store_explicit(&r->w_head, 0, memory_order_relaxed);
-
-        uint64_t total_bytes_for_topic = (uint64_t)slots_pow2 * slot_sz_aligned;
+        uint64_t total_bytes_for_topic = (uint64_t)t->slot_count * t->slot_size;
 
         if (next_free_slot_offset + total_bytes_for_topic > size) {
             DEBUG_PRINT_CORE("OOM topic=%s needs=%llu bytes\n",
@@ -142,12 +202,6 @@ int usrl_core_init(
             return -4;
         }
 
-        uint8_t *slot_ptr = (uint8_t *)base + next_free_slot_offset;
-        for (uint32_t k = 0; k < slots_pow2; ++k) {
-            SlotHeader *sh = (SlotHeader *)(slot_ptr + ((uint64_t)k * slot_sz_aligned));
-            atomic_store_explicit(&sh->seq, 0, memory_order_relaxed);
-        }
-
         next_free_slot_offset += total_bytes_for_topic;
         next_free_slot_offset = usrl_align_up(next_free_slot_offset, USRL_ALIGNMENT);
     }
@@ -156,6 +210,12 @@ int usrl_core_init(
                      (unsigned long long)next_free_slot_offset,
                      (unsigned long long)size);
 
+    atomic_store_explicit(&hdr->alloc_offset, next_free_slot_offset, memory_order_relaxed);
+
+    /* Publish: anyone who observes the magic observes the full layout */
+    atomic_thread_fence(memory_order_release);
+    hdr->magic = USRL_MAGIC;
+
     munmap(base, size);
     close(fd);
     return 0;
@@ -200,10 +260,15 @@ TopicEntry *usrl_get_topic(void *base, const char *name)
 
     CoreHeader *hdr = (CoreHeader *)base;
     if (hdr->magic != USRL_MAGIC) return NULL;
+    atomic_thread_fence(memory_order_acquire);
+
+    /* A region left behind by an older build has a different table layout */
+    if (hdr->version != USRL_LAYOUT_VERSION) return NULL;
 
     TopicEntry *t = (TopicEntry *)((uint8_t *)base + hdr->topic_table_offset);
+    uint32_t count = atomic_load_explicit(&hdr->topic_count, memory_order_acquire);
 
-    for (uint32_t i = 0; i < hdr->topic_count; i++) {
+    for (uint32_t i = 0; i < count; i++) {
         if (strncmp(t[i].name, name, USRL_MAX_TOPIC_NAME) == 0)
             return &t[i];
     }
@@ -214,3 +279,267 @@ void usrl_core_unmap(void *base, size_t size)
 {
     if (base && size) munmap(base, size);
 }
+
+/**
+ * Lock-free bump allocation from the region tail. The cursor only moves
+ * forward, so concurrent callers in different processes never overlap.
+ */
+uint64_t usrl_core_alloc(void *base, uint64_t bytes)
+{
+    if (!base || bytes == 0) return 0;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC) return 0;
+
+    uint64_t cur = atomic_load_explicit(&hdr->alloc_offset, memory_order_relaxed);
+    for (;;) {
+        uint64_t start = usrl_align_up(cur, USRL_ALIGNMENT);
+        if (start + bytes > hdr->mmap_size || start + bytes < start) return 0;
+
+        if (atomic_compare_exchange_weak_explicit(&hdr->alloc_offset, &cur, start + bytes,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+            return start;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Topic registry
+ * -------------------------------------------------------------------------- */
+
+/* Take the add-topic lock; a holder that died is replaced */
+static void topic_lock(CoreHeader *hdr)
+{
+    uint32_t me = (uint32_t)getpid();
+    for (;;) {
+        uint32_t holder = 0;
+        if (atomic_compare_exchange_weak_explicit(&hdr->topic_lock, &holder, me,
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed))
+            return;
+        if (holder != 0 && holder != me && kill((pid_t)holder, 0) != 0 && errno == ESRCH) {
+            atomic_compare_exchange_strong_explicit(&hdr->topic_lock, &holder, 0,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed);
+            continue;
+        }
+        sched_yield();
+    }
+}
+
+static void topic_unlock(CoreHeader *hdr)
+{
+    atomic_store_explicit(&hdr->topic_lock, 0, memory_order_release);
+}
+
+int usrl_core_add_topic(void *base, const UsrlTopicConfig *cfg)
+{
+    if (!base || !cfg || cfg->name[0] == '\0' || cfg->slot_count == 0) return -1;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC || hdr->version != USRL_LAYOUT_VERSION) return -1;
+    atomic_thread_fence(memory_order_acquire);
+
+    if (usrl_get_topic(base, cfg->name)) return 1;
+
+    topic_lock(hdr);
+
+    /* Re-check under the lock: another process may have just added it */
+    if (usrl_get_topic(base, cfg->name)) {
+        topic_unlock(hdr);
+        return 1;
+    }
+
+    uint32_t count = atomic_load_explicit(&hdr->topic_count, memory_order_relaxed);
+    if (count >= hdr->topic_capacity) {
+        topic_unlock(hdr);
+        return -4;
+    }
+
+    uint32_t slots_pow2, slot_sz_aligned;
+    topic_geometry(cfg, &slots_pow2, &slot_sz_aligned);
+
+    /*
+     * Descriptor, both tables and the exact-sized ring come from a single
+     * allocation, so running out of space leaves nothing allocated (the bump
+     * allocator never gives space back).
+     */
+    uint64_t desc_bytes = usrl_align_up(sizeof(RingDesc), USRL_ALIGNMENT);
+    uint64_t ring_rel = usrl_align_up(desc_bytes + sizeof(UsrlWriterTable) +
+                                      sizeof(UsrlReaderTable), USRL_ALIGNMENT);
+    uint64_t meta = usrl_core_alloc(base, ring_rel + (uint64_t)slots_pow2 * slot_sz_aligned);
+    uint64_t ring = meta + ring_rel;
+    if (!meta) {
+        topic_unlock(hdr);
+        DEBUG_PRINT_CORE("OOM adding topic=%s\n", cfg->name);
+        return -4;
+    }
+
+    TopicEntry *t = (TopicEntry *)((uint8_t *)base + hdr->topic_table_offset) + count;
+    topic_fill(base, hdr, t, cfg, meta, meta + desc_bytes,
+               meta + desc_bytes + sizeof(UsrlWriterTable), ring);
+
+    /* Publish: a reader that sees the new count sees the whole entry */
+    atomic_store_explicit(&hdr->topic_count, count + 1, memory_order_release);
+    topic_unlock(hdr);
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * Publisher registry
+ * -------------------------------------------------------------------------- */
+
+uint16_t usrl_core_pub_id(void *base)
+{
+    CoreHeader *hdr = (CoreHeader *)base;
+    uint32_t n = atomic_fetch_add_explicit(&hdr->pub_id_seq, 1, memory_order_relaxed);
+    return (uint16_t)(n % 65535u + 1u);
+}
+
+/*
+ * Prepare a newly taken entry: weight back to 1, counters and heartbeat
+ * zeroed. Free entries carry weight 0, so total_weight only counts owners.
+ */
+static void writer_reset(UsrlWriterTable *wt, UsrlWriterEntry *w)
+{
+    uint32_t old = atomic_exchange_explicit(&w->weight, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&wt->total_weight, 1 - old, memory_order_relaxed);
+    atomic_store_explicit(&w->claim_seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->hb.tick, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->hb.beat_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->hb.period_ms, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->claimed, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->timeouts, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->throttled, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->window, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->window_claims, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->published, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->dropped, 0, memory_order_relaxed);
+}
+
+UsrlWriterEntry *usrl_writer_attach(void *base, const TopicEntry *t, uint16_t pub_id)
+{
+    if (!base || !t) return NULL;
+    UsrlWriterTable *wt = (UsrlWriterTable *)((uint8_t *)base + t->writers_offset);
+    uint32_t owner = (uint32_t)pub_id + 1;
+
+    for (int i = 0; i < USRL_MAX_WRITERS; i++) {
+        UsrlWriterEntry *w = &wt->entries[i];
+        if (atomic_load_explicit(&w->owner, memory_order_acquire) == owner) {
+            w->pid = (uint32_t)getpid();
+            return w;
+        }
+    }
+
+    /* Second pass takes over entries left by processes that have exited */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < USRL_MAX_WRITERS; i++) {
+            UsrlWriterEntry *w = &wt->entries[i];
+            uint32_t expected = atomic_load_explicit(&w->owner, memory_order_acquire);
+
+            if (pass == 0) {
+                if (expected != 0) continue;
+            } else if (expected == 0 || w->pid == 0 ||
+                       kill((pid_t)w->pid, 0) == 0 || errno != ESRCH) {
+                continue;
+            }
+
+            if (atomic_compare_exchange_strong_explicit(&w->owner, &expected, owner,
+                                                        memory_order_acq_rel,
+                                                        memory_order_acquire)) {
+                writer_reset(wt, w);
+                w->pid = (uint32_t)getpid();
+                return w;
+            }
+        }
+    }
+    atomic_fetch_add_explicit(&wt->untracked, 1, memory_order_relaxed);
+    return NULL;
+}
+
+/* Give the entry back; its counters go with it */
+void usrl_writer_detach(void *base, const TopicEntry *t, UsrlWriterEntry *w)
+{
+    if (!base || !t || !w) return;
+    UsrlWriterTable *wt = (UsrlWriterTable *)((uint8_t *)base + t->writers_offset);
+
+    uint32_t old = atomic_exchange_explicit(&w->weight, 0, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&wt->total_weight, old, memory_order_relaxed);
+    atomic_store_explicit(&w->hb.period_ms, 0, memory_order_relaxed);
+    w->pid = 0;
+    atomic_store_explicit(&w->owner, 0, memory_order_release);
+}
+
+void usrl_heartbeat(UsrlHeartbeat *hb, uint32_t period_ms)
+{
+    if (!hb) return;
+    atomic_store_explicit(&hb->beat_ns, usrl_clock_ns(), memory_order_relaxed);
+    usrl_writer_count(&hb->tick);
+    if (atomic_load_explicit(&hb->period_ms, memory_order_relaxed) != period_ms)
+        atomic_store_explicit(&hb->period_ms, period_ms, memory_order_relaxed);
+}
+
+int usrl_writer_stats(void *base, const char *topic, UsrlWriterStats *out, int max)
+{
+    if (!base || !topic || (!out && max > 0)) return -1;
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t) return -1;
+
+    UsrlWriterTable *wt = (UsrlWriterTable *)((uint8_t *)base + t->writers_offset);
+    int n = 0;
+    for (int i = 0; i < USRL_MAX_WRITERS && n < max; i++) {
+        UsrlWriterEntry *e = &wt->entries[i];
+        uint32_t owner = atomic_load_explicit(&e->owner, memory_order_acquire);
+        if (owner == 0) continue;
+        out[n].pub_id = (uint16_t)(owner - 1);
+        out[n].pid = e->pid;
+        out[n].weight = atomic_load_explicit(&e->weight, memory_order_relaxed);
+        out[n].published = atomic_load_explicit(&e->published, memory_order_relaxed);
+        out[n].dropped = atomic_load_explicit(&e->dropped, memory_order_relaxed);
+        out[n].claimed = atomic_load_explicit(&e->claimed, memory_order_relaxed);
+        out[n].timeouts = atomic_load_explicit(&e->timeouts, memory_order_relaxed);
+        out[n].throttled = atomic_load_explicit(&e->throttled, memory_order_relaxed);
+        n++;
+    }
+    return n;
+}
+
+int usrl_reader_stats(void *base, const char *topic, UsrlReaderStats *out, int max)
+{
+    if (!base || !topic || (!out && max > 0)) return -1;
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t) return -1;
+
+    RingDesc *r = (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)base + t->readers_offset);
+    uint64_t head = usrl_ring_head(r);
+    int n = 0;
+    for (int i = 0; i < USRL_MAX_READERS && n < max; i++) {
+        UsrlReaderEntry *e = &rt->entries[i];
+        if (atomic_load_explicit(&e->owner, memory_order_acquire) == 0) continue;
+        uint64_t cursor = atomic_load_explicit(&e->cursor, memory_order_relaxed);
+        out[n].pid = e->pid;
+        out[n].slot = (uint32_t)i;
+        out[n].cursor = cursor;
+        out[n].lag = (head > cursor) ? head - cursor : 0;
+        out[n].reads = atomic_load_explicit(&e->reads, memory_order_relaxed);
+        out[n].skips = atomic_load_explicit(&e->skips, memory_order_relaxed);
+        out[n].max_lag = atomic_load_explicit(&e->max_lag, memory_order_relaxed);
+        out[n].last_read_ns = atomic_load_explicit(&e->last_read_ns, memory_order_relaxed);
+        out[n].read_rate_hz = atomic_load_explicit(&e->read_rate_hz, memory_order_relaxed);
+        out[n].head_rate_hz = atomic_load_explicit(&e->head_rate_hz, memory_order_relaxed);
+        n++;
+    }
+    return n;
+}
+
+const UsrlLatencyHist *usrl_reader_latency(void *base, const char *topic, uint32_t slot)
+{
+    if (!base || !topic || slot >= USRL_MAX_READERS) return NULL;
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t) return NULL;
+
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)base + t->readers_offset);
+    uint64_t off = atomic_load_explicit(&rt->entries[slot].lat_offset, memory_order_acquire);
+    return off ? (const UsrlLatencyHist *)((uint8_t *)base + off) : NULL;
+}
@@ -6,6 +6,8 @@
 #include <string.h>
 #include <time.h>
 #include <stdio.h>
+#include <errno.h>
+#include <signal.h>
 
 /* Helper for monotonic time */
 static inline uint64_t usrl_now_ns(void)
@@ -16,100 +18,311 @@ static inline uint64_t usrl_now_ns(void)
 }
 
 /* =============================================================================
- * HEALTH QUERY (Compat with usrl_api.c)
+ * HEALTH QUERY
+ *
+ * health_fill reads one topic straight from its descriptor and writer/reader
+ * tables: no allocation, no lookup, so it can run for every topic of a
+ * region in one pass.
  * ============================================================================= */
-RingHealth *usrl_health_get(void *base, const char *topic)
+static void health_fill(void *base, const TopicEntry *t, RingHealth *health, uint64_t now)
 {
-    if (!base || !topic) return NULL;
-
-    TopicEntry *t = usrl_get_topic(base, topic);
-    if (!t) return NULL;
-
     RingDesc *d = (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
 
-    RingHealth *health = malloc(sizeof(*health));
-    if (!health) return NULL;
     memset(health, 0, sizeof(*health));
-
-    strncpy(health->topic_name, topic, USRL_MAX_TOPIC_NAME - 1);
+    memcpy(health->topic_name, t->name, USRL_MAX_TOPIC_NAME);
+    health->topic_name[USRL_MAX_TOPIC_NAME - 1] = '\0';
     health->ring_type = t->type;
-    health->last_updated_ns = usrl_now_ns();
+    health->last_updated_ns = now;
 
-    uint64_t head = atomic_load_explicit(&d->w_head, memory_order_acquire);
+    uint64_t head = usrl_ring_head(d);
     health->pub_health.total_published = head;
 
     if (head > 0) {
         uint32_t idx = (uint32_t)((head - 1) & (d->slot_count - 1));
         uint8_t *slot = (uint8_t *)base + d->base_offset + ((uint64_t)idx * d->slot_size);
         SlotHeader *hdr = (SlotHeader *)slot;
-        
+
         uint64_t ts = hdr->timestamp_ns;
         uint64_t seq = atomic_load_explicit(&hdr->seq, memory_order_acquire);
-        
-        if (seq == head) {
-            health->pub_health.last_publish_ns = ts;
-        } else {
-            health->pub_health.last_publish_ns = 0;
-        }
+        health->pub_health.last_publish_ns = (seq == head) ? ts : 0;
     }
 
-    health->sub_health.lag_slots = 0; 
+    /* Subscriber side comes from the reader table: worst lag, slowest reader */
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)base + t->readers_offset);
+    SubscriberHealth *sh = &health->sub_health;
+    bool first = true;
+    for (int i = 0; i < USRL_MAX_READERS; i++) {
+        UsrlReaderEntry *e = &rt->entries[i];
+        if (atomic_load_explicit(&e->owner, memory_order_acquire) == 0) continue;
+
+        uint64_t cursor = atomic_load_explicit(&e->cursor, memory_order_relaxed);
+        uint64_t lag = (head > cursor) ? head - cursor : 0;
+        uint64_t max_lag = atomic_load_explicit(&e->max_lag, memory_order_relaxed);
+        uint64_t last = atomic_load_explicit(&e->last_read_ns, memory_order_relaxed);
+        uint64_t rate = atomic_load_explicit(&e->read_rate_hz, memory_order_relaxed);
+        uint64_t head_rate = atomic_load_explicit(&e->head_rate_hz, memory_order_relaxed);
+
+        sh->total_read += atomic_load_explicit(&e->reads, memory_order_relaxed);
+        sh->total_skipped += atomic_load_explicit(&e->skips, memory_order_relaxed);
+        if (lag > sh->lag_slots) sh->lag_slots = lag;
+        if (max_lag > sh->max_lag_observed) sh->max_lag_observed = max_lag;
+        if (last > sh->last_read_ns) sh->last_read_ns = last;
+        if (first || rate < sh->subscribe_rate_hz) sh->subscribe_rate_hz = rate;
+        if (head_rate > health->pub_health.publish_rate_hz)
+            health->pub_health.publish_rate_hz = head_rate;
+        first = false;
+    }
+    if (sh->lag_slots > sh->max_lag_observed) sh->max_lag_observed = sh->lag_slots;
+
+    UsrlWriterTable *wt = (UsrlWriterTable *)((uint8_t *)base + t->writers_offset);
+    for (int i = 0; i < USRL_MAX_WRITERS; i++) {
+        UsrlWriterEntry *e = &wt->entries[i];
+        if (atomic_load_explicit(&e->owner, memory_order_acquire) == 0) continue;
+        health->pub_health.total_dropped +=
+            atomic_load_explicit(&e->dropped, memory_order_relaxed) +
+            atomic_load_explicit(&e->timeouts, memory_order_relaxed);
+    }
+}
+
+int usrl_health_fill(void *base, const char *topic, RingHealth *out)
+{
+    if (!base || !topic || !out) return -1;
+
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t) return -1;
+
+    health_fill(base, t, out, usrl_now_ns());
+    return 0;
+}
 
+RingHealth *usrl_health_get(void *base, const char *topic)
+{
+    if (!base || !topic) return NULL;
+
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t) return NULL;
+
+    RingHealth *health = malloc(sizeof(*health));
+    if (!health) return NULL;
+
+    health_fill(base, t, health, usrl_now_ns());
     return health;
 }
 
+int usrl_health_snapshot_all(void *base, RingHealth *out, uint32_t cap)
+{
+    if (!base || (!out && cap > 0)) return -1;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC || hdr->version != USRL_LAYOUT_VERSION) return -1;
+
+    TopicEntry *topics = (TopicEntry *)((uint8_t *)base + hdr->topic_table_offset);
+    uint32_t count = atomic_load_explicit(&hdr->topic_count, memory_order_acquire);
+    uint32_t n = (count < cap) ? count : cap;
+
+    /* One timestamp for the whole snapshot */
+    uint64_t now = usrl_now_ns();
+    for (uint32_t i = 0; i < n; i++) health_fill(base, &topics[i], &out[i], now);
+
+    return (int)count;
+}
+
 void usrl_health_free(RingHealth *health)
 {
     if (health) free(health);
 }
 
 /* =============================================================================
- * MISSING HELPERS (Restored for Linker)
+ * LIVENESS
+ *
+ * Stateless: a dead pid, a heartbeat promise two periods overdue, and an open
+ * claim older than the bound are all visible from one look at the entry.
  * ============================================================================= */
+static int pid_dead(uint32_t pid)
+{
+    return pid != 0 && kill((pid_t)pid, 0) != 0 && errno == ESRCH;
+}
 
-int usrl_health_check_lag(void *base, const char *topic, uint64_t lag_threshold_slots)
+static int beat_overdue(const UsrlHeartbeat *hb, uint64_t now, uint64_t *age)
 {
-    RingHealth *h = usrl_health_get(base, topic);
-    if (!h) return -1;
+    uint32_t period = atomic_load_explicit(&hb->period_ms, memory_order_relaxed);
+    if (period == 0) return 0;
+    uint64_t beat = atomic_load_explicit(&hb->beat_ns, memory_order_relaxed);
+    *age = now > beat ? now - beat : 0;
+    return *age > 2ULL * period * 1000000ULL;
+}
 
-    int res = (h->sub_health.lag_slots > lag_threshold_slots);
-    free(h);
-    return res;
+static void live_add(UsrlLiveness *out, uint32_t cap, uint32_t n, const TopicEntry *t,
+                     uint32_t state, uint32_t role, uint32_t slot, uint32_t pid,
+                     uint16_t pub_id, uint64_t seq, uint64_t age)
+{
+    if (n >= cap) return;
+    UsrlLiveness *l = &out[n];
+    memcpy(l->topic, t->name, USRL_MAX_TOPIC_NAME);
+    l->topic[USRL_MAX_TOPIC_NAME - 1] = '\0';
+    l->state = state;
+    l->role = role;
+    l->slot = slot;
+    l->pid = pid;
+    l->pub_id = pub_id;
+    l->seq = seq;
+    l->age_ns = age;
 }
 
-/* Renamed to match linker expectation if needed. 
-   Your error says `usrl_health_detect_deadlock`, so we name it that. 
-   Ideally "inactivity" is a better name, but we match the caller. */
-int usrl_health_detect_deadlock(void *base, const char *topic, uint64_t timeout_ms)
+/* Appends this topic's findings at out[n]; returns the new count */
+static uint32_t topic_liveness(void *base, const TopicEntry *t, uint64_t now,
+                               uint64_t claim_bound_ns, UsrlLiveness *out, uint32_t cap,
+                               uint32_t n)
 {
-    RingHealth *h = usrl_health_get(base, topic);
-    if (!h) return -1;
+    UsrlWriterTable *wt = (UsrlWriterTable *)((uint8_t *)base + t->writers_offset);
+    for (uint32_t i = 0; i < USRL_MAX_WRITERS; i++) {
+        UsrlWriterEntry *w = &wt->entries[i];
+        uint32_t owner = atomic_load_explicit(&w->owner, memory_order_relaxed);
+        uint32_t pid = w->pid;
+        if (owner == 0 || pid == 0) continue;
 
-    if (h->pub_health.last_publish_ns == 0) {
-        free(h);
-        return 0; // Never published, technically not a deadlock yet
+        /* Re-read the claim: if it moved, the writer is making progress */
+        uint64_t claim = atomic_load_explicit(&w->claim_seq, memory_order_acquire);
+        uint64_t claim_ns = atomic_load_explicit(&w->claim_ns, memory_order_relaxed);
+        if (claim && atomic_load_explicit(&w->claim_seq, memory_order_relaxed) != claim) claim = 0;
+        uint64_t claim_age = (claim && now > claim_ns) ? now - claim_ns : 0;
+
+        uint64_t age = 0;
+        uint32_t state = 0;
+        if (pid_dead(pid)) {
+            state = USRL_LIVE_DEAD;
+            age = claim_age;
+        } else if (claim && claim_age > claim_bound_ns) {
+            state = USRL_LIVE_CLAIM_STALL;
+            age = claim_age;
+        } else if (beat_overdue(&w->hb, now, &age)) {
+            state = USRL_LIVE_STALLED;
+        }
+        if (state) {
+            live_add(out, cap, n, t, state, USRL_ROLE_WRITER, i, pid, (uint16_t)(owner - 1),
+                     claim, age);
+            n++;
+        }
     }
 
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)base + t->readers_offset);
+    for (uint32_t i = 0; i < USRL_MAX_READERS; i++) {
+        UsrlReaderEntry *e = &rt->entries[i];
+        uint32_t pid = e->pid;
+        if (atomic_load_explicit(&e->owner, memory_order_relaxed) == 0 || pid == 0) continue;
+
+        uint64_t age = 0;
+        uint32_t state = 0;
+        if (pid_dead(pid)) state = USRL_LIVE_DEAD;
+        else if (beat_overdue(&e->hb, now, &age)) state = USRL_LIVE_STALLED;
+        if (state) {
+            live_add(out, cap, n, t, state, USRL_ROLE_READER, i, pid, 0,
+                     atomic_load_explicit(&e->cursor, memory_order_relaxed), age);
+            n++;
+        }
+    }
+    return n;
+}
+
+int usrl_health_liveness(void *base, uint64_t claim_ms, UsrlLiveness *out, uint32_t cap)
+{
+    if (!base || (!out && cap > 0)) return -1;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC || hdr->version != USRL_LAYOUT_VERSION) return -1;
+
+    TopicEntry *topics = (TopicEntry *)((uint8_t *)base + hdr->topic_table_offset);
+    uint32_t count = atomic_load_explicit(&hdr->topic_count, memory_order_acquire);
     uint64_t now = usrl_now_ns();
-    uint64_t delta = now - h->pub_health.last_publish_ns;
-    uint64_t timeout_ns = timeout_ms * 1000000ULL;
 
-    int res = (delta > timeout_ns);
-    free(h);
-    return res;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++)
+        n = topic_liveness(base, &topics[i], now, claim_ms * 1000000ULL, out, cap, n);
+    return (int)n;
 }
 
-int usrl_health_export_json(void *base, const char *topic, char *buf, uint32_t max_len)
+/* =============================================================================
+ * MISSING HELPERS (Restored for Linker)
+ * ============================================================================= */
+
+int usrl_health_check_lag(void *base, const char *topic, uint64_t lag_threshold_slots)
+{
+    RingHealth h;
+    if (usrl_health_fill(base, topic, &h) != 0) return -1;
+
+    return (h.sub_health.lag_slots > lag_threshold_slots);
+}
+
+int usrl_health_detect_deadlock(void *base, const char *topic, uint64_t timeout_ms)
 {
-    RingHealth *h = usrl_health_get(base, topic);
-    if (!h) return -1;
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t) return -1;
 
+    UsrlLiveness l[USRL_MAX_WRITERS + USRL_MAX_READERS];
+    uint32_t n = topic_liveness(base, t, usrl_now_ns(), timeout_ms * 1000000ULL, l,
+                                sizeof(l) / sizeof(l[0]), 0);
+    for (uint32_t i = 0; i < n; i++) {
+        if (l[i].state == USRL_LIVE_CLAIM_STALL) return 1;
+        if (l[i].state == USRL_LIVE_DEAD && l[i].role == USRL_ROLE_WRITER && l[i].seq) return 1;
+    }
+    return 0;
+}
+
+/* One topic as a JSON object; returns bytes written or -1 if it does not fit */
+static int health_json(const RingHealth *h, char *buf, uint32_t max_len)
+{
     int written = snprintf(buf, max_len,
-        "{\"topic\":\"%s\",\"published\":%lu,\"last_pub_ns\":%lu}",
+        "{\"topic\":\"%s\",\"published\":%lu,\"last_pub_ns\":%lu,"
+        "\"publish_rate_hz\":%lu,\"dropped\":%lu,\"read\":%lu,\"skipped\":%lu,"
+        "\"subscribe_rate_hz\":%lu,\"lag\":%lu,\"max_lag\":%lu}",
         h->topic_name,
         h->pub_health.total_published,
-        h->pub_health.last_publish_ns);
+        h->pub_health.last_publish_ns,
+        h->pub_health.publish_rate_hz,
+        h->pub_health.total_dropped,
+        h->sub_health.total_read,
+        h->sub_health.total_skipped,
+        h->sub_health.subscribe_rate_hz,
+        h->sub_health.lag_slots,
+        h->sub_health.max_lag_observed);
 
-    free(h);
     return (written > 0 && written < (int)max_len) ? written : -1;
 }
+
+int usrl_health_export_json(void *base, const char *topic, char *buf, uint32_t max_len)
+{
+    RingHealth h;
+    if (!buf || usrl_health_fill(base, topic, &h) != 0) return -1;
+    return health_json(&h, buf, max_len);
+}
+
+int usrl_health_export_json_all(void *base, char *buf, uint32_t max_len)
+{
+    if (!base || !buf || max_len < 3) return -1;
+
+    CoreHeader *hdr = (CoreHeader *)base;
+    if (hdr->magic != USRL_MAGIC || hdr->version != USRL_LAYOUT_VERSION) return -1;
+
+    TopicEntry *topics = (TopicEntry *)((uint8_t *)base + hdr->topic_table_offset);
+    uint32_t count = atomic_load_explicit(&hdr->topic_count, memory_order_acquire);
+    uint64_t now = usrl_now_ns();
+
+    uint32_t pos = 0;
+    buf[pos++] = '[';
+    for (uint32_t i = 0; i < count; i++) {
+        RingHealth h;
+        health_fill(base, &topics[i], &h, now);
+
+        if (i > 0) {
+            if (pos + 1 >= max_len) return -1;
+            buf[pos++] = ',';
+        }
+        int n = health_json(&h, buf + pos, max_len - pos);
+        if (n < 0) return -1;
+        pos += (uint32_t)n;
+    }
+    if (pos + 2 > max_len) return -1;
+    buf[pos++] = ']';
+    buf[pos] = '\0';
+    return (int)pos;
+}
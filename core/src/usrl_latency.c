@@ -0,0 +1,69 @@
+/**
+ * @file usrl_latency.c
+ * @brief Latency histogram queries.
+ */
+
+#include "usrl_latency.h"
+
+uint64_t usrl_latency_bucket_max(uint32_t idx)
+{
+    if (idx < USRL_LAT_SUB) return idx;
+    uint32_t e = idx / USRL_LAT_SUB + USRL_LAT_SUB_BITS - 1;
+    uint64_t sub = idx % USRL_LAT_SUB;
+    uint64_t width = 1ULL << (e - USRL_LAT_SUB_BITS);
+    return ((USRL_LAT_SUB + sub) << (e - USRL_LAT_SUB_BITS)) + width - 1;
+}
+
+uint64_t usrl_latency_percentile(const UsrlLatencyHist *h, double q)
+{
+    if (!h) return 0;
+
+    /* Total from the buckets themselves so a concurrent record cannot skew it */
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < USRL_LAT_BUCKETS; i++)
+        total += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+    if (total == 0) return 0;
+
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+    double want = q * (double)total;
+    uint64_t rank = (uint64_t)want;
+    if ((double)rank < want || rank == 0) rank++;
+
+    uint64_t max_ns = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < USRL_LAT_BUCKETS; i++) {
+        seen += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t v = usrl_latency_bucket_max(i);
+            return (max_ns && v > max_ns) ? max_ns : v;
+        }
+    }
+    return max_ns;
+}
+
+void usrl_latency_summary(const UsrlLatencyHist *h, UsrlLatencySummary *out)
+{
+    if (!out) return;
+    out->count = h ? atomic_load_explicit(&h->count, memory_order_relaxed) : 0;
+    if (out->count == 0) {
+        out->mean_ns = out->p50_ns = out->p90_ns = out->p99_ns = out->p999_ns = out->max_ns = 0;
+        return;
+    }
+    out->mean_ns = atomic_load_explicit(&h->sum_ns, memory_order_relaxed) / out->count;
+    out->p50_ns = usrl_latency_percentile(h, 0.50);
+    out->p90_ns = usrl_latency_percentile(h, 0.90);
+    out->p99_ns = usrl_latency_percentile(h, 0.99);
+    out->p999_ns = usrl_latency_percentile(h, 0.999);
+    out->max_ns = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+}
+
+void usrl_latency_reset(UsrlLatencyHist *h)
+{
+    if (!h) return;
+    for (uint32_t i = 0; i < USRL_LAT_BUCKETS; i++)
+        atomic_store_explicit(&h->buckets[i], 0, memory_order_relaxed);
+    atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->sum_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->max_ns, 0, memory_order_relaxed);
+}
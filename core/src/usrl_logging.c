@@ -1,19 +1,44 @@
 /**
  * @file usrl_logging.c
  * @brief Thread-safe logging implementation
+ *
+ * Two backends:
+ *   - synchronous (usrl_logging_init): format, then write under a mutex.
+ *   - asynchronous (usrl_logging_init_async): each thread formats into its
+ *     own SPSC byte ring; a flusher thread merges the rings by timestamp and
+ *     does all file I/O. A producer never locks or blocks: when its ring is
+ *     full the record is dropped and counted.
+ *
+ * USRL_BLOG records (deferred formatting) carry a call-site id and raw
+ * argument bytes. The flusher either renders them into the text file or,
+ * with usrl_logging_init_binary, writes them out as frames for
+ * usrl-logdecode; frames can also be published to a USRL topic.
  */
 
 #include "usrl_logging.h"
+#include "usrl_ring.h"
+#include "usrl_trace.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <time.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <inttypes.h>   /* PRIu64, PRId64 */
+#include <ctype.h>
+#include <unistd.h>
+
+#define USRL_LOG_LINE_MAX  1024u                /* longest record text */
+#define USRL_LOG_ALIGN     16u                  /* record alignment in a ring */
+#define USRL_LOG_PERIOD_NS (2ULL * 1000000ULL)  /* flusher wake-up period */
+#define USRL_LOG_BUF_MIN   (4u * USRL_LOG_LINE_MAX)
+#define USRL_LOG_METRIC    0xFFu                /* record level for usrl_log_metric */
+#define USRL_LOG_MAX_SITES 8192u                /* USRL_BLOG call sites per process */
+#define USRL_LOG_DEF_NS    1000000000ULL        /* site re-announce period on a topic */
 
 static FILE *log_file = NULL;
-static FILE *trace_file = NULL;
-static UsrlLogLevel min_log_level = USRL_LOG_INFO;
+UsrlLogLevel usrl_log_min_level = USRL_LOG_INFO;
 
 static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -24,7 +49,7 @@ static inline uint64_t usrl_now_ns(void)
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-static const char *level_str(UsrlLogLevel level)
+static const char *level_str(unsigned level)
 {
     switch (level) {
         case USRL_LOG_ERROR: return "ERROR";
@@ -32,13 +57,677 @@ static const char *level_str(UsrlLogLevel level)
         case USRL_LOG_INFO:  return "INFO";
         case USRL_LOG_DEBUG: return "DEBUG";
         case USRL_LOG_TRACE: return "TRACE";
+        case USRL_LOG_METRIC: return "METRIC";
         default: return "UNKNOWN";
     }
 }
 
+static void write_line(FILE *f, uint64_t ts, unsigned level, const char *text, uint32_t len)
+{
+    fprintf(f, "[%" PRIu64 ".%03" PRIu64 "] [%s] %.*s\n",
+            (uint64_t)(ts / 1000000000ULL), (uint64_t)((ts % 1000000000ULL) / 1000000ULL),
+            level_str(level), (int)len, text);
+}
+
+/* "[module:line] message" (or just the message without a module) */
+static uint32_t format_text(char *dst, const char *module, uint32_t line,
+                            const char *fmt, va_list ap)
+{
+    int n = 0;
+    if (module) n = snprintf(dst, USRL_LOG_LINE_MAX, "[%s:%u] ", module, line);
+    if (n < 0) n = 0;
+    if ((uint32_t)n >= USRL_LOG_LINE_MAX) return USRL_LOG_LINE_MAX - 1;
+
+    int m = vsnprintf(dst + n, USRL_LOG_LINE_MAX - (uint32_t)n, fmt, ap);
+    if (m < 0) m = 0;
+    uint32_t len = (uint32_t)n + (uint32_t)m;
+    return len < USRL_LOG_LINE_MAX ? len : USRL_LOG_LINE_MAX - 1;
+}
+
+/* =============================================================================
+ * CALL SITES AND DEFERRED FORMATTING
+ * ============================================================================= */
+
+static UsrlLogSite *g_sites[USRL_LOG_MAX_SITES];
+static atomic_uint g_site_next = 0;
+
+/* Id of a USRL_BLOG site, registering it on first use; 0 once the table is full */
+static uint32_t site_id(UsrlLogSite *site)
+{
+    uint32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (__builtin_expect(id != 0, 1)) return id;
+
+    /* Racing threads each take an id; the loser's stays unused */
+    uint32_t cand = atomic_fetch_add_explicit(&g_site_next, 1, memory_order_relaxed) + 1;
+    if (cand >= USRL_LOG_MAX_SITES) return 0;
+    __atomic_store_n(&g_sites[cand], site, __ATOMIC_RELEASE);
+    if (__atomic_compare_exchange_n(&site->id, &id, cand, false, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_ACQUIRE))
+        return cand;
+    return id;
+}
+
+static const UsrlLogSite *site_get(uint32_t id)
+{
+    if (id == 0 || id >= USRL_LOG_MAX_SITES) return NULL;
+    return __atomic_load_n(&g_sites[id], __ATOMIC_ACQUIRE);
+}
+
+static inline uint64_t rd64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*
+ * Argument bytes of a USRL_BLOG record: 8 per value, strings as a u16 length
+ * and the bytes, cut so the record fits USRL_LOG_LINE_MAX. Returns the size,
+ * filling the string lengths to copy.
+ */
+static uint32_t blog_size(const UsrlLogSite *site, const UsrlLogArg *args, uint16_t *slen)
+{
+    uint32_t size = sizeof(uint32_t);
+    for (uint32_t i = 0; i < site->nargs; i++) {
+        if (site->types[i] != 's') {
+            size += 8;
+            continue;
+        }
+        size_t n = strnlen(args[i].s ? args[i].s : "(null)", USRL_BLOG_STR_MAX);
+        uint32_t room = USRL_LOG_LINE_MAX - size - 2 - 8 * (site->nargs - i - 1);
+        slen[i] = (uint16_t)(n < room ? n : room);
+        size += 2 + slen[i];
+    }
+    return size;
+}
+
+static void blog_encode(uint8_t *dst, uint32_t id, const UsrlLogSite *site,
+                        const UsrlLogArg *args, const uint16_t *slen)
+{
+    memcpy(dst, &id, sizeof(id));
+    dst += sizeof(id);
+    for (uint32_t i = 0; i < site->nargs; i++) {
+        if (site->types[i] != 's') {
+            memcpy(dst, &args[i], 8);
+            dst += 8;
+            continue;
+        }
+        memcpy(dst, &slen[i], 2);
+        memcpy(dst + 2, args[i].s ? args[i].s : "(null)", slen[i]);
+        dst += 2 + slen[i];
+    }
+}
+
+static void render_put(char *out, uint32_t cap, uint32_t *n, const char *spec, ...)
+{
+    va_list ap;
+    va_start(ap, spec);
+    int m = vsnprintf(out + *n, cap - *n, spec, ap);
+    va_end(ap);
+    if (m > 0) *n = (*n + (uint32_t)m < cap) ? *n + (uint32_t)m : cap - 1;
+}
+
+uint32_t usrl_log_render(const char *fmt, const char *types, uint32_t nargs,
+                         const void *args, uint32_t args_len, char *out, uint32_t cap)
+{
+    const uint8_t *p = (const uint8_t *)args;
+    const uint8_t *end = p + args_len;
+    uint32_t n = 0, k = 0;
+    if (cap == 0) return 0;
+
+    while (*fmt && n + 1 < cap) {
+        if (*fmt != '%') {
+            out[n++] = *fmt++;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            out[n++] = '%';
+            fmt += 2;
+            continue;
+        }
+
+        /* Keep flags, width and precision; the length comes from the type */
+        const char *start = fmt++;
+        char spec[24] = "%";
+        uint32_t sl = 1;
+        while (*fmt && (strchr("-+ #0", *fmt) || isdigit((unsigned char)*fmt) || *fmt == '.')) {
+            if (sl < sizeof(spec) - 4) spec[sl++] = *fmt;
+            fmt++;
+        }
+        while (*fmt && strchr("hlLqjzt", *fmt)) fmt++;
+        char conv = *fmt;
+        if (!conv) break;
+        fmt++;
+
+        if (!strchr("diouxXcfFeEgGaAsp", conv)) {
+            render_put(out, cap, &n, "%.*s", (int)(fmt - start), start);
+            continue;
+        }
+
+        char t = k < nargs ? types[k] : 0;
+        UsrlLogArg v = {0};
+        char str[USRL_BLOG_STR_MAX + 1];
+        if (t == 's' && end - p >= 2) {
+            uint16_t len;
+            memcpy(&len, p, 2);
+            p += 2;
+            if (len > end - p) len = (uint16_t)(end - p);
+            memcpy(str, p, len);
+            str[len] = '\0';
+            p += len;
+        } else if (t && t != 's' && end - p >= 8) {
+            memcpy(&v, p, 8);
+            p += 8;
+        } else {
+            t = 0;
+        }
+        k++;
+
+        if (!t) {
+            render_put(out, cap, &n, "%.*s", (int)(fmt - start), start);
+            continue;
+        }
+
+        if (t == 's' || conv == 's') {
+            if (t == 'd') snprintf(str, sizeof(str), "%g", v.d);
+            else if (t == 'i') snprintf(str, sizeof(str), "%lld", (long long)v.i);
+            else if (t == 'u') snprintf(str, sizeof(str), "%llu", (unsigned long long)v.u);
+            else if (t == 'p') snprintf(str, sizeof(str), "%p", v.p);
+            spec[sl++] = 's';
+            spec[sl] = '\0';
+            render_put(out, cap, &n, spec, str);
+        } else if (strchr("fFeEgGaA", conv)) {
+            spec[sl++] = conv;
+            spec[sl] = '\0';
+            render_put(out, cap, &n, spec,
+                       t == 'd' ? v.d : t == 'i' ? (double)v.i : (double)v.u);
+        } else if (conv == 'p') {
+            spec[sl++] = 'p';
+            spec[sl] = '\0';
+            render_put(out, cap, &n, spec, (void *)(uintptr_t)v.u);
+        } else if (conv == 'c') {
+            spec[sl++] = 'c';
+            spec[sl] = '\0';
+            render_put(out, cap, &n, spec, (int)(t == 'd' ? (int64_t)v.d : v.i));
+        } else {
+            spec[sl++] = 'l';
+            spec[sl++] = 'l';
+            spec[sl++] = conv;
+            spec[sl] = '\0';
+            long long iv = t == 'd' ? (long long)v.d : (long long)v.i;
+            render_put(out, cap, &n, spec, iv);
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/* "[module:line] message" of an encoded USRL_BLOG record */
+static uint32_t blog_text(char *dst, const UsrlLogSite *site, const uint8_t *args, uint32_t len)
+{
+    int n = snprintf(dst, USRL_LOG_LINE_MAX, "[%s:%u] ", site->module, site->line);
+    if (n < 0) n = 0;
+    if ((uint32_t)n >= USRL_LOG_LINE_MAX) return USRL_LOG_LINE_MAX - 1;
+    return (uint32_t)n + usrl_log_render(site->fmt, site->types, site->nargs, args, len,
+                                         dst + n, USRL_LOG_LINE_MAX - (uint32_t)n);
+}
+
+/* =============================================================================
+ * ASYNC BACKEND
+ * ============================================================================= */
+
+enum { REC_PAD = 0, REC_TEXT, REC_BIN };
+
+typedef struct {
+    uint32_t len;   /* header + body before alignment; pad: bytes to skip */
+    uint16_t level;
+    uint16_t kind;  /* REC_* */
+    uint64_t ts;
+} LogRec;
+
+/* One per logging thread; producer and flusher fields on separate lines */
+typedef struct LogBuf {
+    _Alignas(64) atomic_uint_fast64_t head; /* producer: bytes committed */
+    uint64_t tail_cache;                    /* producer's view of tail */
+    atomic_uint_fast64_t dropped;           /* records refused, ring full */
+    _Alignas(64) atomic_uint_fast64_t tail; /* flusher: bytes consumed */
+    uint64_t dropped_seen;
+    atomic_int owned;                       /* a live thread logs here */
+    uint32_t size;                          /* power of two */
+    uint8_t *data;
+    struct LogBuf *next;
+} LogBuf;
+
+static _Atomic(LogBuf *) g_bufs = NULL;     /* never shrinks; freed buffers are reused */
+static atomic_bool g_async = false;
+static uint32_t g_buf_bytes = 256u * 1024u;
+
+static pthread_t g_flusher;
+static bool g_flusher_running = false;
+static pthread_mutex_t g_flush_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_flush_cv = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_flush_done_cv = PTHREAD_COND_INITIALIZER;
+static uint64_t g_flush_req = 0;
+static uint64_t g_flush_done = 0;
+static bool g_flush_stop = false;
+
+static pthread_key_t g_buf_key;
+static pthread_once_t g_buf_key_once = PTHREAD_ONCE_INIT;
+static __thread LogBuf *tl_buf = NULL;
+
+static inline uint32_t rec_space(uint32_t len)
+{
+    return (len + USRL_LOG_ALIGN - 1) & ~(USRL_LOG_ALIGN - 1);
+}
+
+/* Thread exit: hand the ring back; the flusher still drains what is left */
+static void buf_release(void *p)
+{
+    LogBuf *b = (LogBuf *)p;
+    if (b) atomic_store_explicit(&b->owned, 0, memory_order_release);
+}
+
+static void buf_key_create(void)
+{
+    pthread_key_create(&g_buf_key, buf_release);
+}
+
+static uint32_t pow2_at_least(uint32_t v)
+{
+    uint32_t p = USRL_LOG_BUF_MIN;
+    while (p < v && p < (1u << 30)) p <<= 1;
+    return p;
+}
+
+/*
+ * Slow path, once per thread: reuse a ring a finished thread left once the
+ * flusher has emptied it, or add one. A ring still holding the old thread's
+ * records would leave the new thread dropping until the next flush.
+ */
+static LogBuf *buf_acquire(void)
+{
+    for (LogBuf *b = atomic_load_explicit(&g_bufs, memory_order_acquire); b; b = b->next) {
+        int expected = 0;
+        if (atomic_load_explicit(&b->owned, memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_strong_explicit(&b->owned, &expected, 1,
+                                                    memory_order_acquire,
+                                                    memory_order_relaxed)) {
+            b->tail_cache = atomic_load_explicit(&b->tail, memory_order_acquire);
+            if (b->tail_cache != atomic_load_explicit(&b->head, memory_order_relaxed)) {
+                atomic_store_explicit(&b->owned, 0, memory_order_release);
+                continue;
+            }
+            tl_buf = b;
+            pthread_setspecific(g_buf_key, b);
+            return b;
+        }
+    }
+
+    LogBuf *b = aligned_alloc(64, sizeof(LogBuf));
+    if (!b) return NULL;
+    memset(b, 0, sizeof(*b));
+    b->size = pow2_at_least(g_buf_bytes);
+    b->data = malloc(b->size);
+    if (!b->data) {
+        free(b);
+        return NULL;
+    }
+    atomic_store_explicit(&b->owned, 1, memory_order_relaxed);
+
+    LogBuf *old = atomic_load_explicit(&g_bufs, memory_order_relaxed);
+    do {
+        b->next = old;
+    } while (!atomic_compare_exchange_weak_explicit(&g_bufs, &old, b, memory_order_release,
+                                                    memory_order_relaxed));
+    tl_buf = b;
+    pthread_setspecific(g_buf_key, b);
+    return b;
+}
+
+/*
+ * Reserve a contiguous worst-case record at the producer's head, padding
+ * over the end of the ring if needed. NULL when the ring is full.
+ */
+static LogRec *buf_reserve(LogBuf *b, uint32_t body, uint64_t *head_out)
+{
+    const uint32_t need = rec_space((uint32_t)sizeof(LogRec) + body);
+    uint64_t head = atomic_load_explicit(&b->head, memory_order_relaxed);
+    uint32_t pos = (uint32_t)(head & (b->size - 1));
+    uint32_t pad = (b->size - pos < need) ? b->size - pos : 0;
+
+    if (head + pad + need - b->tail_cache > b->size) {
+        b->tail_cache = atomic_load_explicit(&b->tail, memory_order_acquire);
+        if (head + pad + need - b->tail_cache > b->size) return NULL;
+    }
+
+    if (pad) {
+        LogRec *r = (LogRec *)(b->data + pos);
+        r->len = pad;
+        r->kind = REC_PAD;
+        head += pad;
+        pos = 0;
+    }
+    *head_out = head;
+    return (LogRec *)(b->data + pos);
+}
+
+/* The calling thread's ring with room for `body` bytes, or NULL (counted as dropped) */
+static LogRec *async_reserve(uint32_t body, LogBuf **bp, uint64_t *head)
+{
+    LogBuf *b = tl_buf;
+    if (__builtin_expect(!b, 0)) b = buf_acquire();
+    if (!b) return NULL;
+
+    LogRec *r = buf_reserve(b, body, head);
+    if (!r) {
+        atomic_store_explicit(&b->dropped,
+                              atomic_load_explicit(&b->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return NULL;
+    }
+    *bp = b;
+    return r;
+}
+
+static inline void async_commit(LogBuf *b, uint64_t head, LogRec *r, unsigned level,
+                                unsigned kind, uint32_t body)
+{
+    r->ts = usrl_now_ns();
+    r->level = (uint16_t)level;
+    r->kind = (uint16_t)kind;
+    r->len = (uint32_t)sizeof(LogRec) + body;
+    atomic_store_explicit(&b->head, head + rec_space(r->len), memory_order_release);
+}
+
+static void async_vrecord(unsigned level, const char *module, uint32_t line,
+                          const char *fmt, va_list ap)
+{
+    LogBuf *b;
+    uint64_t head;
+    LogRec *r = async_reserve(USRL_LOG_LINE_MAX, &b, &head);
+    if (!r) return;
+
+    uint32_t len = format_text((char *)(r + 1), module, line, fmt, ap);
+    async_commit(b, head, r, level, REC_TEXT, len);
+}
+
+/* Next real record of a ring below `limit`, skipping wrap padding */
+static LogRec *buf_peek(LogBuf *b, uint64_t limit)
+{
+    uint64_t tail = atomic_load_explicit(&b->tail, memory_order_relaxed);
+    while (tail < limit) {
+        LogRec *r = (LogRec *)(b->data + (tail & (b->size - 1)));
+        if (r->kind != REC_PAD) return r;
+        tail += r->len;
+        atomic_store_explicit(&b->tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+/* -----------------------------------------------------------------------------
+ * Sinks. Only the flusher thread writes frames, so the scratch state is its own.
+ * --------------------------------------------------------------------------- */
+
+enum { OUT_FILE = 1, OUT_TOPIC = 2 };
+
+static bool g_binary = false;                    /* log_file takes frames, not text */
+static atomic_bool g_pub_on = false;
+static UsrlMwmrPublisher g_log_pub;
+static TopicEntry *g_log_topic = NULL;
+static uint64_t g_pub_def_ns = 0;
+static uint32_t g_pid = 0;
+static uint8_t g_def_file[USRL_LOG_MAX_SITES / 8]; /* sites defined in the file this run */
+static uint8_t g_def_topic[USRL_LOG_MAX_SITES / 8];
+
+static void frame_out(unsigned out, unsigned type, unsigned level, uint32_t site, uint64_t ts,
+                      const void *body, uint32_t len)
+{
+    uint8_t buf[USRL_BLOG_FRAME_MAX];
+    UsrlBlogFrame *f = (UsrlBlogFrame *)buf;
+    if (len > USRL_BLOG_FRAME_MAX - sizeof(*f)) len = USRL_BLOG_FRAME_MAX - sizeof(*f);
+    f->len = (uint32_t)sizeof(*f) + len;
+    f->type = (uint16_t)type;
+    f->level = (uint16_t)level;
+    f->pid = g_pid;
+    f->site = site;
+    f->ts = ts;
+    memcpy(buf + sizeof(*f), body, len);
+
+    if ((out & OUT_FILE) && g_binary) fwrite(buf, 1, f->len, log_file);
+    if ((out & OUT_TOPIC) && atomic_load_explicit(&g_pub_on, memory_order_acquire))
+        usrl_mwmr_pub_publish(&g_log_pub, buf, f->len);
+}
+
+/* USRL_BLOG_DEF body; strings are cut to keep the frame in bounds */
+static void def_out(unsigned out, uint32_t id, const UsrlLogSite *site)
+{
+    uint8_t body[USRL_BLOG_FRAME_MAX - sizeof(UsrlBlogFrame)];
+    uint16_t line = (uint16_t)site->line;
+    memcpy(body, &line, 2);
+    body[2] = site->nargs;
+    body[3] = site->level;
+    memcpy(body + 4, site->types, site->nargs);
+    uint32_t n = 4u + site->nargs;
+
+    const char *strs[3] = {site->module, site->file, site->fmt};
+    for (int i = 0; i < 3; i++) {
+        const char *str = strs[i] ? strs[i] : "";
+        size_t room = sizeof(body) - n - (size_t)(3 - i);
+        size_t len = strnlen(str, room);
+        memcpy(body + n, str, len);
+        n += (uint32_t)len;
+        body[n++] = '\0';
+    }
+    frame_out(out, USRL_BLOG_DEF, site->level, id, 0, body, n);
+}
+
+static inline bool def_test_set(uint8_t *map, uint32_t id)
+{
+    bool seen = map[id >> 3] & (1u << (id & 7));
+    map[id >> 3] |= (uint8_t)(1u << (id & 7));
+    return seen;
+}
+
+static void sink_record(FILE *f, const LogRec *r)
+{
+    const uint8_t *body = (const uint8_t *)(r + 1);
+    uint32_t len = r->len - (uint32_t)sizeof(LogRec);
+    bool topic = atomic_load_explicit(&g_pub_on, memory_order_acquire);
+
+    if (r->kind == REC_TEXT) {
+        if (g_binary) frame_out(OUT_FILE, USRL_BLOG_TEXT, r->level, 0, r->ts, body, len);
+        else write_line(f, r->ts, r->level, (const char *)body, len);
+        if (topic) frame_out(OUT_TOPIC, USRL_BLOG_TEXT, r->level, 0, r->ts, body, len);
+        return;
+    }
+
+    uint32_t id;
+    memcpy(&id, body, sizeof(id));
+    const UsrlLogSite *site = site_get(id);
+    if (!site) return;
+
+    if (g_binary) {
+        if (!def_test_set(g_def_file, id)) def_out(OUT_FILE, id, site);
+        frame_out(OUT_FILE, USRL_BLOG_LOG, r->level, id, r->ts, body + 4, len - 4);
+    } else {
+        char text[USRL_LOG_LINE_MAX];
+        uint32_t n = blog_text(text, site, body + 4, len - 4);
+        write_line(f, r->ts, r->level, text, n);
+    }
+    if (topic) {
+        if (!def_test_set(g_def_topic, id)) def_out(OUT_TOPIC, id, site);
+        frame_out(OUT_TOPIC, USRL_BLOG_LOG, r->level, id, r->ts, body + 4, len - 4);
+    }
+}
+
+static void sink_drop(FILE *f, uint64_t count)
+{
+    uint64_t now = usrl_now_ns();
+    if (g_binary) {
+        frame_out(OUT_FILE, USRL_BLOG_DROP, USRL_LOG_WARN, 0, now, &count, sizeof(count));
+    } else {
+        char text[96];
+        int len = snprintf(text, sizeof(text), "[log] thread buffer full, records dropped: %"
+                           PRIu64, count);
+        write_line(f, now, USRL_LOG_WARN, text, (uint32_t)len);
+    }
+    frame_out(OUT_TOPIC, USRL_BLOG_DROP, USRL_LOG_WARN, 0, now, &count, sizeof(count));
+}
+
+/* A decoder that joins the topic late learns the sites in use within a period */
+static void topic_redefine(void)
+{
+    if (!atomic_load_explicit(&g_pub_on, memory_order_acquire)) return;
+    uint64_t now = usrl_now_ns();
+    if (now - g_pub_def_ns < USRL_LOG_DEF_NS) return;
+    g_pub_def_ns = now;
+
+    uint32_t n = atomic_load_explicit(&g_site_next, memory_order_relaxed) + 1;
+    if (n > USRL_LOG_MAX_SITES) n = USRL_LOG_MAX_SITES;
+    for (uint32_t id = 1; id < n; id++) {
+        const UsrlLogSite *site = site_get(id);
+        if (site && (g_def_topic[id >> 3] & (1u << (id & 7)))) def_out(OUT_TOPIC, id, site);
+    }
+}
+
+/* Write what a group of rings has committed, oldest timestamp first */
+static void drain_group(FILE *f, LogBuf **bufs, int n)
+{
+    uint64_t limit[n];
+    for (int i = 0; i < n; i++) limit[i] = atomic_load_explicit(&bufs[i]->head, memory_order_acquire);
+
+    for (;;) {
+        int best = -1;
+        LogRec *best_r = NULL;
+        for (int i = 0; i < n; i++) {
+            LogRec *r = buf_peek(bufs[i], limit[i]);
+            if (r && (!best_r || r->ts < best_r->ts)) {
+                best = i;
+                best_r = r;
+            }
+        }
+        if (best < 0) break;
+
+        sink_record(f, best_r);
+        LogBuf *b = bufs[best];
+        atomic_store_explicit(&b->tail,
+                              atomic_load_explicit(&b->tail, memory_order_relaxed) +
+                                  rec_space(best_r->len),
+                              memory_order_release);
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint64_t d = atomic_load_explicit(&bufs[i]->dropped, memory_order_relaxed);
+        if (d != bufs[i]->dropped_seen) {
+            sink_drop(f, d - bufs[i]->dropped_seen);
+            bufs[i]->dropped_seen = d;
+        }
+    }
+}
+
+/* Threads are merged in groups; only very large thread counts need more than one */
+static void drain_all(FILE *f)
+{
+    enum { MAX_MERGE = 64 };
+    LogBuf *bufs[MAX_MERGE];
+    int n = 0;
+
+    for (LogBuf *b = atomic_load_explicit(&g_bufs, memory_order_acquire); b; b = b->next) {
+        bufs[n++] = b;
+        if (n == MAX_MERGE) {
+            drain_group(f, bufs, n);
+            n = 0;
+        }
+    }
+    if (n) drain_group(f, bufs, n);
+}
+
+static void *flusher_main(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&g_flush_mu);
+    for (;;) {
+        bool stop = g_flush_stop;
+        uint64_t req = g_flush_req;
+        pthread_mutex_unlock(&g_flush_mu);
+
+        drain_all(log_file);
+        topic_redefine();
+        fflush(log_file);
+
+        pthread_mutex_lock(&g_flush_mu);
+        g_flush_done = req;
+        pthread_cond_broadcast(&g_flush_done_cv);
+        if (stop) break;
+        if (g_flush_req == req && !g_flush_stop) {
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += (long)USRL_LOG_PERIOD_NS;
+            if (until.tv_nsec >= 1000000000L) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_flush_cv, &g_flush_mu, &until);
+        }
+    }
+    pthread_mutex_unlock(&g_flush_mu);
+    return NULL;
+}
+
+/*
+ * New records go synchronous before the flusher's last pass. A thread that
+ * saw g_async just before it cleared may still commit to its ring after
+ * that pass, so the rings are drained once more after the join.
+ */
+static void flusher_stop(void)
+{
+    if (!g_flusher_running) return;
+    atomic_store_explicit(&g_async, false, memory_order_seq_cst);
+    pthread_mutex_lock(&g_flush_mu);
+    g_flush_stop = true;
+    pthread_cond_signal(&g_flush_cv);
+    pthread_mutex_unlock(&g_flush_mu);
+    pthread_join(g_flusher, NULL);
+    g_flusher_running = false;
+    g_flush_stop = false;
+
+    drain_all(log_file);
+    fflush(log_file);
+}
+
+/* =============================================================================
+ * FRONT END
+ * ============================================================================= */
+
+static void log_vrecord(unsigned level, const char *module, uint32_t line,
+                        const char *fmt, va_list ap)
+{
+    if (atomic_load_explicit(&g_async, memory_order_relaxed)) {
+        async_vrecord(level, module, line, fmt, ap);
+        return;
+    }
+
+    char text[USRL_LOG_LINE_MAX];
+    uint64_t now = usrl_now_ns();
+    uint32_t len = format_text(text, module, line, fmt, ap);
+
+    pthread_mutex_lock(&log_lock);
+    if (log_file) write_line(log_file, now, level, text, len);
+    pthread_mutex_unlock(&log_lock);
+}
+
+static void log_record(unsigned level, const char *module, uint32_t line, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    log_vrecord(level, module, line, fmt, ap);
+    va_end(ap);
+}
+
 int usrl_logging_init(const char *log_file_path, UsrlLogLevel min_level)
 {
-    min_log_level = min_level;
+    usrl_logging_shutdown();
+    usrl_log_min_level = min_level;
 
     if (log_file_path) {
         log_file = fopen(log_file_path, "a");
@@ -51,53 +740,112 @@ int usrl_logging_init(const char *log_file_path, UsrlLogLevel min_level)
     return 0;
 }
 
+static int start_async(const char *log_file_path, UsrlLogLevel min_level,
+                       uint32_t thread_buf_bytes, bool binary)
+{
+    if (usrl_logging_init(log_file_path, min_level) != 0) return -1;
+
+    /* The flusher writes in batches; it flushes the stream after each pass */
+    if (log_file != stderr) setvbuf(log_file, NULL, _IOFBF, 64 * 1024);
+    if (thread_buf_bytes) g_buf_bytes = thread_buf_bytes;
+    pthread_once(&g_buf_key_once, buf_key_create);
+
+    g_binary = binary;
+    g_pid = (uint32_t)getpid();
+    memset(g_def_file, 0, sizeof(g_def_file));
+    if (binary && ftell(log_file) == 0) {
+        UsrlBlogFileHeader fh = {USRL_BLOG_MAGIC, USRL_BLOG_VERSION};
+        fwrite(&fh, sizeof(fh), 1, log_file);
+    }
+
+    if (pthread_create(&g_flusher, NULL, flusher_main, NULL) != 0) {
+        if (!binary) return 0; /* stays sync */
+        usrl_logging_shutdown();
+        return -1;
+    }
+    g_flusher_running = true;
+    atomic_store_explicit(&g_async, true, memory_order_release);
+    return 0;
+}
+
+int usrl_logging_init_async(const char *log_file_path, UsrlLogLevel min_level,
+                            uint32_t thread_buf_bytes)
+{
+    return start_async(log_file_path, min_level, thread_buf_bytes, false);
+}
+
+int usrl_logging_init_binary(const char *bin_file, UsrlLogLevel min_level,
+                             uint32_t thread_buf_bytes)
+{
+    if (!bin_file) return -1;
+    return start_async(bin_file, min_level, thread_buf_bytes, true);
+}
+
+int usrl_logging_publish(void *core_base, const char *topic)
+{
+    if (!g_flusher_running || !core_base || !topic) return -1;
+    if (atomic_load_explicit(&g_pub_on, memory_order_acquire)) return -1;
+
+    TopicEntry *t = usrl_get_topic(core_base, topic);
+    if (!t || t->type != USRL_RING_TYPE_MWMR ||
+        t->slot_size < sizeof(SlotHeader) + USRL_BLOG_FRAME_MAX)
+        return -1;
+
+    memset(&g_log_pub, 0, sizeof(g_log_pub));
+    usrl_mwmr_pub_init(&g_log_pub, core_base, topic, usrl_core_pub_id(core_base));
+    if (!g_log_pub.desc) return -1;
+    g_log_topic = t;
+    memset(g_def_topic, 0, sizeof(g_def_topic));
+    g_pub_def_ns = usrl_now_ns();
+    atomic_store_explicit(&g_pub_on, true, memory_order_release);
+    return 0;
+}
+
+void usrl_blog(UsrlLogSite *site, const UsrlLogArg *args)
+{
+    if (!log_file) return;
+
+    uint32_t id = site_id(site);
+    uint16_t slen[USRL_BLOG_MAX_ARGS];
+    uint32_t size = blog_size(site, args, slen);
+
+    if (id && atomic_load_explicit(&g_async, memory_order_relaxed)) {
+        LogBuf *b;
+        uint64_t head;
+        LogRec *r = async_reserve(size, &b, &head);
+        if (!r) return;
+        blog_encode((uint8_t *)(r + 1), id, site, args, slen);
+        async_commit(b, head, r, site->level, REC_BIN, size);
+        return;
+    }
+
+    /* Synchronous backend (or no site id left): format now */
+    uint8_t rec[USRL_LOG_LINE_MAX];
+    char text[USRL_LOG_LINE_MAX];
+    blog_encode(rec, id, site, args, slen);
+    uint32_t len = blog_text(text, site, rec + 4, size - 4);
+    log_record(site->level, NULL, 0, "%.*s", (int)len, text);
+}
+
 void usrl_log(UsrlLogLevel level, const char *module, uint32_t line,
               const char *fmt, ...)
 {
-    if (level > min_log_level || !log_file) return;
-
-    uint64_t now = usrl_now_ns();
-    char buf[1024];
-    char final_log[2048];
+    if (level > usrl_log_min_level || !log_file) return;
 
     va_list args;
     va_start(args, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, args);
+    log_vrecord(level, module, line, fmt, args);
     va_end(args);
-
-    uint64_t sec = now / 1000000000ULL;
-    uint64_t ms  = (now % 1000000000ULL) / 1000000ULL;
-
-    snprintf(final_log, sizeof(final_log),
-             "[%" PRIu64 ".%03" PRIu64 "] [%s] [%s:%u] %s\n",
-             sec,
-             ms,
-             level_str(level),
-             module,
-             line,
-             buf);
-
-    pthread_mutex_lock(&log_lock);
-    fputs(final_log, log_file);
-    pthread_mutex_unlock(&log_lock);
 }
 
 void usrl_log_metric(const char *module, const char *metric_name, int64_t value)
 {
     if (!log_file) return;
 
-    uint64_t now = usrl_now_ns();
-    uint64_t sec = now / 1000000000ULL;
-    uint64_t ms  = (now % 1000000000ULL) / 1000000ULL;
-
-    pthread_mutex_lock(&log_lock);
-    fprintf(log_file,
-            "[%" PRIu64 ".%03" PRIu64 "] [METRIC] [%s] %s=%" PRId64 "\n",
-            sec, ms,
-            module ? module : "unknown",
-            metric_name ? metric_name : "unknown",
-            (int64_t)value);
-    pthread_mutex_unlock(&log_lock);
+    log_record(USRL_LOG_METRIC, NULL, 0, "[%s] %s=%" PRId64,
+               module ? module : "unknown",
+               metric_name ? metric_name : "unknown",
+               value);
 }
 
 void usrl_log_lag(const char *topic, uint64_t lag_slots, uint64_t threshold)
@@ -119,29 +867,42 @@ void usrl_log_drop(const char *topic, uint32_t drop_count)
 
 void usrl_log_flush(void)
 {
-    if (log_file && log_file != stderr)
-        fflush(log_file);
+    if (!g_flusher_running) {
+        if (log_file && log_file != stderr) fflush(log_file);
+        return;
+    }
+
+    pthread_mutex_lock(&g_flush_mu);
+    uint64_t my = ++g_flush_req;
+    pthread_cond_signal(&g_flush_cv);
+    while (g_flush_done < my) pthread_cond_wait(&g_flush_done_cv, &g_flush_mu);
+    pthread_mutex_unlock(&g_flush_mu);
 }
 
 void usrl_logging_shutdown(void)
 {
+    flusher_stop(); /* drains every ring first */
+
+    if (atomic_load_explicit(&g_pub_on, memory_order_acquire)) {
+        atomic_store_explicit(&g_pub_on, false, memory_order_release);
+        if (g_log_pub.writer)
+            usrl_writer_detach(g_log_pub.core_base, g_log_topic, g_log_pub.writer);
+    }
+    g_binary = false;
+
     if (log_file && log_file != stderr) {
         fclose(log_file);
         log_file = NULL;
     }
 }
 
-/* Tracing */
-static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Tracing: the shared trace rings (usrl_trace.h), exported as Chrome JSON on shutdown */
+static char trace_path[256];
 
 int usrl_tracing_init(const char *trace_file_path)
 {
-    trace_file = fopen(trace_file_path, "w");
-    if (!trace_file) return -1;
-
-    fprintf(trace_file,
-            "timestamp_ns,duration_ns,event_name,publisher,sequence,payload_size\n");
-    setvbuf(trace_file, NULL, _IOLBF, 8192);
+    if (!trace_file_path || usrl_trace_open(NULL, 0, 0) != 0) return -1;
+    snprintf(trace_path, sizeof(trace_path), "%s", trace_file_path);
     return 0;
 }
 
@@ -149,32 +910,27 @@ void usrl_trace_event(const char *event_name, const char *publisher,
                       uint64_t sequence, uint32_t payload_size,
                       uint64_t duration_ns)
 {
-    if (!trace_file) return;
+    if (!usrl_tracing()) return;
 
+    char name[USRL_TRACE_NAME_MAX];
+    snprintf(name, sizeof(name), "%s [%s]", event_name ? event_name : "unknown",
+             publisher ? publisher : "unknown");
     uint64_t now = usrl_now_ns();
-
-    pthread_mutex_lock(&trace_lock);
-    fprintf(trace_file,
-            "%" PRIu64 ",%" PRIu64 ",%s,%s,%" PRIu64 ",%u\n",
-            now,
-            duration_ns,
-            event_name ? event_name : "unknown",
-            publisher ? publisher : "unknown",
-            sequence,
-            payload_size);
-    pthread_mutex_unlock(&trace_lock);
+    usrl_trace_rec(USRL_TRACE_USER, usrl_trace_topic(name), sequence, 0, now - duration_ns, now,
+                   payload_size);
 }
 
 void usrl_trace_summary(void)
 {
-    if (!trace_file) return;
-    fprintf(stderr, "Trace data written to trace file\n");
+    if (!trace_path[0]) return;
+    fprintf(stderr, "Trace records in " USRL_TRACE_SHM ", exported to %s on shutdown\n",
+            trace_path);
 }
 
 void usrl_tracing_shutdown(void)
 {
-    if (trace_file) {
-        fclose(trace_file);
-        trace_file = NULL;
-    }
+    if (!trace_path[0]) return;
+    usrl_trace_close();
+    usrl_trace_export_chrome(NULL, trace_path);
+    trace_path[0] = '\0';
 }
@@ -1,6 +1,8 @@
 #include "usrl_schema.h"
+#include "usrl_core.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
 
 static uint32_t usrl_schema_hash(const char *str)
 {
@@ -47,6 +49,11 @@ int usrl_schema_add_field(UsrlSchema *schema, const char *field_name,
         case USRL_FIELD_F32:
             schema->total_size += 4;
             break;
+        case USRL_FIELD_VBYTES:
+        case USRL_FIELD_VSTRING:
+            schema->total_size += sizeof(UsrlVarRef);
+            schema->var_count++;
+            break;
         default:
             schema->total_size += size;
             break;
@@ -67,7 +74,11 @@ int usrl_schema_finalize(UsrlSchema *schema)
         hash = ((hash << 5) + hash) + schema->fields[i].type;
     }
     schema->fingerprint = hash;
-    return 0;
+
+    /* Defaults for readers of other versions: zero unless set */
+    free(schema->defaults);
+    schema->defaults = calloc(1, schema->total_size);
+    return schema->defaults ? 0 : -1;
 }
 
 UsrlMessage *usrl_message_create(UsrlSchema *schema, uint32_t capacity)
@@ -90,21 +101,189 @@ UsrlMessage *usrl_message_create(UsrlSchema *schema, uint32_t capacity)
     return msg;
 }
 
+UsrlMessage usrl_message_view(const UsrlSchema *schema, const uint8_t *payload, uint32_t len)
+{
+    UsrlMessage msg = {(UsrlSchema *)schema, NULL, 0, 0};
+    if (schema && payload && len >= schema->total_size) {
+        msg.data = (uint8_t *)payload;
+        msg.len = len;
+    }
+    return msg;
+}
+
+UsrlMessage usrl_message_build_in(const UsrlSchema *schema, void *dst, uint32_t capacity)
+{
+    UsrlMessage msg = {(UsrlSchema *)schema, NULL, 0, 0};
+    if (schema && dst && capacity >= schema->total_size) {
+        memset(dst, 0, schema->total_size);
+        msg.data = dst;
+        msg.len = schema->total_size;
+        msg.capacity = capacity;
+    }
+    return msg;
+}
+
+int usrl_arena_init(UsrlArena *arena, void *buf, size_t size)
+{
+    if (!arena || size == 0)
+        return -1;
+
+    arena->owned = (buf == NULL);
+    arena->base = buf ? buf : malloc(size);
+    arena->size = size;
+    arena->used = 0;
+    return arena->base ? 0 : -1;
+}
+
+void *usrl_arena_alloc(UsrlArena *arena, size_t size)
+{
+    if (!arena || !arena->base)
+        return NULL;
+
+    size_t at = (arena->used + 7) & ~(size_t)7;
+    if (at > arena->size || size > arena->size - at)
+        return NULL;
+    arena->used = at + size;
+    return arena->base + at;
+}
+
+void usrl_arena_reset(UsrlArena *arena)
+{
+    if (arena) arena->used = 0;
+}
+
+void usrl_arena_destroy(UsrlArena *arena)
+{
+    if (!arena) return;
+    if (arena->owned) free(arena->base);
+    arena->base = NULL;
+    arena->size = arena->used = 0;
+}
+
+UsrlMessage *usrl_arena_message(UsrlArena *arena, UsrlSchema *schema, uint32_t capacity)
+{
+    if (!schema) return NULL;
+
+    uint32_t cap = capacity > schema->total_size ? capacity : schema->total_size;
+    size_t mark = arena ? arena->used : 0;
+    UsrlMessage *msg = usrl_arena_alloc(arena, sizeof(*msg));
+    uint8_t *data = msg ? usrl_arena_alloc(arena, cap) : NULL;
+    if (!data) {
+        if (arena) arena->used = mark;
+        return NULL;
+    }
+
+    *msg = usrl_message_build_in(schema, data, cap);
+    return msg;
+}
+
+/* Names are compared by their fingerprint first; strcmp only confirms a hit */
+UsrlFieldId usrl_schema_field_id(const UsrlSchema *schema, const char *field_name)
+{
+    if (!schema || !field_name)
+        return USRL_FIELD_INVALID;
+
+    uint32_t hash = usrl_schema_hash(field_name);
+    for (uint32_t i = 0; i < schema->field_count; i++) {
+        const UsrlField *f = &schema->fields[i];
+        if (f->fingerprint == hash && strcmp(f->name, field_name) == 0)
+            return USRL_FIELD_ID(f->offset, i);
+    }
+    return USRL_FIELD_INVALID;
+}
+
+int usrl_message_set_var(UsrlMessage *msg, UsrlFieldId fid, const void *value, uint32_t len)
+{
+    if (!msg || (!value && len) || fid == USRL_FIELD_INVALID ||
+        USRL_FIELD_INDEX(fid) >= msg->schema->field_count)
+        return -1;
+
+    const UsrlField *f = &msg->schema->fields[USRL_FIELD_INDEX(fid)];
+    if (!USRL_FIELD_IS_VAR(f->type) || (f->size && len > f->size)) return -1;
+
+    /*
+     * Setting the field again reuses its extent: the room runs up to the
+     * next variable value, so a value that shrank can grow back, and the
+     * last one can grow up to the capacity. Otherwise the value is appended
+     * and the old extent is left unused.
+     */
+    UsrlVarRef old;
+    memcpy(&old, msg->data + f->offset, sizeof(old));
+    bool owned = old.len && old.offset >= msg->schema->total_size &&
+                 (uint32_t)old.offset + old.len <= msg->len;
+    uint32_t next = msg->len;
+    for (uint32_t i = 0; owned && i < msg->schema->field_count; i++) {
+        const UsrlField *g = &msg->schema->fields[i];
+        if (g == f || !USRL_FIELD_IS_VAR(g->type)) continue;
+        UsrlVarRef r;
+        memcpy(&r, msg->data + g->offset, sizeof(r));
+        if (r.len && r.offset > old.offset && r.offset < next) next = r.offset;
+    }
+    bool last = owned && next == msg->len;
+    uint32_t at = (owned && (len <= next - old.offset || last)) ? old.offset : msg->len;
+
+    if (at + len > msg->capacity || (len && at + len > 0xFFFFu)) return -1;
+
+    UsrlVarRef ref = {.offset = len ? (uint16_t)at : 0, .len = (uint16_t)len};
+    if (len) memmove(msg->data + at, value, len);
+    memcpy(msg->data + f->offset, &ref, sizeof(ref));
+    if (last) msg->len = at + len;
+    else if (at == msg->len) msg->len += len;
+    return (int)len;
+}
+
+void usrl_message_reset(UsrlMessage *msg)
+{
+    if (!msg) return;
+    for (uint32_t i = 0; msg->schema->var_count && i < msg->schema->field_count; i++) {
+        const UsrlField *f = &msg->schema->fields[i];
+        if (USRL_FIELD_IS_VAR(f->type)) memset(msg->data + f->offset, 0, sizeof(UsrlVarRef));
+    }
+    msg->len = msg->schema->total_size;
+}
+
+int usrl_message_set_bytes(UsrlMessage *msg, UsrlFieldId fid, const void *value, uint32_t len)
+{
+    if (!msg || !value || fid == USRL_FIELD_INVALID ||
+        USRL_FIELD_INDEX(fid) >= msg->schema->field_count)
+        return -1;
+
+    const UsrlField *f = &msg->schema->fields[USRL_FIELD_INDEX(fid)];
+    if (USRL_FIELD_IS_VAR(f->type))
+        return usrl_message_set_var(msg, fid, value, len);
+    uint32_t copy_len = len < f->size ? len : f->size;
+    memcpy(msg->data + f->offset, value, copy_len);
+    return (int)copy_len;
+}
+
+int usrl_message_get_bytes(const UsrlMessage *msg, UsrlFieldId fid, void *out_value,
+                           uint32_t max_len)
+{
+    if (!msg || !out_value || fid == USRL_FIELD_INVALID ||
+        USRL_FIELD_INDEX(fid) >= msg->schema->field_count)
+        return -1;
+
+    const UsrlField *f = &msg->schema->fields[USRL_FIELD_INDEX(fid)];
+    const uint8_t *src = msg->data + f->offset;
+    uint32_t size = f->size;
+    if (USRL_FIELD_IS_VAR(f->type)) {
+        UsrlVarView v = usrl_message_get_var(msg, fid);
+        src = v.ptr;
+        size = v.len;
+    }
+    uint32_t copy_len = max_len < size ? max_len : size;
+    if (copy_len) memcpy(out_value, src, copy_len);
+    return (int)copy_len;
+}
+
 int usrl_message_set(UsrlMessage *msg, const char *field_name,
                     const void *value, uint32_t len)
 {
     if (!msg || !field_name || !value)
         return -1;
 
-    for (uint32_t i = 0; i < msg->schema->field_count; i++) {
-        if (strcmp(msg->schema->fields[i].name, field_name) == 0) {
-            UsrlField *f = &msg->schema->fields[i];
-            uint32_t copy_len = len < f->size ? len : f->size;
-            memcpy(msg->data + f->offset, value, copy_len);
-            return 0;
-        }
-    }
-    return -1;
+    UsrlFieldId fid = usrl_schema_field_id(msg->schema, field_name);
+    return usrl_message_set_bytes(msg, fid, value, len) < 0 ? -1 : 0;
 }
 
 int usrl_message_get(UsrlMessage *msg, const char *field_name,
@@ -113,15 +292,8 @@ int usrl_message_get(UsrlMessage *msg, const char *field_name,
     if (!msg || !field_name || !out_value)
         return -1;
 
-    for (uint32_t i = 0; i < msg->schema->field_count; i++) {
-        if (strcmp(msg->schema->fields[i].name, field_name) == 0) {
-            UsrlField *f = &msg->schema->fields[i];
-            uint32_t copy_len = max_len < f->size ? max_len : f->size;
-            memcpy(out_value, msg->data + f->offset, copy_len);
-            return (int)copy_len;
-        }
-    }
-    return -1;
+    return usrl_message_get_bytes(msg, usrl_schema_field_id(msg->schema, field_name),
+                                  out_value, max_len);
 }
 
 int usrl_message_encode(UsrlMessage *msg, uint8_t *out_buf, uint32_t max_len)
@@ -138,8 +310,12 @@ int usrl_message_decode(UsrlMessage *msg, const uint8_t *data, uint32_t len)
     if (!msg || !data || len < msg->schema->total_size)
         return -1;
 
-    memcpy(msg->data, data, msg->schema->total_size);
-    msg->len = msg->schema->total_size;
+    /* Variable data follows the fixed part; fixed schemas ignore extra bytes */
+    uint32_t copy_len = msg->schema->var_count ? len : msg->schema->total_size;
+    if (copy_len > msg->capacity)
+        return -1;
+    memcpy(msg->data, data, copy_len);
+    msg->len = copy_len;
     return 0;
 }
 
@@ -158,5 +334,393 @@ void usrl_schema_free(UsrlSchema *schema)
         if (schema->fields[i].name)
             free((void *)schema->fields[i].name);
     }
+    free(schema->defaults);
     free(schema);
 }
+
+/* --------------------------------------------------------------------------
+ * Region binding
+ * -------------------------------------------------------------------------- */
+
+static UsrlShmSchema *shm_at(void *base, uint64_t off)
+{
+    return off ? (UsrlShmSchema *)((uint8_t *)base + off) : NULL;
+}
+
+static UsrlShmSchema *shm_first(void *base, TopicEntry *t)
+{
+    return shm_at(base, atomic_load_explicit(&t->schema_offset, memory_order_acquire));
+}
+
+static UsrlShmSchema *shm_next(void *base, const UsrlShmSchema *d)
+{
+    return shm_at(base, __atomic_load_n(&d->next_offset, __ATOMIC_ACQUIRE));
+}
+
+static const UsrlShmField *shm_field(const UsrlShmSchema *d, const char *name, uint32_t hash)
+{
+    for (uint32_t i = 0; i < d->field_count && i < USRL_MAX_FIELDS; i++) {
+        if (d->fields[i].fingerprint == hash &&
+            strncmp(d->fields[i].name, name, USRL_SCHEMA_NAME_MAX) == 0)
+            return &d->fields[i];
+    }
+    return NULL;
+}
+
+static int shm_field_matches(const UsrlShmField *sf, const UsrlField *f)
+{
+    UsrlField tmp = {.type = (UsrlFieldType)sf->type, .size = sf->size};
+    return sf->type == (uint32_t)f->type && usrl_field_width(&tmp) == usrl_field_width(f);
+}
+
+/*
+ * Is `schema` the layout bound as `d`? The fingerprint covers names and
+ * types only, so sizes and offsets are compared too: STRING[8] and
+ * STRING[32] under one version would otherwise pass.
+ */
+static int shm_same_layout(const UsrlShmSchema *d, const UsrlSchema *schema)
+{
+    if (d->fingerprint != schema->fingerprint || d->total_size != schema->total_size ||
+        d->field_count != schema->field_count)
+        return 0;
+    for (uint32_t i = 0; i < schema->field_count; i++) {
+        const UsrlShmField *sf = &d->fields[i];
+        const UsrlField *f = &schema->fields[i];
+        if (sf->type != (uint32_t)f->type || sf->size != f->size || sf->offset != f->offset ||
+            strncmp(sf->name, f->name, USRL_SCHEMA_NAME_MAX) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/* Can `schema` sit next to bound version `d`? 0, or -2 */
+static int shm_compatible(const UsrlShmSchema *d, const UsrlSchema *schema)
+{
+    if (d->schema_id != schema->schema_id ||
+        strncmp(d->name, schema->name, USRL_SCHEMA_NAME_MAX) != 0)
+        return -2;
+    if (d->version == schema->version)
+        return shm_same_layout(d, schema) ? 0 : -2;
+
+    for (uint32_t i = 0; i < schema->field_count; i++) {
+        const UsrlField *f = &schema->fields[i];
+        const UsrlShmField *sf = shm_field(d, f->name, f->fingerprint);
+        if (sf && !shm_field_matches(sf, f))
+            return -2;
+    }
+    return 0;
+}
+
+static int bind_args(void *base, const char *topic, const UsrlSchema *schema, TopicEntry **out)
+{
+    if (!schema || schema->fingerprint == 0 || !schema->name || schema->version == 0 ||
+        schema->version > 0xFFFFu)
+        return -1;
+
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t || schema->total_size > t->slot_size - sizeof(SlotHeader))
+        return -1;
+
+    if (strlen(schema->name) >= USRL_SCHEMA_NAME_MAX)
+        return -1;
+    for (uint32_t i = 0; i < schema->field_count; i++) {
+        if (strlen(schema->fields[i].name) >= USRL_SCHEMA_NAME_MAX)
+            return -1;
+    }
+    *out = t;
+    return 0;
+}
+
+/* Walk every bound version: 0 compatible and new, 1 this version is bound, -2 conflict */
+static int bind_scan(void *base, TopicEntry *t, const UsrlSchema *schema, UsrlShmSchema **last)
+{
+    int found = 0;
+    *last = NULL;
+    for (UsrlShmSchema *d = shm_first(base, t); d; d = shm_next(base, d)) {
+        if (shm_compatible(d, schema) != 0)
+            return -2;
+        if (d->version == schema->version)
+            found = 1;
+        *last = d;
+    }
+    return found;
+}
+
+int usrl_schema_check(void *base, const char *topic, const UsrlSchema *schema)
+{
+    TopicEntry *t;
+    UsrlShmSchema *last;
+    int rc = bind_args(base, topic, schema, &t);
+    if (rc != 0)
+        return rc;
+    rc = bind_scan(base, t, schema, &last);
+    return rc < 0 ? rc : 0;
+}
+
+int usrl_schema_bind(void *base, const char *topic, const UsrlSchema *schema)
+{
+    TopicEntry *t;
+    UsrlShmSchema *last;
+    int rc = bind_args(base, topic, schema, &t);
+    if (rc != 0)
+        return rc;
+    rc = bind_scan(base, t, schema, &last);
+    if (rc != 0)
+        return rc < 0 ? rc : 0;
+
+    uint64_t off = usrl_core_alloc(base, sizeof(UsrlShmSchema));
+    if (off == 0)
+        return -4;
+
+    UsrlShmSchema *d = shm_at(base, off);
+    memset(d, 0, sizeof(*d));
+    d->schema_id = schema->schema_id;
+    d->version = schema->version;
+    d->fingerprint = schema->fingerprint;
+    d->field_count = schema->field_count;
+    d->total_size = schema->total_size;
+    strcpy(d->name, schema->name);
+    for (uint32_t i = 0; i < schema->field_count; i++) {
+        const UsrlField *f = &schema->fields[i];
+        strcpy(d->fields[i].name, f->name);
+        d->fields[i].type = f->type;
+        d->fields[i].offset = f->offset;
+        d->fields[i].size = f->size;
+        d->fields[i].fingerprint = f->fingerprint;
+    }
+
+    /*
+     * Append to the version list. Losing a race means another version was
+     * linked first: check against it and retry from there. A loser's
+     * descriptor is simply never referenced.
+     */
+    for (;;) {
+        uint64_t expected = 0;
+        int linked = last ? __atomic_compare_exchange_n(&last->next_offset, &expected, off, false,
+                                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)
+                          : atomic_compare_exchange_strong_explicit(
+                                &t->schema_offset, &expected, off, memory_order_release,
+                                memory_order_acquire);
+        if (linked)
+            return 0;
+
+        for (UsrlShmSchema *n = shm_at(base, expected); n; n = shm_next(base, n)) {
+            if (shm_compatible(n, schema) != 0)
+                return -2;
+            if (n->version == schema->version)
+                return 0;
+            last = n;
+        }
+    }
+}
+
+static UsrlSchema *shm_to_schema(const UsrlShmSchema *d)
+{
+    if (d->field_count == 0 || d->field_count > USRL_MAX_FIELDS)
+        return NULL;
+
+    char name[USRL_SCHEMA_NAME_MAX];
+    memcpy(name, d->name, sizeof(name));
+    name[USRL_SCHEMA_NAME_MAX - 1] = '\0';
+
+    UsrlSchema *s = usrl_schema_create(d->schema_id, name);
+    if (!s)
+        return NULL;
+    s->version = d->version;
+
+    /* Rebuilding recomputes offsets and the fingerprint from the field list */
+    for (uint32_t i = 0; i < d->field_count; i++) {
+        memcpy(name, d->fields[i].name, sizeof(name));
+        name[USRL_SCHEMA_NAME_MAX - 1] = '\0';
+        usrl_schema_add_field(s, name, (UsrlFieldType)d->fields[i].type, d->fields[i].size);
+    }
+    if (usrl_schema_finalize(s) != 0 || s->fingerprint != d->fingerprint ||
+        s->total_size != d->total_size) {
+        usrl_schema_free(s);
+        return NULL;
+    }
+    return s;
+}
+
+/* Bound version `version`, or the newest one for 0 */
+static const UsrlShmSchema *shm_version(void *base, TopicEntry *t, uint32_t version)
+{
+    const UsrlShmSchema *best = NULL;
+    for (const UsrlShmSchema *d = shm_first(base, t); d; d = shm_next(base, d)) {
+        if (version ? d->version == version : (!best || d->version > best->version))
+            best = d;
+        if (version && best)
+            break;
+    }
+    return best;
+}
+
+UsrlSchema *usrl_schema_attach_version(void *base, const char *topic, uint32_t version)
+{
+    TopicEntry *t = usrl_get_topic(base, topic);
+    if (!t)
+        return NULL;
+    const UsrlShmSchema *d = shm_version(base, t, version);
+    return d ? shm_to_schema(d) : NULL;
+}
+
+UsrlSchema *usrl_schema_attach(void *base, const char *topic)
+{
+    return usrl_schema_attach_version(base, topic, 0);
+}
+
+const UsrlShmSchema *usrl_schema_next_desc(void *base, const char *topic,
+                                           const UsrlShmSchema *prev)
+{
+    if (!base || !topic)
+        return NULL;
+    if (prev)
+        return shm_next(base, prev);
+    TopicEntry *t = usrl_get_topic(base, topic);
+    return t ? shm_first(base, t) : NULL;
+}
+
+UsrlSchema *usrl_schema_from_desc(const UsrlShmSchema *desc)
+{
+    return desc ? shm_to_schema(desc) : NULL;
+}
+
+/* --------------------------------------------------------------------------
+ * Version maps
+ * -------------------------------------------------------------------------- */
+
+int usrl_schema_set_default(UsrlSchema *schema, UsrlFieldId fid, const void *value,
+                            uint32_t len)
+{
+    if (!schema || !schema->defaults || !value || fid == USRL_FIELD_INVALID ||
+        USRL_FIELD_INDEX(fid) >= schema->field_count)
+        return -1;
+
+    const UsrlField *f = &schema->fields[USRL_FIELD_INDEX(fid)];
+    uint32_t width = usrl_field_width(f);
+    uint32_t copy_len = len < width ? len : width;
+    memcpy(schema->defaults + f->offset, value, copy_len);
+    return (int)copy_len;
+}
+
+int usrl_schema_reader_init(UsrlSchemaReader *r, void *base, const char *topic,
+                            const UsrlSchema *schema)
+{
+    if (!r || !base || !topic || !schema || !schema->defaults)
+        return -1;
+
+    memset(r, 0, sizeof(*r));
+    r->schema = schema;
+    r->base = base;
+    strncpy(r->topic, topic, sizeof(r->topic) - 1);
+
+    r->self.version = schema->version;
+    r->self.size = schema->total_size;
+    r->self.defaults = schema->defaults;
+    for (uint32_t i = 0; i < schema->field_count; i++)
+        r->self.src[i] = schema->fields[i].offset;
+    return 0;
+}
+
+static uint64_t region_stamp(void *base)
+{
+    return atomic_load_explicit(&((CoreHeader *)base)->alloc_offset, memory_order_acquire);
+}
+
+/*
+ * Slow path: look the writer's version up in the region, once. `m` is the
+ * entry to fill, either a new one or an unreadable entry being retried.
+ */
+static void reader_build(UsrlSchemaReader *r, UsrlSchemaMap *m, uint32_t version)
+{
+    /* Stamp first: a version bound after this point changes it */
+    m->version = version;
+    m->size = UINT32_MAX;
+    m->stamp = region_stamp(r->base);
+    m->defaults = r->schema->defaults;
+
+    TopicEntry *t = usrl_get_topic(r->base, r->topic);
+    const UsrlShmSchema *d = t ? shm_version(r->base, t, version) : NULL;
+    if (!d || d->schema_id != r->schema->schema_id)
+        return;
+
+    for (uint32_t i = 0; i < r->schema->field_count; i++) {
+        const UsrlField *f = &r->schema->fields[i];
+        const UsrlShmField *sf = shm_field(d, f->name, f->fingerprint);
+        if (sf && !shm_field_matches(sf, f))
+            return;
+        m->src[i] = sf ? sf->offset : USRL_FIELD_MISSING;
+    }
+    m->size = d->total_size;
+}
+
+const UsrlSchemaMap *usrl_schema_reader_map(UsrlSchemaReader *r, uint32_t version,
+                                            uint32_t len)
+{
+    if (!r)
+        return NULL;
+
+    UsrlSchemaMap *m = NULL;
+    if (version == 0 || version == r->schema->version) {
+        m = &r->self;
+    } else {
+        uint32_t n = r->count < USRL_SCHEMA_MAPS ? r->count : USRL_SCHEMA_MAPS;
+        for (uint32_t i = 0; i < n && !m; i++) {
+            if (r->maps[i].version == version)
+                m = &r->maps[i];
+        }
+        if (!m) {
+            /* Cache full: recycle entries round robin */
+            m = &r->maps[r->count++ % USRL_SCHEMA_MAPS];
+            reader_build(r, m, version);
+        } else if (m->size == UINT32_MAX && m->stamp != region_stamp(r->base)) {
+            reader_build(r, m, version);
+        }
+    }
+    return (len >= m->size) ? m : NULL;
+}
+
+/* --------------------------------------------------------------------------
+ * Process-local registry
+ * -------------------------------------------------------------------------- */
+
+#define USRL_SCHEMA_REGISTRY 64
+
+static UsrlSchema *g_registry[USRL_SCHEMA_REGISTRY];
+static pthread_mutex_t g_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int usrl_schema_register(UsrlSchema *schema)
+{
+    if (!schema || !schema->name || schema->fingerprint == 0)
+        return -1;
+
+    int rc = -1;
+    pthread_mutex_lock(&g_registry_lock);
+    for (int i = 0; i < USRL_SCHEMA_REGISTRY; i++) {
+        /* Re-registering a name replaces the entry */
+        if (!g_registry[i] || strcmp(g_registry[i]->name, schema->name) == 0) {
+            g_registry[i] = schema;
+            rc = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_registry_lock);
+    return rc;
+}
+
+UsrlSchema *usrl_schema_find(const char *name)
+{
+    if (!name)
+        return NULL;
+
+    UsrlSchema *found = NULL;
+    pthread_mutex_lock(&g_registry_lock);
+    for (int i = 0; i < USRL_SCHEMA_REGISTRY && g_registry[i]; i++) {
+        if (strcmp(g_registry[i]->name, name) == 0) {
+            found = g_registry[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_registry_lock);
+    return found;
+}
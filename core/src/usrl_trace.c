@@ -0,0 +1,485 @@
+/**
+ * @file usrl_trace.c
+ * @brief Shared-memory trace rings and Chrome trace export.
+ */
+
+#define _GNU_SOURCE
+#include "usrl_trace.h"
+#include "usrl_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define LOCAL_NAMES 256 /* names seen by this process, replayed into a new region */
+
+int usrl_trace_on = 0;
+
+static uint8_t *g_map = NULL;        /* kept mapped once opened: threads hold ring pointers */
+static uint64_t g_map_size = 0;
+static char g_map_name[64];
+static atomic_uint g_gen = 0;        /* bumped per open so threads re-acquire a ring */
+
+static pthread_mutex_t g_names_mu = PTHREAD_MUTEX_INITIALIZER;
+static UsrlTraceName g_names[LOCAL_NAMES];
+static uint32_t g_name_count = 0;
+
+static pthread_key_t g_ring_key;
+static pthread_once_t g_ring_key_once = PTHREAD_ONCE_INIT;
+static __thread UsrlTraceRing *tl_ring = NULL;
+static __thread uint32_t tl_gen = 0;
+
+static inline UsrlTraceHeader *trace_hdr(void)
+{
+    return (UsrlTraceHeader *)g_map;
+}
+
+static inline UsrlTraceRing *ring_at(uint8_t *base, uint32_t i)
+{
+    const UsrlTraceHeader *h = (const UsrlTraceHeader *)base;
+    uint64_t stride = sizeof(UsrlTraceRing) + (uint64_t)h->ring_records * sizeof(UsrlTraceRec);
+    return (UsrlTraceRing *)(base + h->rings_offset + (uint64_t)i * stride);
+}
+
+static inline UsrlTraceRec *ring_recs(UsrlTraceRing *r)
+{
+    return (UsrlTraceRec *)(r + 1);
+}
+
+/* FNV-1a; 0 is reserved for "no name yet" */
+static uint32_t name_hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    for (; *s; s++) h = (h ^ (uint8_t)*s) * 16777619u;
+    return h ? h : 1;
+}
+
+/* --------------------------------------------------------------------------
+ * Region
+ * -------------------------------------------------------------------------- */
+
+static uint64_t region_size(uint32_t rings, uint32_t records)
+{
+    uint64_t names = sizeof(UsrlTraceHeader) + (uint64_t)USRL_TRACE_NAMES * sizeof(UsrlTraceName);
+    names = (names + 63) & ~63ULL;
+    return names + (uint64_t)rings * (sizeof(UsrlTraceRing) + (uint64_t)records * sizeof(UsrlTraceRec));
+}
+
+static void *map_existing(int fd, uint64_t *size)
+{
+    UsrlTraceHeader h;
+    for (int i = 0; i < 1000; i++) { /* creator may still be initialising */
+        if (pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+            __atomic_load_n(&h.magic, __ATOMIC_ACQUIRE) == USRL_TRACE_MAGIC)
+            break;
+        usleep(1000);
+    }
+    if (h.magic != USRL_TRACE_MAGIC || h.version != USRL_TRACE_VERSION) return NULL;
+    void *p = mmap(NULL, h.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return NULL;
+    *size = h.size;
+    return p;
+}
+
+static void *region_open(const char *name, uint32_t rings, uint32_t records, uint64_t *size)
+{
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd < 0) {
+        if (errno != EEXIST) return NULL;
+        fd = shm_open(name, O_RDWR, 0666);
+        if (fd < 0) return NULL;
+        void *p = map_existing(fd, size);
+        close(fd);
+        return p;
+    }
+
+    uint64_t sz = region_size(rings, records);
+    if (ftruncate(fd, (off_t)sz) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    uint8_t *p = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    /* ftruncate zero-filled it: only the header needs writing */
+    UsrlTraceHeader *h = (UsrlTraceHeader *)p;
+    h->version = USRL_TRACE_VERSION;
+    h->ring_count = rings;
+    h->ring_records = records;
+    h->name_cap = USRL_TRACE_NAMES;
+    h->names_offset = sizeof(UsrlTraceHeader);
+    h->rings_offset = (h->names_offset + (uint64_t)USRL_TRACE_NAMES * sizeof(UsrlTraceName) + 63) &
+                      ~63ULL;
+    h->size = sz;
+    __atomic_store_n(&h->magic, USRL_TRACE_MAGIC, __ATOMIC_RELEASE);
+    *size = sz;
+    return p;
+}
+
+/* Names are append-only; a racing duplicate entry is harmless */
+static void name_publish(uint32_t hash, const char *name)
+{
+    UsrlTraceHeader *h = trace_hdr();
+    UsrlTraceName *tab = (UsrlTraceName *)(g_map + h->names_offset);
+    uint32_t n = __atomic_load_n(&h->name_count, __ATOMIC_ACQUIRE);
+    if (n > h->name_cap) n = h->name_cap;
+    for (uint32_t i = 0; i < n; i++)
+        if (__atomic_load_n(&tab[i].hash, __ATOMIC_ACQUIRE) == hash) return;
+
+    uint32_t i = __atomic_fetch_add(&h->name_count, 1, __ATOMIC_ACQ_REL);
+    if (i >= h->name_cap) return;
+    strncpy(tab[i].name, name, USRL_TRACE_NAME_MAX - 1);
+    __atomic_store_n(&tab[i].hash, hash, __ATOMIC_RELEASE);
+}
+
+static void ring_release(void *p)
+{
+    UsrlTraceRing *r = (UsrlTraceRing *)p;
+    if (r) __atomic_store_n(&r->owner, 0, __ATOMIC_RELEASE);
+}
+
+static void ring_key_create(void)
+{
+    pthread_key_create(&g_ring_key, ring_release);
+}
+
+int usrl_trace_open(const char *shm_name, uint32_t rings, uint32_t records)
+{
+    if (!shm_name) shm_name = USRL_TRACE_SHM;
+    if (rings == 0) rings = USRL_TRACE_RINGS;
+    if (records == 0) records = USRL_TRACE_RECORDS;
+    if (records & (records - 1)) return -1;
+
+    if (!g_map || strcmp(g_map_name, shm_name) != 0) {
+        uint64_t size = 0;
+        uint8_t *p = region_open(shm_name, rings, records, &size);
+        if (!p) return -1;
+        __atomic_store_n(&usrl_trace_on, 0, __ATOMIC_RELAXED);
+        /* A previous region stays mapped: another thread may still be mid-record */
+        g_map = p;
+        g_map_size = size;
+        snprintf(g_map_name, sizeof(g_map_name), "%s", shm_name);
+    }
+    pthread_once(&g_ring_key_once, ring_key_create);
+
+    pthread_mutex_lock(&g_names_mu);
+    for (uint32_t i = 0; i < g_name_count; i++) name_publish(g_names[i].hash, g_names[i].name);
+    pthread_mutex_unlock(&g_names_mu);
+
+    atomic_fetch_add_explicit(&g_gen, 1, memory_order_release);
+    __atomic_store_n(&usrl_trace_on, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void usrl_trace_close(void)
+{
+    __atomic_store_n(&usrl_trace_on, 0, __ATOMIC_RELEASE);
+}
+
+uint32_t usrl_trace_topic(const char *name)
+{
+    if (!name) return 0;
+    uint32_t hash = name_hash(name);
+
+    pthread_mutex_lock(&g_names_mu);
+    uint32_t i = 0;
+    while (i < g_name_count && g_names[i].hash != hash) i++;
+    if (i == g_name_count && i < LOCAL_NAMES) {
+        g_names[i].hash = hash;
+        strncpy(g_names[i].name, name, USRL_TRACE_NAME_MAX - 1);
+        g_name_count++;
+    }
+    if (g_map && usrl_tracing()) name_publish(hash, name);
+    pthread_mutex_unlock(&g_names_mu);
+    return hash;
+}
+
+/* --------------------------------------------------------------------------
+ * Recording
+ * -------------------------------------------------------------------------- */
+
+static int pid_gone(uint32_t pid)
+{
+    return pid != 0 && kill((pid_t)pid, 0) != 0 && errno == ESRCH;
+}
+
+/*
+ * Slow path, once per thread per open: a never-used ring first, so older
+ * records survive as long as possible; then any ring whose owner is gone.
+ * A thread that finds none records nothing until the next open.
+ */
+static USRL_NOINLINE UsrlTraceRing *ring_acquire(void)
+{
+    UsrlTraceHeader *h = trace_hdr();
+    uint32_t me = (uint32_t)getpid();
+    if (tl_ring) ring_release(tl_ring); /* from before a reopen */
+    tl_gen = atomic_load_explicit(&g_gen, memory_order_acquire);
+    tl_ring = NULL;
+
+    for (int pass = 0; pass < 2 && !tl_ring; pass++) {
+        for (uint32_t i = 0; i < h->ring_count; i++) {
+            UsrlTraceRing *r = ring_at(g_map, i);
+            uint32_t owner = __atomic_load_n(&r->owner, __ATOMIC_RELAXED);
+            if (pass == 0 && (owner != 0 || __atomic_load_n(&r->head, __ATOMIC_RELAXED) != 0))
+                continue;
+            if (owner != 0 && !pid_gone(owner)) continue;
+            if (!__atomic_compare_exchange_n(&r->owner, &owner, me, false, __ATOMIC_ACQUIRE,
+                                             __ATOMIC_RELAXED))
+                continue;
+            __atomic_store_n(&r->head, 0, __ATOMIC_RELEASE);
+            r->pid = me;
+            r->tid = (uint32_t)syscall(SYS_gettid);
+            memset(r->thread, 0, sizeof(r->thread));
+            pthread_getname_np(pthread_self(), r->thread, sizeof(r->thread));
+            tl_ring = r;
+            break;
+        }
+    }
+    pthread_setspecific(g_ring_key, tl_ring);
+    return tl_ring;
+}
+
+void usrl_trace_rec(uint32_t kind, uint32_t topic, uint64_t seq, uint16_t pub_id,
+                    uint64_t ts, uint64_t end, uint32_t arg)
+{
+    if (!usrl_tracing()) return;
+    UsrlTraceRing *r = tl_ring;
+    uint32_t gen = atomic_load_explicit(&g_gen, memory_order_relaxed);
+    if (__builtin_expect(!r || tl_gen != gen, 0)) {
+        if (!r && tl_gen == gen) return; /* every ring was taken at this open */
+        r = ring_acquire();
+        if (!r) return;
+    }
+
+    const uint32_t mask = trace_hdr()->ring_records - 1;
+    uint64_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    UsrlTraceRec *e = &ring_recs(r)[head & mask];
+    e->ts = ts;
+    e->seq = seq;
+    e->topic = topic;
+    e->dur_ns = (end > ts) ? (uint32_t)((end - ts) < UINT32_MAX ? end - ts : UINT32_MAX) : 0;
+    e->kind = (uint16_t)kind;
+    e->pub_id = pub_id;
+    e->arg = arg;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* --------------------------------------------------------------------------
+ * Chrome trace export
+ * -------------------------------------------------------------------------- */
+
+typedef struct {
+    UsrlTraceRec rec;
+    uint32_t pid;
+    uint32_t tid;
+} Event;
+
+typedef struct {
+    uint32_t topic;
+    uint64_t seq;
+    int64_t idx; /* into events, -1 = empty */
+} PubKey;
+
+static int event_cmp(const void *a, const void *b)
+{
+    const Event *x = (const Event *)a, *y = (const Event *)b;
+    return (x->rec.ts > y->rec.ts) - (x->rec.ts < y->rec.ts);
+}
+
+static const char *name_of(const UsrlTraceHeader *h, uint32_t hash, char *fallback)
+{
+    const UsrlTraceName *tab = (const UsrlTraceName *)((const uint8_t *)h + h->names_offset);
+    uint32_t n = __atomic_load_n(&h->name_count, __ATOMIC_ACQUIRE);
+    if (n > h->name_cap) n = h->name_cap;
+    for (uint32_t i = 0; i < n; i++)
+        if (__atomic_load_n(&tab[i].hash, __ATOMIC_ACQUIRE) == hash) return tab[i].name;
+    snprintf(fallback, 16, "#%08x", hash);
+    return fallback;
+}
+
+/* A JSON string: prefix, then s escaped, at most max bytes of it */
+static void json_str(FILE *f, const char *prefix, const char *s, size_t max)
+{
+    fputc('"', f);
+    fputs(prefix, f);
+    for (; max && *s; s++, max--) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s < 0x20) continue;
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void json_us(FILE *f, const char *key, uint64_t ns)
+{
+    fprintf(f, ",\"%s\":%lu.%03lu", key, (uint64_t)(ns / 1000), (uint64_t)(ns % 1000));
+}
+
+/* Everything still in the rings, oldest first; overwritten-while-copied records dropped */
+static Event *collect(uint8_t *base, size_t *count)
+{
+    const UsrlTraceHeader *h = (const UsrlTraceHeader *)base;
+    size_t cap = 0;
+    for (uint32_t i = 0; i < h->ring_count; i++) {
+        uint64_t head = __atomic_load_n(&ring_at(base, i)->head, __ATOMIC_ACQUIRE);
+        cap += head < h->ring_records ? head : h->ring_records;
+    }
+    Event *ev = malloc((cap ? cap : 1) * sizeof(Event));
+    if (!ev) return NULL;
+
+    size_t n = 0;
+    for (uint32_t i = 0; i < h->ring_count && n < cap; i++) {
+        UsrlTraceRing *r = ring_at(base, i);
+        uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        uint64_t first = head > h->ring_records ? head - h->ring_records : 0;
+        size_t start = n;
+        for (uint64_t k = first; k < head && n < cap; k++) {
+            ev[n].rec = ring_recs(r)[k & (h->ring_records - 1)];
+            ev[n].pid = r->pid;
+            ev[n].tid = r->tid;
+            n++;
+        }
+        /*
+         * The writer may be rewriting the slot of record `after` (and has
+         * rewritten everything before it a lap back); a ring that was
+         * re-acquired meanwhile holds another thread's records.
+         */
+        uint64_t after = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        if (after < head) {
+            n = start;
+            continue;
+        }
+        uint64_t valid_from = after >= h->ring_records ? after - h->ring_records + 1 : 0;
+        size_t keep = start;
+        for (size_t k = start; k < n; k++)
+            if (first + (k - start) >= valid_from) ev[keep++] = ev[k];
+        n = keep;
+    }
+    qsort(ev, n, sizeof(Event), event_cmp);
+    *count = n;
+    return ev;
+}
+
+static void emit_threads(FILE *f, uint8_t *base, int *first)
+{
+    const UsrlTraceHeader *h = (const UsrlTraceHeader *)base;
+    for (uint32_t i = 0; i < h->ring_count; i++) {
+        UsrlTraceRing *r = ring_at(base, i);
+        if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == 0) continue;
+        char name[sizeof(r->thread) + 1];
+        memcpy(name, r->thread, sizeof(r->thread));
+        name[sizeof(r->thread)] = '\0';
+        fprintf(f, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+                *first ? "" : ",\n", r->pid, r->tid);
+        json_str(f, "", name[0] ? name : "thread", sizeof(name));
+        fprintf(f, "}}");
+        *first = 0;
+    }
+}
+
+int usrl_trace_export_chrome(const char *shm_name, const char *out_path)
+{
+    if (!shm_name) shm_name = USRL_TRACE_SHM;
+    int fd = shm_open(shm_name, O_RDONLY, 0);
+    if (fd < 0) return -1;
+    UsrlTraceHeader hdr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+        hdr.magic != USRL_TRACE_MAGIC || hdr.version != USRL_TRACE_VERSION ||
+        hdr.size > (uint64_t)st.st_size) {
+        close(fd);
+        return -1;
+    }
+    uint8_t *base = mmap(NULL, hdr.size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    FILE *f = (out_path && strcmp(out_path, "-") != 0) ? fopen(out_path, "w") : stdout;
+    if (!f) {
+        munmap(base, hdr.size);
+        return -2;
+    }
+
+    size_t n = 0;
+    Event *ev = collect(base, &n);
+    size_t nkeys = 16;
+    while (nkeys < 2 * n) nkeys <<= 1;
+    PubKey *keys = malloc(nkeys * sizeof(PubKey));
+    if (!ev || !keys) {
+        free(ev);
+        free(keys);
+        if (f != stdout) fclose(f);
+        munmap(base, hdr.size);
+        return -2;
+    }
+    for (size_t i = 0; i < nkeys; i++) keys[i].idx = -1;
+
+    const UsrlTraceHeader *h = (const UsrlTraceHeader *)base;
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int first = 1;
+    emit_threads(f, base, &first);
+
+    uint64_t flow = 0;
+    char fb[16];
+    for (size_t i = 0; i < n; i++) {
+        const UsrlTraceRec *r = &ev[i].rec;
+        const char *name = name_of(h, r->topic, fb);
+        const char *what = r->kind == USRL_TRACE_PUB ? "publish " :
+                           r->kind == USRL_TRACE_SUB ? "consume " : "";
+
+        fprintf(f, "%s{\"ph\":\"X\",\"cat\":\"usrl\",\"name\":", first ? "" : ",\n");
+        json_str(f, what, name, USRL_TRACE_NAME_MAX);
+        first = 0;
+        fprintf(f, ",\"pid\":%u,\"tid\":%u", ev[i].pid, ev[i].tid);
+        json_us(f, "ts", r->ts);
+        json_us(f, "dur", r->dur_ns);
+        fprintf(f, ",\"args\":{\"seq\":%lu,\"pub_id\":%u,\"bytes\":%u", r->seq, r->pub_id, r->arg);
+
+        /* Latest publish of topic+seq so far: keys are filled in time order */
+        size_t slot = (r->topic * 2654435761u ^ r->seq * 0x9E3779B97F4A7C15ULL) & (nkeys - 1);
+        while (keys[slot].idx >= 0 && (keys[slot].topic != r->topic || keys[slot].seq != r->seq))
+            slot = (slot + 1) & (nkeys - 1);
+
+        if (r->kind == USRL_TRACE_PUB) {
+            keys[slot] = (PubKey){r->topic, r->seq, (int64_t)i};
+            fprintf(f, "}}");
+        } else if (r->kind == USRL_TRACE_SUB && keys[slot].idx >= 0) {
+            const Event *p = &ev[keys[slot].idx];
+            fprintf(f, ",\"latency_ns\":%lu}}", r->ts + r->dur_ns - p->rec.ts);
+            /* Flow from the publish slice to this consume slice */
+            uint64_t at = r->ts > p->rec.ts ? r->ts : p->rec.ts;
+            fprintf(f, ",\n{\"ph\":\"s\",\"cat\":\"usrl.flow\",\"name\":\"flow\",\"id\":%lu,"
+                       "\"pid\":%u,\"tid\":%u", ++flow, p->pid, p->tid);
+            json_us(f, "ts", p->rec.ts);
+            fprintf(f, "},\n{\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"usrl.flow\",\"name\":\"flow\","
+                       "\"id\":%lu,\"pid\":%u,\"tid\":%u", flow, ev[i].pid, ev[i].tid);
+            json_us(f, "ts", at);
+            fprintf(f, "}");
+        } else {
+            fprintf(f, "}}");
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    int err = ferror(f);
+    if (f != stdout) err |= fclose(f);
+    else fflush(f);
+    free(ev);
+    free(keys);
+    munmap(base, hdr.size);
+    return err ? -2 : (int)n;
+}
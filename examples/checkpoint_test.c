@@ -0,0 +1,383 @@
+/**
+ * @file checkpoint_test.c
+ * @brief Checkpoint save/restore, including saves taken under live publishing.
+ *
+ * VALIDATES:
+ * 1. A restored ring holds only consecutive messages ending at the saved
+ *    head: a malformed slot in the file (payload_len past the slot) cuts the
+ *    window there instead of being replayed.
+ * 2. A subscriber attached before the restore skips to the first restored
+ *    message rather than waiting on seq 1, and a publisher attached before
+ *    it keeps publishing into the restored generation.
+ * 3. Checkpoints taken while a publisher laps the ring restore to a window
+ *    every subscriber can drain to the head: no holes, no torn payloads.
+ * 4. The topic's schema versions are restored with it, and a region whose
+ *    binding conflicts with the saved one is left alone.
+ * 5. Slots larger than the save's staging chunk round-trip intact, and a
+ *    file saved under another region layout version is refused.
+ *
+ * Usage: checkpoint_test [rounds]
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_checkpoint.h"
+#include "usrl_schema.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+#define SRC_SHM     "/usrl-ckpt-src"
+#define DST_SHM     "/usrl-ckpt-dst"
+#define CKPT_FILE   "/tmp/usrl-ckpt-test.bin"
+#define TEST_TOPIC  "ckpt"
+#define TEST_SLOTS  64
+#define LOAD_SLOTS  4096    /* big enough that the publisher laps it mid-save */
+#define TEST_WORDS  15      /* u64 words per payload, each holding the seq */
+#define REGION_SIZE (4 * 1024 * 1024)
+#define BIG_SLOT    (6u * 1024u * 1024u)   /* larger than the 4 MB save chunk */
+#define BIG_REGION  (32 * 1024 * 1024)
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static void check(int ok, const char *what) {
+    printf("%s[%s]%s %s\n", ok ? COLOR_GREEN : COLOR_RED, ok ? "PASS" : "FAIL", COLOR_RESET,
+           what);
+    if (!ok) g_fail = 1;
+}
+
+static void *region_create(const char *name, uint32_t slots) {
+    UsrlTopicConfig topic;
+    memset(&topic, 0, sizeof(topic));
+    strcpy(topic.name, TEST_TOPIC);
+    topic.slot_count = slots;
+    topic.slot_size = 128;
+    topic.type = USRL_RING_TYPE_SWMR;
+
+    shm_unlink(name);
+    if (usrl_core_init(name, REGION_SIZE, &topic, 1) != 0) return NULL;
+    return usrl_core_map(name, REGION_SIZE);
+}
+
+static void region_destroy(void *base, const char *name) {
+    usrl_core_unmap(base, REGION_SIZE);
+    shm_unlink(name);
+}
+
+static RingDesc *ring_of(void *base) {
+    TopicEntry *t = usrl_get_topic(base, TEST_TOPIC);
+    return (RingDesc *)((uint8_t *)base + t->ring_desc_offset);
+}
+
+static uint64_t head_of(void *base) {
+    return atomic_load(&ring_of(base)->w_head);
+}
+
+static void publish_one(UsrlPublisher *p, uint64_t seq) {
+    uint64_t words[TEST_WORDS];
+    for (int i = 0; i < TEST_WORDS; i++) words[i] = seq;
+    usrl_pub_publish(p, words, sizeof(words));
+}
+
+/*
+ * Drain a subscriber. Returns the last seq read, or 0 if a payload was torn
+ * or seqs were not consecutive from `first`.
+ */
+static uint64_t drain(UsrlSubscriber *s, uint64_t first) {
+    uint64_t words[TEST_WORDS], want = first;
+    int len;
+    while ((len = usrl_sub_next(s, (uint8_t *)words, sizeof(words), NULL)) != USRL_RING_NO_DATA) {
+        if (len != (int)sizeof(words)) return 0;
+        for (int i = 0; i < TEST_WORDS; i++)
+            if (words[i] != words[0]) return 0;
+        if (want && words[0] != want) return 0;
+        want = words[0] + 1;
+    }
+    return want - 1;
+}
+
+/* ============================================================================
+ * MALFORMED SLOT
+ * ============================================================================ */
+
+static void test_malformed_slot(void) {
+    void *src = region_create(SRC_SHM, TEST_SLOTS);
+    void *dst = region_create(DST_SHM, TEST_SLOTS);
+    if (!src || !dst) {
+        check(0, "create regions");
+        return;
+    }
+
+    UsrlPublisher pub;
+    memset(&pub, 0, sizeof(pub));
+    usrl_pub_init(&pub, src, TEST_TOPIC, 1);
+    for (uint64_t seq = 1; seq <= 100; seq++) publish_one(&pub, seq);
+    check(usrl_checkpoint_save(src, CKPT_FILE) == 1, "save idle region");
+
+    /* Claim seq 97 is longer than its slot */
+    off_t img = sizeof(UsrlCheckpointHeader) + sizeof(UsrlCheckpointTopic);
+    off_t at = img + (off_t)((97 - 1) % TEST_SLOTS) * ring_of(src)->slot_size + offsetof(SlotHeader, payload_len);
+    uint32_t bad = 4096;
+    int fd = open(CKPT_FILE, O_WRONLY);
+    check(fd >= 0 && pwrite(fd, &bad, sizeof(bad), at) == (ssize_t)sizeof(bad),
+          "corrupt one slot");
+    if (fd >= 0) close(fd);
+
+    UsrlSubscriber early, late;
+    UsrlPublisher resumed;
+    memset(&early, 0, sizeof(early));
+    memset(&late, 0, sizeof(late));
+    memset(&resumed, 0, sizeof(resumed));
+    usrl_sub_init(&early, dst, TEST_TOPIC);
+    usrl_pub_init(&resumed, dst, TEST_TOPIC, 1);
+
+    check(usrl_checkpoint_restore(dst, CKPT_FILE) == 1, "restore");
+    check(head_of(dst) == 100, "head restored");
+    check(ring_of(dst)->generation != ring_of(src)->generation, "restored ring is a new generation");
+
+    usrl_sub_init(&late, dst, TEST_TOPIC);
+    check(drain(&early, 98) == 100, "attached reader skips to the first restored message");
+    check(early.skipped_count == 97, "dropped messages counted as skipped");
+    check(drain(&late, 98) == 100, "new reader reads 98..100 only");
+
+    /* A publisher attached before the restore picks up the new generation */
+    publish_one(&resumed, 101);
+    check(drain(&early, 101) == 101, "publisher attached before the restore resumes at 101");
+
+    region_destroy(src, SRC_SHM);
+    region_destroy(dst, DST_SHM);
+}
+
+/* ============================================================================
+ * LARGE SLOTS AND LAYOUT
+ * ============================================================================ */
+
+static void *big_region_create(const char *name) {
+    UsrlTopicConfig topic;
+    memset(&topic, 0, sizeof(topic));
+    strcpy(topic.name, TEST_TOPIC);
+    topic.slot_count = 2;
+    topic.slot_size = BIG_SLOT;
+    topic.type = USRL_RING_TYPE_SWMR;
+
+    shm_unlink(name);
+    if (usrl_core_init(name, BIG_REGION, &topic, 1) != 0) return NULL;
+    return usrl_core_map(name, BIG_REGION);
+}
+
+static void test_large_slots(void) {
+    void *src = big_region_create(SRC_SHM);
+    void *dst = big_region_create(DST_SHM);
+    uint32_t len = BIG_SLOT - 4096;
+    uint8_t *msg = malloc(len), *got = malloc(len);
+    if (!src || !dst || !msg || !got) {
+        check(0, "create large-slot regions");
+        goto out;
+    }
+
+    UsrlPublisher pub;
+    memset(&pub, 0, sizeof(pub));
+    usrl_pub_init(&pub, src, TEST_TOPIC, 1);
+    for (uint32_t seq = 1; seq <= 3; seq++) {
+        for (uint32_t i = 0; i < len; i++) msg[i] = (uint8_t)(i * 7u + seq);
+        usrl_pub_publish(&pub, msg, len);
+    }
+    check(usrl_checkpoint_save(src, CKPT_FILE) == 1, "save 6 MB slots");
+
+    /* The same file stamped with another layout version is refused */
+    uint32_t layout = ((CoreHeader *)src)->version + 1, saved = layout - 1;
+    off_t at = offsetof(UsrlCheckpointHeader, layout);
+    int fd = open(CKPT_FILE, O_WRONLY);
+    int ok = fd >= 0 && pwrite(fd, &layout, sizeof(layout), at) == (ssize_t)sizeof(layout);
+    check(ok && usrl_checkpoint_restore(dst, CKPT_FILE) == -3 && head_of(dst) == 0,
+          "file from another layout version is refused");
+    ok = fd >= 0 && pwrite(fd, &saved, sizeof(saved), at) == (ssize_t)sizeof(saved);
+    if (fd >= 0) close(fd);
+
+    check(ok && usrl_checkpoint_restore(dst, CKPT_FILE) == 1 && head_of(dst) == 3,
+          "restore 6 MB slots");
+
+    UsrlSubscriber sub;
+    memset(&sub, 0, sizeof(sub));
+    usrl_sub_init(&sub, dst, TEST_TOPIC);
+    int intact = 1, read = 0, n;
+    while ((n = usrl_sub_next(&sub, got, len, NULL)) != USRL_RING_NO_DATA) {
+        uint32_t seq = 2 + (uint32_t)read++;
+        if (n != (int)len) {
+            intact = 0;
+            break;
+        }
+        for (uint32_t i = 0; i < len; i++)
+            if (got[i] != (uint8_t)(i * 7u + seq)) {
+                intact = 0;
+                break;
+            }
+    }
+    check(intact && read == 2, "large payloads restored intact");
+
+out:
+    free(msg);
+    free(got);
+    if (src) {
+        usrl_core_unmap(src, BIG_REGION);
+        shm_unlink(SRC_SHM);
+    }
+    if (dst) {
+        usrl_core_unmap(dst, BIG_REGION);
+        shm_unlink(DST_SHM);
+    }
+}
+
+/* ============================================================================
+ * SCHEMA BINDING
+ * ============================================================================ */
+
+static UsrlSchema *quote_schema(uint32_t version, UsrlFieldType px_type) {
+    UsrlSchema *s = usrl_schema_create(7, "Quote");
+    s->version = version;
+    usrl_schema_add_field(s, "px", px_type, 8);
+    if (version > 1) usrl_schema_add_field(s, "qty", USRL_FIELD_U32, 4);
+    usrl_schema_finalize(s);
+    return s;
+}
+
+static void test_schema_binding(void) {
+    void *src = region_create(SRC_SHM, TEST_SLOTS);
+    void *dst = region_create(DST_SHM, TEST_SLOTS);
+    if (!src || !dst) {
+        check(0, "create regions");
+        return;
+    }
+
+    UsrlSchema *v1 = quote_schema(1, USRL_FIELD_F64);
+    UsrlSchema *v2 = quote_schema(2, USRL_FIELD_F64);
+    UsrlSchema *other = quote_schema(1, USRL_FIELD_U64);
+    usrl_schema_bind(src, TEST_TOPIC, v1);
+    usrl_schema_bind(src, TEST_TOPIC, v2);
+
+    UsrlPublisher pub;
+    memset(&pub, 0, sizeof(pub));
+    usrl_pub_init(&pub, src, TEST_TOPIC, 1);
+    usrl_pub_set_schema(&pub, v2);
+    for (uint64_t seq = 1; seq <= 10; seq++) publish_one(&pub, seq);
+    check(usrl_checkpoint_save(src, CKPT_FILE) == 1, "save topic with two schema versions");
+
+    check(usrl_checkpoint_restore(dst, CKPT_FILE) == 1, "restore");
+    UsrlSchema *got1 = usrl_schema_attach_version(dst, TEST_TOPIC, 1);
+    UsrlSchema *got2 = usrl_schema_attach_version(dst, TEST_TOPIC, 2);
+    check(got1 && got2 && got1->fingerprint == v1->fingerprint &&
+              got2->fingerprint == v2->fingerprint,
+          "both versions bound after restore");
+    usrl_schema_free(got1);
+    usrl_schema_free(got2);
+
+    region_destroy(dst, DST_SHM);
+    dst = region_create(DST_SHM, TEST_SLOTS);
+    usrl_schema_bind(dst, TEST_TOPIC, other);
+    check(dst && usrl_checkpoint_restore(dst, CKPT_FILE) == 0 && head_of(dst) == 0,
+          "conflicting binding: topic left alone");
+
+    usrl_schema_free(v1);
+    usrl_schema_free(v2);
+    usrl_schema_free(other);
+    region_destroy(src, SRC_SHM);
+    if (dst) region_destroy(dst, DST_SHM);
+}
+
+/* ============================================================================
+ * SAVE UNDER LOAD
+ * ============================================================================ */
+
+typedef struct {
+    void *base;
+    atomic_int stop;
+} PubArgs;
+
+static void *publisher_thread(void *arg) {
+    PubArgs *a = (PubArgs *)arg;
+    UsrlPublisher pub;
+    memset(&pub, 0, sizeof(pub));
+    usrl_pub_init(&pub, a->base, TEST_TOPIC, 1);
+    for (uint64_t seq = 1; !atomic_load_explicit(&a->stop, memory_order_relaxed); seq++)
+        publish_one(&pub, seq);
+    return NULL;
+}
+
+static void test_save_under_load(int rounds) {
+    void *src = region_create(SRC_SHM, LOAD_SLOTS);
+    if (!src) {
+        check(0, "create source region");
+        return;
+    }
+
+    PubArgs args = {.base = src};
+    pthread_t th;
+    pthread_create(&th, NULL, publisher_thread, &args);
+    while (head_of(src) < 4 * LOAD_SLOTS) sched_yield();
+
+    int bad = 0;
+    uint64_t min_window = LOAD_SLOTS;
+    for (int i = 0; i < rounds && !bad; i++) {
+        void *dst = region_create(DST_SHM, LOAD_SLOTS);
+        if (!dst || usrl_checkpoint_save(src, CKPT_FILE) != 1) {
+            bad = 1;
+            break;
+        }
+
+        UsrlSubscriber early, late;
+        memset(&early, 0, sizeof(early));
+        memset(&late, 0, sizeof(late));
+        usrl_sub_init(&early, dst, TEST_TOPIC);
+        if (usrl_checkpoint_restore(dst, CKPT_FILE) != 1) bad = 1;
+        usrl_sub_init(&late, dst, TEST_TOPIC);
+
+        uint64_t head = head_of(dst);
+        uint64_t window = head - early.skipped_count;
+        if (window < min_window) min_window = window;
+        if (drain(&early, 0) != head || drain(&late, 0) != head) bad = 1;
+        region_destroy(dst, DST_SHM);
+    }
+
+    atomic_store(&args.stop, 1);
+    pthread_join(th, NULL);
+    region_destroy(src, SRC_SHM);
+
+    printf("  %d rounds, smallest restored window %lu of %d slots\n", rounds,
+           (unsigned long)min_window, LOAD_SLOTS);
+    check(!bad, "every restore drains to its head with intact payloads");
+}
+
+int main(int argc, char **argv) {
+    int rounds = (argc > 1) ? atoi(argv[1]) : 200;
+
+    printf("========================================================\n");
+    printf("  USRL CHECKPOINT TEST                                  \n");
+    printf("========================================================\n");
+
+    test_malformed_slot();
+    test_schema_binding();
+    test_large_slots();
+    test_save_under_load(rounds);
+    unlink(CKPT_FILE);
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
@@ -0,0 +1,303 @@
+/**
+ * @file columnar_test.c
+ * @brief Columnar drain: packed and mixed-length batches, stop rows, overwrites.
+ *
+ * VALIDATES:
+ * 1. A batch of rows that all have the schema's size lands field by field in
+ *    the columns, across several calls; NULL columns are left alone.
+ * 2. Rows longer than the schema (mixed lengths in one batch) are drained by
+ *    their fixed part.
+ * 3. A short row, or a row stamped with another version of the schema, ends
+ *    the batch and is left unread: the next usrl_sub_next returns it, and the
+ *    drain resumes after it.
+ * 4. Drained while a publisher laps a small ring, every stored row is one
+ *    message: a row overwritten during the copy is not counted, and the next
+ *    row takes its place.
+ *
+ * Usage: columnar_test [milliseconds]
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_schema.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#define TEST_SHM    "/usrl-columnar-test"
+#define TEST_TOPIC  "cols"
+#define LAP_TOPIC   "cols.lap"
+#define TEST_SLOTS  1024
+#define LAP_SLOTS   64
+#define SCHEMA_ID   21
+#define SLOT_SIZE   2048
+#define REGION_SIZE (8 * 1024 * 1024)
+#define BLOB_SIZE   1024 /* long enough that a lap can land in the middle of a row */
+#define ROW_SIZE    (32 + BLOB_SIZE) /* the fields below, with padding */
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static void check(int ok, const char *what) {
+    printf("%s[%s]%s %s\n", ok ? COLOR_GREEN : COLOR_RED, ok ? "PASS" : "FAIL", COLOR_RESET,
+           what);
+    if (!ok) g_fail = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ts u64, id u32, px f64, sym STRING[8], blob BYTES[BLOB_SIZE] */
+static UsrlSchema *quote_schema(uint32_t version) {
+    UsrlSchema *s = usrl_schema_create(SCHEMA_ID, "ColQuote");
+    s->version = version;
+    usrl_schema_add_field(s, "ts", USRL_FIELD_U64, 8);
+    usrl_schema_add_field(s, "id", USRL_FIELD_U32, 4);
+    usrl_schema_add_field(s, "px", USRL_FIELD_F64, 8);
+    usrl_schema_add_field(s, "sym", USRL_FIELD_STRING, 8);
+    usrl_schema_add_field(s, "blob", USRL_FIELD_BYTES, BLOB_SIZE);
+    usrl_schema_finalize(s);
+    return s;
+}
+
+/* Row k of the schema, every field derived from k; extra bytes past the fixed part */
+static uint32_t make_row(const UsrlSchema *s, uint64_t k, uint8_t *buf, uint32_t extra) {
+    uint32_t id = (uint32_t)k * 3u;
+    double px = (double)k + 0.25;
+    char sym[8] = {0};
+    memset(buf, 0, s->total_size + extra);
+    snprintf(sym, sizeof(sym), "S%lu", (unsigned long)(k % 1000000));
+    memcpy(buf + s->fields[0].offset, &k, 8);
+    memcpy(buf + s->fields[1].offset, &id, 4);
+    memcpy(buf + s->fields[2].offset, &px, 8);
+    memcpy(buf + s->fields[3].offset, sym, 8);
+    memset(buf + s->fields[4].offset, (int)(k & 0xFF), BLOB_SIZE);
+    memset(buf + s->total_size, 0xEE, extra);
+    return s->total_size + extra;
+}
+
+typedef struct {
+    uint64_t ts[TEST_SLOTS];
+    uint32_t id[TEST_SLOTS];
+    double px[TEST_SLOTS];
+    char sym[TEST_SLOTS][8];
+    uint8_t blob[TEST_SLOTS][BLOB_SIZE];
+} Columns;
+
+/* Row r of the columns holds message k */
+static int row_holds(const Columns *c, uint32_t r, uint64_t k, int with_px) {
+    char sym[8] = {0};
+    snprintf(sym, sizeof(sym), "S%lu", (unsigned long)(k % 1000000));
+    if (c->ts[r] != k || c->id[r] != (uint32_t)k * 3u || memcmp(c->sym[r], sym, 8) != 0)
+        return 0;
+    for (uint32_t i = 0; i < BLOB_SIZE; i++)
+        if (c->blob[r][i] != (uint8_t)k) return 0;
+    return !with_px || c->px[r] == (double)k + 0.25;
+}
+
+/* Rows 0..rows-1 of the columns hold messages first, first+1, ... */
+static int columns_hold(const Columns *c, uint32_t rows, uint64_t first, int with_px) {
+    for (uint32_t r = 0; r < rows; r++)
+        if (!row_holds(c, r, first + r, with_px)) return 0;
+    return 1;
+}
+
+static void *region_create(void) {
+    UsrlTopicConfig topics[2];
+    memset(topics, 0, sizeof(topics));
+    strcpy(topics[0].name, TEST_TOPIC);
+    topics[0].slot_count = TEST_SLOTS;
+    topics[0].slot_size = SLOT_SIZE;
+    topics[0].type = USRL_RING_TYPE_SWMR;
+    strcpy(topics[1].name, LAP_TOPIC);
+    topics[1].slot_count = LAP_SLOTS;
+    topics[1].slot_size = SLOT_SIZE;
+    topics[1].type = USRL_RING_TYPE_SWMR;
+
+    shm_unlink(TEST_SHM);
+    if (usrl_core_init(TEST_SHM, REGION_SIZE, topics, 2) != 0) return NULL;
+    return usrl_core_map(TEST_SHM, REGION_SIZE);
+}
+
+/* ============================================================================
+ * PACKED, MIXED LENGTHS, STOP ROWS
+ * ============================================================================ */
+
+static void test_batches(void *base) {
+    UsrlSchema *v1 = quote_schema(1);
+    UsrlSchema *v2 = quote_schema(2);
+    check(v1->total_size <= ROW_SIZE, "schema fits the test rows");
+
+    UsrlPublisher pub;
+    UsrlSubscriber sub;
+    memset(&pub, 0, sizeof(pub));
+    memset(&sub, 0, sizeof(sub));
+    usrl_pub_init(&pub, base, TEST_TOPIC, 1);
+    usrl_sub_init(&sub, base, TEST_TOPIC);
+    usrl_pub_set_schema(&pub, v1);
+
+    static Columns c;
+    void *cols[5] = {c.ts, c.id, c.px, c.sym, c.blob};
+    uint8_t row[ROW_SIZE + 16];
+
+    /* 1. Packed rows, drained in three calls */
+    for (uint64_t k = 1; k <= 600; k++) usrl_pub_publish(&pub, row, make_row(v1, k, row, 0));
+    int a = usrl_sub_drain_columnar(&sub, v1, cols, 250);
+    int ok = a == 250 && columns_hold(&c, 250, 1, 1);
+    int b = usrl_sub_drain_columnar(&sub, v1, cols, 250);
+    ok = ok && b == 250 && columns_hold(&c, 250, 251, 1);
+    memset(c.px, 0, sizeof(c.px));
+    cols[2] = NULL;
+    int d = usrl_sub_drain_columnar(&sub, v1, cols, 250);
+    ok = ok && d == 100 && columns_hold(&c, 100, 501, 0) && c.px[0] == 0.0;
+    cols[2] = c.px;
+    check(ok, "packed rows drained across calls, NULL column untouched");
+    check(usrl_sub_drain_columnar(&sub, v1, cols, 250) == 0, "nothing new: 0 rows");
+
+    /* 2. Mixed lengths: every other row carries 16 bytes past the schema */
+    for (uint64_t k = 601; k <= 700; k++)
+        usrl_pub_publish(&pub, row, make_row(v1, k, row, (k & 1) ? 16 : 0));
+    check(usrl_sub_drain_columnar(&sub, v1, cols, TEST_SLOTS) == 100 &&
+              columns_hold(&c, 100, 601, 1),
+          "mixed-length rows drained by their fixed part");
+
+    /* 3. A short row ends the batch and is left unread */
+    for (uint64_t k = 701; k <= 710; k++) usrl_pub_publish(&pub, row, make_row(v1, k, row, 0));
+    usrl_pub_publish(&pub, row, v1->total_size - 1);
+    for (uint64_t k = 712; k <= 720; k++) usrl_pub_publish(&pub, row, make_row(v1, k, row, 0));
+    check(usrl_sub_drain_columnar(&sub, v1, cols, TEST_SLOTS) == 10 &&
+              columns_hold(&c, 10, 701, 1),
+          "short row ends the batch");
+    check(usrl_sub_drain_columnar(&sub, v1, cols, TEST_SLOTS) == 0, "short row still blocks");
+    uint8_t buf[SLOT_SIZE];
+    check(usrl_sub_next(&sub, buf, sizeof(buf), NULL) == (int)v1->total_size - 1,
+          "short row is the next read");
+    check(usrl_sub_drain_columnar(&sub, v1, cols, TEST_SLOTS) == 9 &&
+              columns_hold(&c, 9, 712, 1),
+          "drain resumes after it");
+
+    /* 4. A row of another version ends the batch and is left unread */
+    for (uint64_t k = 721; k <= 730; k++) usrl_pub_publish(&pub, row, make_row(v1, k, row, 0));
+    usrl_pub_set_schema(&pub, v2);
+    usrl_pub_publish(&pub, row, make_row(v2, 731, row, 0));
+    usrl_pub_set_schema(&pub, v1);
+    for (uint64_t k = 732; k <= 740; k++) usrl_pub_publish(&pub, row, make_row(v1, k, row, 0));
+    check(usrl_sub_drain_columnar(&sub, v1, cols, TEST_SLOTS) == 10 &&
+              columns_hold(&c, 10, 721, 1),
+          "v2 row ends a v1 batch");
+    check(usrl_sub_next(&sub, buf, sizeof(buf), NULL) == (int)v2->total_size &&
+              sub.schema_ver == 2,
+          "v2 row is the next read");
+    check(usrl_sub_drain_columnar(&sub, v1, cols, TEST_SLOTS) == 9 &&
+              columns_hold(&c, 9, 732, 1),
+          "drain resumes after it");
+
+    usrl_schema_free(v1);
+    usrl_schema_free(v2);
+}
+
+/* ============================================================================
+ * DRAIN WHILE THE PUBLISHER LAPS
+ * ============================================================================ */
+
+/*
+ * The publisher runs from a timer signal, so it interrupts the drain at any
+ * point, between a row's peek and its peek_done included, even on one CPU.
+ * Each tick writes more than a lap.
+ */
+static UsrlPublisher g_lap_pub;
+static const UsrlSchema *g_lap_schema;
+static volatile uint64_t g_lap_sent;
+
+static void lap_tick(int sig) {
+    (void)sig;
+    uint8_t row[ROW_SIZE];
+    for (int i = 0; i < LAP_SLOTS + 3; i++) {
+        uint64_t k = ++g_lap_sent;
+        usrl_pub_publish(&g_lap_pub, row, make_row(g_lap_schema, k, row, 0));
+    }
+}
+
+static void test_overwrites(void *base, int ms) {
+    UsrlSchema *v1 = quote_schema(1);
+    UsrlSubscriber sub;
+    memset(&sub, 0, sizeof(sub));
+    memset(&g_lap_pub, 0, sizeof(g_lap_pub));
+    usrl_pub_init(&g_lap_pub, base, LAP_TOPIC, 2);
+    usrl_sub_init(&sub, base, LAP_TOPIC);
+    g_lap_schema = v1;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = lap_tick;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, NULL);
+    struct itimerval tick = {{0, 50}, {0, 50}};
+    setitimer(ITIMER_REAL, &tick, NULL);
+
+    static Columns c;
+    void *cols[5] = {c.ts, c.id, c.px, c.sym, c.blob};
+    uint64_t rows = 0, bad = 0, last = 0, backwards = 0;
+    uint64_t deadline = now_ns() + (uint64_t)ms * 1000000ull;
+    while (now_ns() < deadline) {
+        int n = usrl_sub_drain_columnar(&sub, v1, cols, LAP_SLOTS);
+        for (int r = 0; r < n; r++) {
+            /* Each row must be one message: every field agrees with its ts */
+            if (!row_holds(&c, (uint32_t)r, c.ts[r], 1)) bad++;
+            if (c.ts[r] <= last) backwards++;
+            last = c.ts[r];
+        }
+        rows += (uint64_t)(n > 0 ? n : 0);
+    }
+
+    struct itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_REAL, &off, NULL);
+    signal(SIGALRM, SIG_DFL);
+
+    printf("    sent=%lu drained=%lu skipped=%lu\n", (unsigned long)g_lap_sent,
+           (unsigned long)rows, (unsigned long)sub.skipped_count);
+    check(rows > 0 && bad == 0 && backwards == 0,
+          "rows drained from a lapping publisher are whole and in order");
+    usrl_schema_free(v1);
+}
+
+int main(int argc, char **argv) {
+    int ms = (argc > 1) ? atoi(argv[1]) : 300;
+
+    printf("========================================================\n");
+    printf("  USRL COLUMNAR DRAIN TEST                              \n");
+    printf("========================================================\n");
+
+    void *base = region_create();
+    if (!base) {
+        check(0, "create region");
+        return 1;
+    }
+    test_batches(base);
+    test_overwrites(base, ms);
+    usrl_core_unmap(base, REGION_SIZE);
+    shm_unlink(TEST_SHM);
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file fairness_test.c
+ * @brief Per-writer fair shares on a USRL_TOPIC_FAIR MWMR topic.
+ *
+ * VALIDATES:
+ * 1. Two writers with equal weights that both keep publishing get equal
+ *    shares: the one trying three times as often is refused the excess,
+ *    the other is never refused.
+ * 2. Weights 3:1 split the claims 3:1.
+ * 3. A writer that published once and went quiet does not lock the other
+ *    out: after USRL_FAIR_IDLE_NS the busy writer gets the whole ring.
+ *
+ * Usage: fairness_test
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#define TEST_SHM   "/usrl-fairness-test"
+#define TEST_TOPIC "fair"
+#define TEST_SLOTS 128
+#define REGION_SIZE (1024 * 1024)
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static void check(int ok, const char *what) {
+    printf("%s[%s]%s %s\n", ok ? COLOR_GREEN : COLOR_RED, ok ? "PASS" : "FAIL", COLOR_RESET,
+           what);
+    if (!ok) g_fail = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *region_create(void) {
+    UsrlTopicConfig topic;
+    memset(&topic, 0, sizeof(topic));
+    strcpy(topic.name, TEST_TOPIC);
+    topic.slot_count = TEST_SLOTS;
+    topic.slot_size = 64;
+    topic.type = USRL_RING_TYPE_MWMR;
+    topic.flags = USRL_TOPIC_FAIR;
+
+    shm_unlink(TEST_SHM);
+    if (usrl_core_init(TEST_SHM, REGION_SIZE, &topic, 1) != 0) return NULL;
+    return usrl_core_map(TEST_SHM, REGION_SIZE);
+}
+
+typedef struct {
+    UsrlMwmrPublisher pub;
+    uint64_t ok;
+    uint64_t refused;
+} Writer;
+
+static void attach(Writer *w, void *base, uint16_t pub_id, uint32_t weight) {
+    memset(w, 0, sizeof(*w));
+    usrl_mwmr_pub_init(&w->pub, base, TEST_TOPIC, pub_id);
+    if (weight != 1) usrl_mwmr_pub_set_weight(&w->pub, weight);
+}
+
+static void publish(Writer *w) {
+    uint64_t v = w->ok;
+    int rc = usrl_mwmr_pub_publish(&w->pub, &v, sizeof(v));
+    if (rc == USRL_RING_OK) w->ok++;
+    else if (rc == USRL_RING_QUOTA) w->refused++;
+}
+
+/*
+ * Both writers stay active: each round the fast one tries `fast_tries`
+ * publishes and the slow one tries one. Returns fast ok / slow ok.
+ */
+static double contend(uint32_t fast_weight, int fast_tries, Writer *fast, Writer *slow) {
+    void *base = region_create();
+    if (!base) return 0;
+    attach(fast, base, 1, fast_weight);
+    attach(slow, base, 2, 1);
+
+    for (int round = 0; round < 50 * TEST_SLOTS; round++) {
+        for (int i = 0; i < fast_tries; i++) publish(fast);
+        publish(slow);
+    }
+
+    usrl_core_unmap(base, REGION_SIZE);
+    shm_unlink(TEST_SHM);
+    return slow->ok ? (double)fast->ok / (double)slow->ok : 0;
+}
+
+static void test_equal_shares(void) {
+    Writer fast, slow;
+    double ratio = contend(1, 3, &fast, &slow);
+    printf("  fast ok=%lu refused=%lu, slow ok=%lu refused=%lu\n", (unsigned long)fast.ok,
+           (unsigned long)fast.refused, (unsigned long)slow.ok, (unsigned long)slow.refused);
+    check(ratio > 0.9 && ratio < 1.1, "equal weights: equal shares under contention");
+    check(fast.refused > 0 && slow.refused == 0, "only the writer over its share is refused");
+}
+
+static void test_weighted_shares(void) {
+    Writer fast, slow;
+    double ratio = contend(3, 5, &fast, &slow);
+    printf("  weight 3:1, claims %.2f:1\n", ratio);
+    check(ratio > 2.7 && ratio < 3.3, "weights 3:1 split the claims 3:1");
+}
+
+static void test_idle_writer(void) {
+    void *base = region_create();
+    if (!base) {
+        check(0, "create region");
+        return;
+    }
+    Writer busy, quiet;
+    attach(&busy, base, 1, 1);
+    attach(&quiet, base, 2, 1);
+
+    publish(&quiet); /* one message, then nothing */
+
+    uint64_t start = now_ns(), deadline = start + 100000000ULL;
+    while (busy.ok < 100 * TEST_SLOTS && now_ns() < deadline) publish(&busy);
+    uint64_t took = now_ns() - start;
+
+    printf("  busy ok=%lu refused=%lu in %.2f ms\n", (unsigned long)busy.ok,
+           (unsigned long)busy.refused, took / 1e6);
+    check(busy.ok == 100 * TEST_SLOTS, "a quiet writer does not lock the busy one out");
+    check(took < 20 * USRL_FAIR_IDLE_NS, "the busy writer is held back about USRL_FAIR_IDLE_NS at most");
+
+    usrl_core_unmap(base, REGION_SIZE);
+    shm_unlink(TEST_SHM);
+}
+
+int main(void) {
+    printf("========================================================\n");
+    printf("  USRL FAIR SHARE TEST                                  \n");
+    printf("========================================================\n");
+
+    test_equal_shares();
+    test_weighted_shares();
+    test_idle_writer();
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
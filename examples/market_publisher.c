@@ -8,14 +8,7 @@
 #include "usrl_schema.h"
 #include "usrl_logging.h"
 #include "usrl_ring.h"
-
-typedef struct __attribute__((packed)) {
-    uint64_t timestamp;
-    uint32_t ticker_crc;
-    double bid_price;
-    double ask_price;
-    uint64_t volume;
-} PriceQuote;
+#include "price_quote.h" /* generated by usrl-schemac from price_quote.usrl */
 
 int main(void)
 {
@@ -24,7 +17,7 @@ int main(void)
     usrl_logging_init(NULL, USRL_LOG_INFO);
 
     UsrlTopicConfig topics[] = {
-        {"prices", 512, 256, USRL_RING_TYPE_SWMR},
+        {"prices", 512, 256, USRL_RING_TYPE_SWMR, 0},
     };
 
     int ret = usrl_core_init("/usrl-market", 50*1024*1024, topics, 1);
@@ -39,13 +32,12 @@ int main(void)
         return 1;
     }
 
-    UsrlSchema *price_schema = usrl_schema_create(1, "price_quote");
-    usrl_schema_add_field(price_schema, "timestamp", USRL_FIELD_U64, 8);
-    usrl_schema_add_field(price_schema, "ticker_crc", USRL_FIELD_U32, 4);
-    usrl_schema_add_field(price_schema, "bid_price", USRL_FIELD_F64, 8);
-    usrl_schema_add_field(price_schema, "ask_price", USRL_FIELD_F64, 8);
-    usrl_schema_add_field(price_schema, "volume", USRL_FIELD_U64, 8);
-    usrl_schema_finalize(price_schema);
+    /* Bind the layout to the topic so subscribers and usrl-ctl can decode it */
+    UsrlSchema *price_schema = price_quote_schema();
+    if (!price_schema || usrl_schema_bind(base, "prices", price_schema) != 0) {
+        USRL_ERROR("market_pub", "Cannot bind schema price_quote");
+        return 1;
+    }
 
     UsrlPublisher pub;
     usrl_pub_init(&pub, base, "prices", 1);
@@ -64,17 +56,7 @@ int main(void)
             .volume = 1000000 + (msg_count % 5000000),
         };
 
-        UsrlMessage *msg = usrl_message_create(price_schema, 256);
-        usrl_message_set(msg, "timestamp", &quote.timestamp, 8);
-        usrl_message_set(msg, "ticker_crc", &quote.ticker_crc, 4);
-        usrl_message_set(msg, "bid_price", &quote.bid_price, 8);
-        usrl_message_set(msg, "ask_price", &quote.ask_price, 8);
-        usrl_message_set(msg, "volume", &quote.volume, 8);
-
-        uint8_t buf[256];
-        int len = usrl_message_encode(msg, buf, sizeof(buf));
-        
-        if (usrl_pub_publish(&pub, buf, len) == 0) {
+        if (price_quote_publish(&pub, &quote) == 0) {
             msg_count++;
             if (msg_count % 10000 == 0) {
                 USRL_INFO("market_pub", "Published %lu quotes", msg_count);
@@ -83,7 +65,6 @@ int main(void)
             USRL_WARN("market_pub", "Publish failed");
         }
 
-        usrl_message_free(msg);
         usleep(1000);
     }
 
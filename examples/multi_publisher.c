@@ -148,7 +148,7 @@ int main(void)
     usrl_logging_init(NULL, USRL_LOG_INFO);
 
     UsrlTopicConfig topics[] = {
-        {"orders", 1024, 512, USRL_RING_TYPE_MWMR},
+        {"orders", 1024, 512, USRL_RING_TYPE_MWMR, 0},
     };
 
     int ret = usrl_core_init("/usrl-orders", 100 * 1024 * 1024, topics, 1);
@@ -0,0 +1,407 @@
+/**
+ * @file ordering_test.c
+ * @brief Hardware litmus runner and torn-read stress for the slot protocol.
+ *
+ * This samples what the host CPU does; it does not prove the orderings in
+ * usrl_core.h correct. On x86 (TSO) the hardware never reorders the MP and
+ * SEQLOCK shapes whatever barriers the code uses, so a clean run there says
+ * nothing about USRL_SMP_WMB / USRL_SMP_RMB. Only a weakly ordered host
+ * (aarch64, POWER) can expose a missing barrier, and then only with some
+ * probability; the herd7 cases in examples/litmus/ are the proof.
+ *
+ * CHECKS:
+ * 1. Litmus shapes the ring relies on (MP, SEQLOCK) show no forbidden
+ *    outcome on this host.
+ * 2. The harness is sensitive enough to catch reordering at all: SB with
+ *    relaxed atomics is expected to show its "relaxed" outcome on real HW.
+ * 3. Torn reads: SWMR and MWMR rings are hammered through the real
+ *    usrl_pub_publish / usrl_mwmr_pub_publish / usrl_sub_next paths with
+ *    self-checking payloads; any delivered message that mixes two writes
+ *    (or goes backwards per publisher) fails the run. Writers are held to
+ *    STRESS_LEAD messages ahead of the slowest reader, so readers still race
+ *    overwrites but copy a real share of the traffic instead of skipping
+ *    nearly all of it; a run where they read under a quarter fails.
+ *
+ * Usage: ordering_test [stress_seconds]
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+#define LITMUS_INSTANCES 4096   /* independent location sets per round */
+#define LITMUS_ROUNDS    200    /* rounds per litmus test */
+
+#define STRESS_SHM       "/usrl-ordering-test"
+#define STRESS_WORDS     32     /* u64 words per payload (256 bytes) */
+#define STRESS_SLOTS     8      /* tiny ring => constant overwrite pressure */
+#define STRESS_WRITERS   3      /* MWMR writers */
+#define STRESS_READERS   2      /* readers per topic */
+#define STRESS_LEAD      (2 * STRESS_SLOTS) /* writers stay this far ahead of the slowest reader */
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_YELLOW  "\x1b[33m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ============================================================================
+ * LITMUS HARNESS
+ *
+ * litmus7-style: each round both threads walk the same array of independent
+ * location sets, so most instances execute concurrently. Locations are
+ * atomics accessed with the weakest legal order, which compiles to plain
+ * loads/stores; the barriers under test are the only ordering in play.
+ * ============================================================================ */
+
+typedef struct {
+    atomic_uint_fast64_t x;
+    uint8_t _pad0[56];
+    atomic_uint_fast64_t y;
+    uint8_t _pad1[56];
+    atomic_uint_fast64_t z;
+    uint64_t r[4];              /* observed registers */
+} LitmusCell;
+
+typedef void (*LitmusThreadFn)(LitmusCell *c);
+
+typedef struct {
+    LitmusCell *cells;
+    LitmusThreadFn fn;
+    atomic_int *go;
+    atomic_int *done;
+    int id;
+} LitmusArgs;
+
+static void *litmus_thread(void *arg) {
+    LitmusArgs *a = (LitmusArgs *)arg;
+    for (int round = 1; round <= LITMUS_ROUNDS; round++) {
+        while (atomic_load_explicit(a->go, memory_order_acquire) < round) { }
+        for (int i = 0; i < LITMUS_INSTANCES; i++) a->fn(&a->cells[i]);
+        atomic_fetch_add_explicit(a->done, 1, memory_order_acq_rel);
+    }
+    return NULL;
+}
+
+/* Runs t0 || t1 and returns how many instances `check` flags */
+static uint64_t litmus_run(LitmusThreadFn t0, LitmusThreadFn t1,
+                           int (*check)(const LitmusCell *c)) {
+    LitmusCell *cells = aligned_alloc(64, sizeof(LitmusCell) * LITMUS_INSTANCES);
+    if (!cells) return 0;
+
+    atomic_int go = 0, done = 0;
+    LitmusArgs a0 = { cells, t0, &go, &done, 0 };
+    LitmusArgs a1 = { cells, t1, &go, &done, 1 };
+    pthread_t th0, th1;
+    pthread_create(&th0, NULL, litmus_thread, &a0);
+    pthread_create(&th1, NULL, litmus_thread, &a1);
+
+    uint64_t hits = 0;
+    for (int round = 1; round <= LITMUS_ROUNDS; round++) {
+        memset(cells, 0, sizeof(LitmusCell) * LITMUS_INSTANCES);
+        atomic_store_explicit(&done, 0, memory_order_relaxed);
+        atomic_store_explicit(&go, round, memory_order_release);
+        while (atomic_load_explicit(&done, memory_order_acquire) < 2) { }
+        for (int i = 0; i < LITMUS_INSTANCES; i++) hits += (uint64_t)check(&cells[i]);
+    }
+
+    pthread_join(th0, NULL);
+    pthread_join(th1, NULL);
+    free(cells);
+    return hits;
+}
+
+/* --- SB (store buffering), relaxed: r0 == r1 == 0 is ALLOWED --- */
+static void sb_t0(LitmusCell *c) {
+    atomic_store_explicit(&c->x, 1, memory_order_relaxed);
+    c->r[0] = atomic_load_explicit(&c->y, memory_order_relaxed);
+}
+static void sb_t1(LitmusCell *c) {
+    atomic_store_explicit(&c->y, 1, memory_order_relaxed);
+    c->r[1] = atomic_load_explicit(&c->x, memory_order_relaxed);
+}
+static int sb_check(const LitmusCell *c) { return c->r[0] == 0 && c->r[1] == 0; }
+
+/* --- MP, release/acquire on the flag (commit store / first seq load) --- */
+static void mp_t0(LitmusCell *c) {
+    atomic_store_explicit(&c->x, 1, memory_order_relaxed);       /* payload */
+    atomic_store_explicit(&c->y, 1, memory_order_release);       /* seq */
+}
+static void mp_t1(LitmusCell *c) {
+    c->r[0] = atomic_load_explicit(&c->y, memory_order_acquire);
+    c->r[1] = atomic_load_explicit(&c->x, memory_order_relaxed);
+}
+static int mp_check(const LitmusCell *c) { return c->r[0] == 1 && c->r[1] == 0; }
+
+/*
+ * --- SEQLOCK, exactly the slot protocol: z = seq, x/y = payload words ---
+ * Forbidden: reader validates (s1 == s2, not busy) yet saw payload words
+ * that do not belong to s1.
+ */
+static void seq_t0(LitmusCell *c) {
+    atomic_store_explicit(&c->z, 1 | USRL_SEQ_BUSY, memory_order_relaxed);
+    USRL_SMP_WMB();
+    atomic_store_explicit(&c->x, 1, memory_order_relaxed);
+    atomic_store_explicit(&c->y, 1, memory_order_relaxed);
+    atomic_store_explicit(&c->z, 1, memory_order_release);
+}
+static void seq_t1(LitmusCell *c) {
+    c->r[0] = atomic_load_explicit(&c->z, memory_order_acquire);
+    c->r[1] = atomic_load_explicit(&c->x, memory_order_relaxed);
+    c->r[2] = atomic_load_explicit(&c->y, memory_order_relaxed);
+    USRL_SMP_RMB();
+    c->r[3] = atomic_load_explicit(&c->z, memory_order_relaxed);
+}
+static int seq_check(const LitmusCell *c) {
+    if (c->r[0] != c->r[3] || (c->r[0] & USRL_SEQ_BUSY)) return 0; /* reader retries */
+    return c->r[1] != c->r[0] || c->r[2] != c->r[0];
+}
+
+static void run_litmus(void) {
+    printf("\n[LITMUS] %d rounds x %d instances per test\n", LITMUS_ROUNDS, LITMUS_INSTANCES);
+
+    uint64_t sb = litmus_run(sb_t0, sb_t1, sb_check);
+    if (sb > 0)
+        printf(COLOR_GREEN "    SB  relaxed        : relaxed outcome seen %lu times (harness is sensitive)" COLOR_RESET "\n",
+               (unsigned long)sb);
+    else
+        printf(COLOR_YELLOW "    SB  relaxed        : relaxed outcome not seen (low sensitivity on this host)" COLOR_RESET "\n");
+
+    uint64_t mp = litmus_run(mp_t0, mp_t1, mp_check);
+    printf("%s    MP  rel/acq        : forbidden outcome %lu times" COLOR_RESET "\n",
+           mp ? COLOR_RED : COLOR_GREEN, (unsigned long)mp);
+    if (mp) g_fail = 1;
+
+    uint64_t sq = litmus_run(seq_t0, seq_t1, seq_check);
+    printf("%s    SEQLOCK wmb/rmb    : forbidden outcome %lu times" COLOR_RESET "\n",
+           sq ? COLOR_RED : COLOR_GREEN, (unsigned long)sq);
+    if (sq) g_fail = 1;
+}
+
+/* ============================================================================
+ * TORN-READ STRESS RUNNER
+ *
+ * Every payload word carries (pub_id << 48 | counter). A reader accepts a
+ * message only if all words agree and the counter for that publisher never
+ * goes backwards.
+ * ============================================================================ */
+
+typedef struct {
+    void *base;
+    const char *topic;
+    uint64_t deadline;
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t reordered;
+    uint64_t skipped;
+    atomic_uint_fast64_t seen; /* last seq consumed, for writer pacing */
+} StressReader;
+
+typedef struct {
+    void *base;
+    const char *topic;
+    uint16_t pub_id;
+    int mwmr;
+    uint64_t deadline;
+    uint64_t sent;
+    StressReader *readers;
+} StressWriter;
+
+static atomic_int g_writers_live;
+
+static void *stress_writer(void *arg) {
+    StressWriter *w = (StressWriter *)arg;
+    uint64_t payload[STRESS_WORDS];
+    UsrlPublisher sp;
+    UsrlMwmrPublisher mp;
+
+    if (w->mwmr) usrl_mwmr_pub_init(&mp, w->base, w->topic, w->pub_id);
+    else         usrl_pub_init(&sp, w->base, w->topic, w->pub_id);
+
+    TopicEntry *t = usrl_get_topic(w->base, w->topic);
+    RingDesc *d = (RingDesc *)((uint8_t *)w->base + t->ring_desc_offset);
+
+    uint64_t counter = 0;
+    while (now_ns() < w->deadline) {
+        /* Pace to the slowest reader; it still lags by a lap or two */
+        uint64_t slowest = UINT64_MAX;
+        for (int i = 0; i < STRESS_READERS; i++) {
+            uint64_t seen = atomic_load(&w->readers[i].seen);
+            if (seen < slowest) slowest = seen;
+        }
+        if (atomic_load(&d->w_head) > slowest + STRESS_LEAD) {
+            sched_yield();
+            continue;
+        }
+
+        counter++;
+        uint64_t v = ((uint64_t)w->pub_id << 48) | counter;
+        for (int i = 0; i < STRESS_WORDS; i++) payload[i] = v;
+
+        int rc = w->mwmr ? usrl_mwmr_pub_publish(&mp, payload, sizeof(payload))
+                         : usrl_pub_publish(&sp, payload, sizeof(payload));
+        if (rc == USRL_RING_OK) w->sent++;
+    }
+    atomic_fetch_sub(&g_writers_live, 1);
+    return NULL;
+}
+
+static void *stress_reader(void *arg) {
+    StressReader *r = (StressReader *)arg;
+    uint64_t payload[STRESS_WORDS];
+    uint64_t last_counter[STRESS_WRITERS + 2];
+    memset(last_counter, 0, sizeof(last_counter));
+
+    UsrlSubscriber sub;
+    usrl_sub_init(&sub, r->base, r->topic);
+
+    while (now_ns() < r->deadline || atomic_load(&g_writers_live) > 0) {
+        uint16_t pid = 0;
+        int n = usrl_sub_next(&sub, (uint8_t *)payload, sizeof(payload), &pid);
+        if (n < 0) {
+            atomic_store(&r->seen, sub.last_seq);
+            sched_yield(); /* keep writers running on small hosts */
+            continue;
+        }
+
+        r->reads++;
+        atomic_store(&r->seen, sub.last_seq);
+        if (n != (int)sizeof(payload)) { r->torn++; continue; }
+
+        uint64_t v = payload[0];
+        for (int i = 1; i < STRESS_WORDS; i++) {
+            if (payload[i] != v) { r->torn++; v = 0; break; }
+        }
+        if (v == 0) continue;
+
+        uint16_t owner = (uint16_t)(v >> 48);
+        uint64_t counter = v & ((1ull << 48) - 1);
+        if (owner != pid || owner == 0 || owner > STRESS_WRITERS + 1) { r->torn++; continue; }
+        if (counter <= last_counter[owner]) r->reordered++;
+        last_counter[owner] = counter;
+    }
+    r->skipped = sub.skipped_count;
+    return NULL;
+}
+
+static void run_stress_topic(void *base, const char *topic, int mwmr, int seconds) {
+    int nwriters = mwmr ? STRESS_WRITERS : 1;
+    StressWriter writers[STRESS_WRITERS];
+    StressReader readers[STRESS_READERS];
+    pthread_t wt[STRESS_WRITERS], rt[STRESS_READERS];
+
+    uint64_t deadline = now_ns() + (uint64_t)seconds * 1000000000ull;
+    atomic_store(&g_writers_live, nwriters);
+
+    for (int i = 0; i < STRESS_READERS; i++) {
+        readers[i] = (StressReader){ .base = base, .topic = topic, .deadline = deadline };
+        atomic_init(&readers[i].seen, 0); /* each topic starts empty */
+    }
+    for (int i = 0; i < STRESS_READERS; i++) {
+        pthread_create(&rt[i], NULL, stress_reader, &readers[i]);
+    }
+    for (int i = 0; i < nwriters; i++) {
+        writers[i] = (StressWriter){ .base = base, .topic = topic,
+                                     .pub_id = (uint16_t)(i + 1), .mwmr = mwmr,
+                                     .deadline = deadline, .readers = readers };
+        pthread_create(&wt[i], NULL, stress_writer, &writers[i]);
+    }
+
+    uint64_t sent = 0, reads = 0, torn = 0, reordered = 0, skipped = 0, least = UINT64_MAX;
+    for (int i = 0; i < nwriters; i++) { pthread_join(wt[i], NULL); sent += writers[i].sent; }
+    for (int i = 0; i < STRESS_READERS; i++) {
+        pthread_join(rt[i], NULL);
+        reads += readers[i].reads;
+        torn += readers[i].torn;
+        reordered += readers[i].reordered;
+        skipped += readers[i].skipped;
+        if (readers[i].reads < least) least = readers[i].reads;
+    }
+
+    /* A reader that skips most of the traffic never races a live write */
+    int bad = (torn > 0 || reordered > 0 || least == 0 || least * 4 < sent);
+    printf("%s    %-9s sent=%lu reads=%lu skipped=%lu torn=%lu reordered=%lu" COLOR_RESET "\n",
+           bad ? COLOR_RED : COLOR_GREEN, topic,
+           (unsigned long)sent, (unsigned long)reads, (unsigned long)skipped,
+           (unsigned long)torn, (unsigned long)reordered);
+    if (bad) g_fail = 1;
+}
+
+static void run_stress(int seconds) {
+    printf("\n[STRESS] %d s per topic, %d-slot rings, %d-byte payloads\n",
+           seconds, STRESS_SLOTS, (int)(STRESS_WORDS * sizeof(uint64_t)));
+
+    UsrlTopicConfig topics[] = {
+        {"ord_swmr", STRESS_SLOTS, STRESS_WORDS * sizeof(uint64_t), USRL_RING_TYPE_SWMR, 0},
+        {"ord_mwmr", STRESS_SLOTS, STRESS_WORDS * sizeof(uint64_t), USRL_RING_TYPE_MWMR, 0},
+    };
+
+    const uint64_t size = 4 * 1024 * 1024;
+    shm_unlink(STRESS_SHM);
+    if (usrl_core_init(STRESS_SHM, size, topics, 2) != 0) {
+        printf(COLOR_RED "[FAIL] usrl_core_init(%s)" COLOR_RESET "\n", STRESS_SHM);
+        g_fail = 1;
+        return;
+    }
+    void *base = usrl_core_map(STRESS_SHM, size);
+    if (!base) {
+        printf(COLOR_RED "[FAIL] usrl_core_map(%s)" COLOR_RESET "\n", STRESS_SHM);
+        g_fail = 1;
+        shm_unlink(STRESS_SHM);
+        return;
+    }
+
+    run_stress_topic(base, "ord_swmr", 0, seconds);
+    run_stress_topic(base, "ord_mwmr", 1, seconds);
+
+    usrl_core_unmap(base, size);
+    shm_unlink(STRESS_SHM);
+}
+
+int main(int argc, char **argv) {
+    int seconds = (argc > 1) ? atoi(argv[1]) : 2;
+    if (seconds <= 0) seconds = 2;
+
+    printf("========================================================\n");
+    printf("  USRL MEMORY-ORDERING LITMUS + STRESS                  \n");
+#if defined(__x86_64__) || defined(__i386__)
+    printf("  Arch: x86 (TSO) - WMB/RMB compile to no instruction   \n");
+    printf("  TSO hides weak-ordering bugs: litmus results here do  \n");
+    printf("  not exercise WMB/RMB (run on aarch64 for that)        \n");
+#elif defined(__aarch64__)
+    printf("  Arch: aarch64 - WMB=dmb ish, RMB=dmb ishld            \n");
+#else
+    printf("  Arch: generic - WMB/RMB are C11 release/acquire fences\n");
+#endif
+    printf("========================================================\n");
+
+    run_litmus();
+    run_stress(seconds);
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
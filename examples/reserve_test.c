@@ -0,0 +1,160 @@
+/**
+ * @file reserve_test.c
+ * @brief In-place publishing: reserve, commit and abort.
+ *
+ * VALIDATES:
+ * 1. A message built in place with reserve/commit reads back intact.
+ * 2. An aborted reservation does not stall readers: they step over it to
+ *    the next message without counting a skip (SWMR and MWMR).
+ * 3. An aborted slot survives a checkpoint without cutting the restored
+ *    window.
+ *
+ * Usage: reserve_test
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_checkpoint.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define TEST_SHM   "/usrl-reserve-test"
+#define DST_SHM    "/usrl-reserve-dst"
+#define CKPT_FILE  "/tmp/usrl-reserve-test.bin"
+#define SWMR_TOPIC "swmr"
+#define MWMR_TOPIC "mwmr"
+#define REGION_SIZE (1024 * 1024)
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static void check(int ok, const char *what) {
+    printf("%s[%s]%s %s\n", ok ? COLOR_GREEN : COLOR_RED, ok ? "PASS" : "FAIL", COLOR_RESET,
+           what);
+    if (!ok) g_fail = 1;
+}
+
+static void *region_create(const char *name) {
+    UsrlTopicConfig topics[2];
+    memset(topics, 0, sizeof(topics));
+    strcpy(topics[0].name, SWMR_TOPIC);
+    topics[0].slot_count = 16;
+    topics[0].slot_size = 64;
+    topics[0].type = USRL_RING_TYPE_SWMR;
+    strcpy(topics[1].name, MWMR_TOPIC);
+    topics[1].slot_count = 16;
+    topics[1].slot_size = 64;
+    topics[1].type = USRL_RING_TYPE_MWMR;
+
+    shm_unlink(name);
+    if (usrl_core_init(name, REGION_SIZE, topics, 2) != 0) return NULL;
+    return usrl_core_map(name, REGION_SIZE);
+}
+
+/* Read the next message as a u64, or return 0 if there is none */
+static uint64_t next_u64(UsrlSubscriber *s) {
+    uint64_t v;
+    int n = usrl_sub_next(s, (uint8_t *)&v, sizeof(v), NULL);
+    return (n == (int)sizeof(v)) ? v : 0;
+}
+
+static void test_swmr(void *base) {
+    UsrlPublisher pub;
+    UsrlSubscriber sub;
+    memset(&pub, 0, sizeof(pub));
+    memset(&sub, 0, sizeof(sub));
+    usrl_pub_init(&pub, base, SWMR_TOPIC, 1);
+    usrl_sub_init(&sub, base, SWMR_TOPIC);
+
+    uint8_t *p = usrl_pub_reserve(&pub, 8);
+    uint64_t v = 1;
+    memcpy(p, &v, 8);
+    check(usrl_pub_commit(&pub, 8) == USRL_RING_OK, "SWMR reserve/commit");
+
+    check(usrl_pub_reserve(&pub, 8) != NULL && usrl_pub_abort(&pub) == USRL_RING_OK,
+          "SWMR reserve/abort");
+    check(usrl_pub_abort(&pub) == USRL_RING_ERROR, "abort with nothing open refused");
+
+    v = 3;
+    usrl_pub_publish(&pub, &v, sizeof(v));
+
+    check(next_u64(&sub) == 1, "reads the committed message");
+    check(next_u64(&sub) == 3, "steps over the aborted slot to the next message");
+    check(sub.skipped_count == 0, "aborted slot not counted as skipped");
+    check(usrl_sub_next(&sub, (uint8_t *)&v, sizeof(v), NULL) == USRL_RING_NO_DATA, "caught up");
+
+    /* The aborted slot is carried through a checkpoint */
+    void *dst = region_create(DST_SHM);
+    check(dst && usrl_checkpoint_save(base, CKPT_FILE) == 2 &&
+              usrl_checkpoint_restore(dst, CKPT_FILE) == 2,
+          "checkpoint into a fresh region");
+    if (dst) {
+        UsrlSubscriber late;
+        memset(&late, 0, sizeof(late));
+        usrl_sub_init(&late, dst, SWMR_TOPIC);
+        check(next_u64(&late) == 1 && next_u64(&late) == 3,
+              "restored window still starts before the aborted slot");
+        usrl_core_unmap(dst, REGION_SIZE);
+    }
+    shm_unlink(DST_SHM);
+    unlink(CKPT_FILE);
+}
+
+static void test_mwmr(void *base) {
+    UsrlMwmrPublisher pub;
+    UsrlSubscriber sub;
+    memset(&pub, 0, sizeof(pub));
+    memset(&sub, 0, sizeof(sub));
+    usrl_mwmr_pub_init(&pub, base, MWMR_TOPIC, 2);
+    usrl_sub_init(&sub, base, MWMR_TOPIC);
+
+    int rc;
+    check(usrl_mwmr_pub_reserve(&pub, 8, &rc) != NULL && usrl_mwmr_pub_abort(&pub) == USRL_RING_OK,
+          "MWMR reserve/abort");
+    check(!pub.writer || atomic_load(&pub.writer->claim_seq) == 0, "abort closes the claim");
+
+    uint64_t v = 7;
+    usrl_mwmr_pub_publish(&pub, &v, sizeof(v));
+    check(next_u64(&sub) == 7 && sub.skipped_count == 0, "MWMR reader steps over the aborted slot");
+
+    /* A full lap later the aborted slot is claimed again as usual */
+    for (v = 8; v < 8 + 16; v++) usrl_mwmr_pub_publish(&pub, &v, sizeof(v));
+    uint64_t last = 0, got;
+    while ((got = next_u64(&sub)) != 0) last = got;
+    check(last == 8 + 15, "aborted slot reused on the next lap");
+}
+
+int main(void) {
+    printf("========================================================\n");
+    printf("  USRL RESERVE/ABORT TEST                               \n");
+    printf("========================================================\n");
+
+    void *base = region_create(TEST_SHM);
+    if (!base) {
+        printf(COLOR_RED "[FAIL] create region %s" COLOR_RESET "\n", TEST_SHM);
+        return 1;
+    }
+
+    test_swmr(base);
+    test_mwmr(base);
+
+    usrl_core_unmap(base, REGION_SIZE);
+    shm_unlink(TEST_SHM);
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
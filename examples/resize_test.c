@@ -0,0 +1,300 @@
+/**
+ * @file resize_test.c
+ * @brief Online ring growth with subscribers at different positions.
+ *
+ * VALIDATES:
+ * 1. A subscriber inside the copied window keeps its cursor across a grow
+ *    and reads every message in order.
+ * 2. A subscriber that lagged below the copied window jumps to the floor
+ *    (counting what it lost as skipped) instead of stalling on slots of
+ *    the new ring that were never written.
+ * 3. A subscriber attached after the grow starts at the floor.
+ * 4. A reservation still open when the grow starts is waited for, however
+ *    long it stays open, and its message reaches readers of the new ring.
+ * 5. Growing repeatedly while publishers (SWMR and MWMR) and a subscriber
+ *    run loses no message: every seq arrives once, in order, no skips.
+ *
+ * Usage: resize_test
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+#define TEST_SHM   "/usrl-resize-test"
+#define TEST_TOPIC "grow"
+#define OLD_SLOTS  8
+#define NEW_SLOTS  64
+#define REGION_SIZE (16 * 1024 * 1024)
+#define RUN_MSGS   200000  /* per publisher in the concurrent run */
+#define RUN_PUBS   2       /* MWMR publishers in the concurrent run */
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static void check(int ok, const char *what) {
+    printf("%s[%s]%s %s\n", ok ? COLOR_GREEN : COLOR_RED, ok ? "PASS" : "FAIL", COLOR_RESET,
+           what);
+    if (!ok) g_fail = 1;
+}
+
+static void publish(UsrlPublisher *p, uint64_t *seq, int n) {
+    for (int i = 0; i < n; i++) {
+        ++*seq;
+        usrl_pub_publish(p, seq, sizeof(*seq));
+    }
+}
+
+/* Drain a subscriber; returns messages read, 0 on any gap or reorder */
+static int drain(UsrlSubscriber *s, uint64_t first, uint64_t last) {
+    uint64_t v, want = first;
+    int n = 0, len;
+    while ((len = usrl_sub_next(s, (uint8_t *)&v, sizeof(v), NULL)) != USRL_RING_NO_DATA) {
+        if (len != (int)sizeof(v) || v != want) return 0;
+        want++;
+        n++;
+    }
+    return (want == last + 1) ? n : 0;
+}
+
+static void *region_create(uint32_t type) {
+    UsrlTopicConfig topic;
+    memset(&topic, 0, sizeof(topic));
+    strcpy(topic.name, TEST_TOPIC);
+    topic.slot_count = OLD_SLOTS;
+    topic.slot_size = 64;
+    topic.type = type;
+
+    shm_unlink(TEST_SHM);
+    if (usrl_core_init(TEST_SHM, REGION_SIZE, &topic, 1) != 0) return NULL;
+    return usrl_core_map(TEST_SHM, REGION_SIZE);
+}
+
+static void region_destroy(void *base) {
+    usrl_core_unmap(base, REGION_SIZE);
+    shm_unlink(TEST_SHM);
+}
+
+/* ============================================================================
+ * SINGLE-THREADED: cursors across a grow
+ * ============================================================================ */
+
+static void test_cursors(void) {
+    void *base = region_create(USRL_RING_TYPE_SWMR);
+    if (!base) {
+        check(0, "create region");
+        return;
+    }
+
+    UsrlPublisher pub;
+    UsrlSubscriber lagging, current;
+    memset(&pub, 0, sizeof(pub));
+    memset(&lagging, 0, sizeof(lagging));
+    memset(&current, 0, sizeof(current));
+    usrl_pub_init(&pub, base, TEST_TOPIC, 1);
+    usrl_sub_init(&lagging, base, TEST_TOPIC);
+    usrl_sub_init(&current, base, TEST_TOPIC);
+
+    uint64_t seq = 0, v;
+    publish(&pub, &seq, 4);
+    usrl_sub_next(&lagging, (uint8_t *)&v, sizeof(v), NULL); /* cursor at 1 */
+    publish(&pub, &seq, 22);                                  /* head 26 */
+    uint64_t floor = seq - OLD_SLOTS;                          /* copied: 19..26 */
+    while (usrl_sub_next(&current, (uint8_t *)&v, sizeof(v), NULL) >= 0 && v < floor + 2) {
+    }                                                         /* cursor at 21 */
+
+    check(usrl_ring_resize(base, TEST_TOPIC, NEW_SLOTS) == 0, "grow 8 -> 64 slots");
+    publish(&pub, &seq, 10);                                  /* 27..36 land in the new ring */
+
+    uint64_t skipped = lagging.skipped_count;
+    check(drain(&lagging, floor + 1, seq) == (int)(seq - floor),
+          "lagging reader resumes at the copied floor");
+    check(lagging.skipped_count - skipped == floor - 1, "lost messages counted as skipped");
+    check(drain(&current, floor + 3, seq) == (int)(seq - floor - 2),
+          "reader inside the window keeps its cursor");
+
+    UsrlSubscriber late;
+    memset(&late, 0, sizeof(late));
+    usrl_sub_init(&late, base, TEST_TOPIC);
+    check(drain(&late, floor + 1, seq) == (int)(seq - floor), "new reader starts at the floor");
+
+    region_destroy(base);
+}
+
+/* ============================================================================
+ * OPEN RESERVATION
+ * ============================================================================ */
+
+static void *grow_thread(void *arg) {
+    return (void *)(intptr_t)usrl_ring_resize(arg, TEST_TOPIC, NEW_SLOTS);
+}
+
+static void test_open_reservation(void) {
+    void *base = region_create(USRL_RING_TYPE_SWMR);
+    if (!base) {
+        check(0, "create region");
+        return;
+    }
+
+    UsrlPublisher pub;
+    UsrlSubscriber sub;
+    memset(&pub, 0, sizeof(pub));
+    memset(&sub, 0, sizeof(sub));
+    usrl_pub_init(&pub, base, TEST_TOPIC, 1);
+    usrl_sub_init(&sub, base, TEST_TOPIC);
+
+    uint64_t seq = 0;
+    publish(&pub, &seq, 3);
+    uint64_t *slot = (uint64_t *)usrl_pub_reserve(&pub, sizeof(uint64_t)); /* seq 4 */
+
+    pthread_t th;
+    pthread_create(&th, NULL, grow_thread, base);
+    usleep(300 * 1000); /* longer than the resizer's drain deadline */
+    *slot = ++seq;
+    usrl_pub_commit(&pub, sizeof(uint64_t));
+    void *rc;
+    pthread_join(th, &rc);
+    check((intptr_t)rc == 0, "grow waits for the open reservation");
+
+    publish(&pub, &seq, 3);
+    check(drain(&sub, 1, seq) == (int)seq && sub.skipped_count == 0,
+          "the reserved message is in the new ring");
+
+    region_destroy(base);
+}
+
+/* ============================================================================
+ * CONCURRENT GROW
+ * ============================================================================ */
+
+typedef struct {
+    void *base;
+    uint16_t pub_id;
+    atomic_int *done;
+    atomic_uint_fast64_t *consumed; /* messages the subscriber has read */
+} RunArgs;
+
+/* Keep the subscriber within half the smallest ring, so any skip is a loss */
+static void wait_for_reader(RingDesc *d, atomic_uint_fast64_t *consumed) {
+    while ((atomic_load(&d->w_head) & ~USRL_HEAD_RESIZING) - atomic_load(consumed) >=
+           OLD_SLOTS / 2)
+        sched_yield();
+}
+
+/* Payload: pub_id in the top 16 bits, that publisher's count below */
+static void *run_publisher(void *arg) {
+    RunArgs *a = (RunArgs *)arg;
+    TopicEntry *t = usrl_get_topic(a->base, TEST_TOPIC);
+    RingDesc *d = (RingDesc *)((uint8_t *)a->base + t->ring_desc_offset);
+    UsrlPublisher sw;
+    UsrlMwmrPublisher mw;
+    memset(&sw, 0, sizeof(sw));
+    memset(&mw, 0, sizeof(mw));
+    if (t->type == USRL_RING_TYPE_MWMR) usrl_mwmr_pub_init(&mw, a->base, TEST_TOPIC, a->pub_id);
+    else usrl_pub_init(&sw, a->base, TEST_TOPIC, a->pub_id);
+
+    for (uint64_t i = 1; i <= RUN_MSGS; i++) {
+        uint64_t v = ((uint64_t)a->pub_id << 48) | i;
+        wait_for_reader(d, a->consumed);
+        if (t->type == USRL_RING_TYPE_MWMR) {
+            while (usrl_mwmr_pub_publish(&mw, &v, sizeof(v)) != USRL_RING_OK) sched_yield();
+        } else {
+            usrl_pub_publish(&sw, &v, sizeof(v));
+        }
+    }
+    atomic_fetch_add(a->done, 1);
+    return NULL;
+}
+
+static void *run_resizer(void *arg) {
+    RunArgs *a = (RunArgs *)arg;
+    for (uint32_t slots = 2 * OLD_SLOTS; slots <= 64 * 1024 && atomic_load(a->done) == 0;
+         slots *= 2) {
+        usleep(2000);
+        usrl_ring_resize(a->base, TEST_TOPIC, slots);
+    }
+    return NULL;
+}
+
+static void test_concurrent(uint32_t type, int npubs, const char *what) {
+    void *base = region_create(type);
+    if (!base) {
+        check(0, "create region");
+        return;
+    }
+
+    UsrlSubscriber sub;
+    memset(&sub, 0, sizeof(sub));
+    usrl_sub_init(&sub, base, TEST_TOPIC);
+
+    atomic_int done = 0;
+    atomic_uint_fast64_t consumed = 0;
+    RunArgs args[RUN_PUBS + 1];
+    pthread_t th[RUN_PUBS + 1];
+    for (int i = 0; i < npubs; i++) {
+        args[i] = (RunArgs){.base = base, .pub_id = (uint16_t)(i + 1), .done = &done,
+                            .consumed = &consumed};
+        pthread_create(&th[i], NULL, run_publisher, &args[i]);
+    }
+    args[npubs] = (RunArgs){.base = base, .done = &done, .consumed = &consumed};
+    pthread_create(&th[npubs], NULL, run_resizer, &args[npubs]);
+
+    uint64_t want[RUN_PUBS + 1] = {0};
+    uint64_t got = 0, bad = 0;
+    while (got < (uint64_t)npubs * RUN_MSGS && !bad) {
+        uint64_t v;
+        int n = usrl_sub_next(&sub, (uint8_t *)&v, sizeof(v), NULL);
+        if (n == USRL_RING_NO_DATA) {
+            if (sub.skipped_count) bad = 1;
+            sched_yield();
+            continue;
+        }
+        uint64_t id = v >> 48;
+        if (n != (int)sizeof(v) || id == 0 || id > (uint64_t)npubs ||
+            (v & 0xFFFFFFFFFFFFULL) != want[id] + 1)
+            bad = 1;
+        else
+            want[id]++;
+        atomic_store(&consumed, ++got);
+    }
+
+    for (int i = 0; i <= npubs; i++) pthread_join(th[i], NULL);
+    TopicEntry *t = usrl_get_topic(base, TEST_TOPIC);
+    printf("  %s: %lu messages, ring grew to %u slots, %lu skipped\n", what, (unsigned long)got,
+           t->slot_count, (unsigned long)sub.skipped_count);
+    check(!bad && sub.skipped_count == 0 && t->slot_count > OLD_SLOTS, what);
+
+    region_destroy(base);
+}
+
+int main(void) {
+    printf("========================================================\n");
+    printf("  USRL RING RESIZE TEST                                 \n");
+    printf("========================================================\n");
+
+    test_cursors();
+    test_open_reservation();
+    test_concurrent(USRL_RING_TYPE_SWMR, 1, "SWMR: grow under load, nothing lost");
+    test_concurrent(USRL_RING_TYPE_MWMR, RUN_PUBS, "MWMR: grow under load, nothing lost");
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
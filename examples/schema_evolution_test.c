@@ -0,0 +1,275 @@
+/**
+ * @file schema_evolution_test.c
+ * @brief Cross-version schema reads and compatibility checks.
+ *
+ * VALIDATES:
+ * 1. A v2 reader reads v1 and v2 messages in place: moved fields are found,
+ *    a field v1 lacks reads as the reader's default.
+ * 2. A version that changes a field's type is refused by bind and check.
+ * 3. A message stamped with a version that is not bound gets no map, and
+ *    gets one once that version is bound.
+ * 4. A subscriber whose registered version is compatible but not bound yet
+ *    binds it and sees its own version.
+ * 5. A version already bound cannot be bound again with other field sizes,
+ *    even though the fingerprint (names and types) is the same.
+ *
+ * Usage: schema_evolution_test
+ */
+
+#define _GNU_SOURCE
+#include "usrl.h"
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_schema.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define TEST_SHM   "/usrl-schema-evo-test"
+#define TEST_TOPIC "evo"
+#define SCHEMA_ID  9
+
+#define COLOR_RED     "\x1b[31m"
+#define COLOR_GREEN   "\x1b[32m"
+#define COLOR_RESET   "\x1b[0m"
+
+static int g_fail = 0;
+
+static void check(int ok, const char *what) {
+    printf("%s[%s]%s %s\n", ok ? COLOR_GREEN : COLOR_RED, ok ? "PASS" : "FAIL", COLOR_RESET,
+           what);
+    if (!ok) g_fail = 1;
+}
+
+/* v1: a u64, b u32 */
+static UsrlSchema *schema_v1(const char *name) {
+    UsrlSchema *s = usrl_schema_create(SCHEMA_ID, name);
+    s->version = 1;
+    usrl_schema_add_field(s, "a", USRL_FIELD_U64, 8);
+    usrl_schema_add_field(s, "b", USRL_FIELD_U32, 4);
+    usrl_schema_finalize(s);
+    return s;
+}
+
+/* v2: b u32, a u64, c f64 (default 3.5) */
+static UsrlSchema *schema_v2(const char *name) {
+    UsrlSchema *s = usrl_schema_create(SCHEMA_ID, name);
+    s->version = 2;
+    usrl_schema_add_field(s, "b", USRL_FIELD_U32, 4);
+    usrl_schema_add_field(s, "a", USRL_FIELD_U64, 8);
+    usrl_schema_add_field(s, "c", USRL_FIELD_F64, 8);
+    usrl_schema_finalize(s);
+    double c = 3.5;
+    usrl_schema_set_default(s, usrl_schema_field_id(s, "c"), &c, sizeof(c));
+    return s;
+}
+
+/* ============================================================================
+ * CORE API: cross-version maps, rejection, unbound versions
+ * ============================================================================ */
+
+static void test_cross_version(void) {
+    UsrlTopicConfig topic;
+    memset(&topic, 0, sizeof(topic));
+    strcpy(topic.name, TEST_TOPIC);
+    topic.slot_count = 64;
+    topic.slot_size = 64;
+    topic.type = USRL_RING_TYPE_SWMR;
+
+    uint64_t size = 1024 * 1024;
+    shm_unlink(TEST_SHM);
+    void *base = NULL;
+    if (usrl_core_init(TEST_SHM, size, &topic, 1) == 0) base = usrl_core_map(TEST_SHM, size);
+    if (!base) {
+        check(0, "create region");
+        return;
+    }
+
+    UsrlSchema *v1 = schema_v1("Evo");
+    UsrlSchema *v2 = schema_v2("Evo");
+    check(usrl_schema_bind(base, TEST_TOPIC, v1) == 0, "bind v1");
+    check(usrl_schema_bind(base, TEST_TOPIC, v2) == 0, "bind v2 (fields moved and added)");
+
+    /* v3: a changes type */
+    UsrlSchema *v3 = usrl_schema_create(SCHEMA_ID, "Evo");
+    v3->version = 3;
+    usrl_schema_add_field(v3, "a", USRL_FIELD_F64, 8);
+    usrl_schema_finalize(v3);
+    check(usrl_schema_check(base, TEST_TOPIC, v3) == -2, "check refuses a changed field type");
+    check(usrl_schema_bind(base, TEST_TOPIC, v3) == -2, "bind refuses a changed field type");
+
+    UsrlPublisher pub;
+    UsrlSubscriber sub;
+    memset(&pub, 0, sizeof(pub));
+    memset(&sub, 0, sizeof(sub));
+    usrl_pub_init(&pub, base, TEST_TOPIC, 1);
+    usrl_sub_init(&sub, base, TEST_TOPIC);
+
+    uint8_t m1[12], m2[20];
+    uint64_t a = 11;
+    uint32_t b = 22;
+    double c = 5.5;
+    memcpy(m1, &a, 8);
+    memcpy(m1 + 8, &b, 4);
+    usrl_pub_set_schema(&pub, v1);
+    usrl_pub_publish(&pub, m1, sizeof(m1));
+
+    a = 33;
+    b = 44;
+    memcpy(m2, &b, 4);
+    memcpy(m2 + 4, &a, 8);
+    memcpy(m2 + 12, &c, 8);
+    usrl_pub_set_schema(&pub, v2);
+    usrl_pub_publish(&pub, m2, sizeof(m2));
+
+    /* v4 adds a field but is stamped before anyone binds it */
+    UsrlSchema *v4 = schema_v2("Evo");
+    v4->version = 4;
+    usrl_schema_add_field(v4, "d", USRL_FIELD_U32, 4);
+    usrl_schema_finalize(v4);
+    uint8_t m4[24] = {0};
+    memcpy(m4, m2, sizeof(m2));
+    usrl_pub_set_schema(&pub, v4);
+    usrl_pub_publish(&pub, m4, sizeof(m4));
+
+    UsrlSchemaReader rd;
+    check(usrl_schema_reader_init(&rd, base, TEST_TOPIC, v2) == 0, "reader init (v2)");
+    UsrlFieldId fa = usrl_schema_field_id(v2, "a");
+    UsrlFieldId fb = usrl_schema_field_id(v2, "b");
+    UsrlFieldId fc = usrl_schema_field_id(v2, "c");
+
+    uint8_t buf[64];
+    int n = usrl_sub_next(&sub, buf, sizeof(buf), NULL);
+    const UsrlSchemaMap *m = usrl_schema_reader_map(&rd, sub.schema_ver, (uint32_t)n);
+    check(m && usrl_map_get_u64(m, buf, fa) == 11 && usrl_map_get_u32(m, buf, fb) == 22 &&
+              usrl_map_get_f64(m, buf, fc) == 3.5,
+          "v1 message read as v2, missing field defaulted");
+
+    n = usrl_sub_next(&sub, buf, sizeof(buf), NULL);
+    m = usrl_schema_reader_map(&rd, sub.schema_ver, (uint32_t)n);
+    check(m && usrl_map_get_u64(m, buf, fa) == 33 && usrl_map_get_u32(m, buf, fb) == 44 &&
+              usrl_map_get_f64(m, buf, fc) == 5.5,
+          "v2 message read as v2");
+
+    n = usrl_sub_next(&sub, buf, sizeof(buf), NULL);
+    check(sub.schema_ver == 4 && !usrl_schema_reader_map(&rd, 4, (uint32_t)n),
+          "unbound v4 has no map");
+    check(!usrl_schema_reader_map(&rd, 4, (uint32_t)n) && rd.count == 2,
+          "unbound v4 is cached, not looked up again");
+    check(usrl_schema_bind(base, TEST_TOPIC, v4) == 0, "bind v4");
+    m = usrl_schema_reader_map(&rd, 4, (uint32_t)n);
+    check(m && usrl_map_get_u64(m, buf, fa) == 33, "v4 readable once bound");
+
+    usrl_schema_free(v1);
+    usrl_schema_free(v2);
+    usrl_schema_free(v3);
+    usrl_schema_free(v4);
+    usrl_core_unmap(base, size);
+    shm_unlink(TEST_SHM);
+}
+
+/* ============================================================================
+ * CORE API: one version, one layout
+ * ============================================================================ */
+
+/* v1: id u64, sym STRING[sym_len] */
+static UsrlSchema *schema_sym(uint32_t sym_len) {
+    UsrlSchema *s = usrl_schema_create(SCHEMA_ID, "EvoSym");
+    s->version = 1;
+    usrl_schema_add_field(s, "id", USRL_FIELD_U64, 8);
+    usrl_schema_add_field(s, "sym", USRL_FIELD_STRING, sym_len);
+    usrl_schema_finalize(s);
+    return s;
+}
+
+static void test_same_version_layout(void) {
+    UsrlTopicConfig topic;
+    memset(&topic, 0, sizeof(topic));
+    strcpy(topic.name, TEST_TOPIC);
+    topic.slot_count = 64;
+    topic.slot_size = 128;
+    topic.type = USRL_RING_TYPE_SWMR;
+
+    uint64_t size = 1024 * 1024;
+    shm_unlink(TEST_SHM);
+    void *base = NULL;
+    if (usrl_core_init(TEST_SHM, size, &topic, 1) == 0) base = usrl_core_map(TEST_SHM, size);
+    if (!base) {
+        check(0, "create region");
+        return;
+    }
+
+    UsrlSchema *narrow = schema_sym(8);
+    UsrlSchema *wide = schema_sym(32);
+    UsrlSchema *again = schema_sym(8);
+    check(narrow->fingerprint == wide->fingerprint, "STRING[8] and STRING[32] share a fingerprint");
+    check(usrl_schema_bind(base, TEST_TOPIC, narrow) == 0, "bind v1 with STRING[8]");
+    check(usrl_schema_check(base, TEST_TOPIC, wide) == -2, "check refuses v1 with STRING[32]");
+    check(usrl_schema_bind(base, TEST_TOPIC, wide) == -2, "bind refuses v1 with STRING[32]");
+    check(usrl_schema_bind(base, TEST_TOPIC, again) == 0, "binding the same v1 again is a no-op");
+
+    usrl_schema_free(narrow);
+    usrl_schema_free(wide);
+    usrl_schema_free(again);
+    usrl_core_unmap(base, size);
+    shm_unlink(TEST_SHM);
+}
+
+/* ============================================================================
+ * FACADE: subscriber binds its compatible local version
+ * ============================================================================ */
+
+static void test_sub_binds_local(void) {
+    usrl_sys_config_t sc;
+    memset(&sc, 0, sizeof(sc));
+    sc.app_name = "schema_evolution_test";
+    sc.log_level = USRL_LOG_ERROR;
+    usrl_ctx_t *ctx = usrl_init(&sc);
+
+    const char *topic = "evo.facade";
+    char path[64];
+    snprintf(path, sizeof(path), "/usrl-%s", topic);
+    shm_unlink(path);
+
+    usrl_schema_register(schema_v1("EvoFacade"));
+    usrl_pub_config_t pc;
+    memset(&pc, 0, sizeof(pc));
+    pc.topic = topic;
+    pc.slot_count = 64;
+    pc.slot_size = 64;
+    pc.schema_name = "EvoFacade";
+    usrl_pub_t *pub = usrl_pub_create(ctx, &pc);
+    check(pub != NULL, "publisher binds v1");
+
+    /* This process now knows v2; nobody has bound it */
+    usrl_schema_register(schema_v2("EvoFacade"));
+    usrl_sub_t *sub = usrl_sub_create(ctx, topic);
+    const UsrlSchema *s = sub ? usrl_sub_schema(sub) : NULL;
+    check(s && s->version == 2, "subscriber binds its local v2 and reads as v2");
+
+    if (sub) usrl_sub_destroy(sub);
+    if (pub) usrl_pub_destroy(pub);
+    usrl_shutdown(ctx);
+    shm_unlink(path);
+}
+
+int main(void) {
+    printf("========================================================\n");
+    printf("  USRL SCHEMA EVOLUTION TEST                            \n");
+    printf("========================================================\n");
+
+    test_cross_version();
+    test_same_version_layout();
+    test_sub_binds_local();
+
+    printf("\n========================================================\n");
+    if (g_fail) {
+        printf(COLOR_RED "  RESULT: FAIL" COLOR_RESET "\n");
+        printf("========================================================\n");
+        return 1;
+    }
+    printf(COLOR_GREEN "  RESULT: PASS" COLOR_RESET "\n");
+    printf("========================================================\n");
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "usrl_core.h"
+#include "usrl_backpressure.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -73,6 +74,9 @@ int main(void)
     fclose(f);
 
     UsrlTopicConfig topics[MAX_CONFIG_TOPICS];
+    memset(topics, 0, sizeof(topics));
+    UsrlBackpressureMode bp_modes[MAX_CONFIG_TOPICS] = {0};
+    uint32_t bp_thresholds[MAX_CONFIG_TOPICS] = {0};
     int count = 0;
 
     // Default 128MB
@@ -106,6 +110,10 @@ int main(void)
                 char *slots_p = find_key(topic_start, "slots");
                 char *size_p = find_key(topic_start, "payload_size");
                 char *type_p = find_key(topic_start, "type");
+                char *fair_p = find_key(topic_start, "fair");
+                char *bp_p = find_key(topic_start, "backpressure");
+                char *thr_p = find_key(topic_start, "lag_threshold");
+                char *topic_end = strchr(topic_start, '}');
 
                 if (name_p && slots_p && size_p)
                 {
@@ -125,11 +133,32 @@ int main(void)
                         }
                     }
 
-                    printf("  Loaded: %-20s (Slots: %d, Size: %d, Type: %s)\n",
+                    // Optional per-writer fairness (keys are searched past this object, so bound it)
+                    if (fair_p && topic_end && fair_p < topic_end && strncmp(fair_p, "true", 4) == 0)
+                    {
+                        topics[count].flags |= USRL_TOPIC_FAIR;
+                    }
+
+                    // Optional lag policy: "drop" | "block" | "throttle"
+                    if (bp_p && topic_end && bp_p < topic_end)
+                    {
+                        char bp_str[16] = {0};
+                        parse_string_val(bp_p, bp_str, 16);
+                        if (strcmp(bp_str, "drop") == 0) bp_modes[count] = USRL_BP_DROP;
+                        else if (strcmp(bp_str, "block") == 0) bp_modes[count] = USRL_BP_BLOCK;
+                        else if (strcmp(bp_str, "throttle") == 0) bp_modes[count] = USRL_BP_THROTTLE;
+                    }
+                    if (thr_p && topic_end && thr_p < topic_end)
+                    {
+                        bp_thresholds[count] = (uint32_t)parse_int_val(thr_p);
+                    }
+
+                    printf("  Loaded: %-20s (Slots: %d, Size: %d, Type: %s%s)\n",
                            topics[count].name,
                            topics[count].slot_count,
                            topics[count].slot_size,
-                           topics[count].type == USRL_RING_TYPE_SWMR ? "SWMR" : "MWMR");
+                           topics[count].type == USRL_RING_TYPE_SWMR ? "SWMR" : "MWMR",
+                           (topics[count].flags & USRL_TOPIC_FAIR) ? ", fair" : "");
                     count++;
                 }
 
@@ -161,5 +190,17 @@ int main(void)
         return 1;
     }
 
+    // Lag policies live in the region, so apply them once it exists
+    void *base = usrl_core_map("/usrl_core", mem_size);
+    if (base)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (bp_modes[i] != USRL_BP_NONE)
+                usrl_bp_set_policy(base, topics[i].name, bp_modes[i], bp_thresholds[i]);
+        }
+        usrl_core_unmap(base, mem_size);
+    }
+
     return 0;
 }
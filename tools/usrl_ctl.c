@@ -1,6 +1,9 @@
 #define _GNU_SOURCE
 #include "usrl_core.h"
 #include "usrl_ring.h"
+#include "usrl_checkpoint.h"
+#include "usrl_backpressure.h"
+#include "usrl_schema.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,6 +43,50 @@ static void print_hexdump(const uint8_t *buf, uint32_t len) {
     if (len % 16 != 0) printf("\n");
 }
 
+/* One line of "name=value" pairs, laid out by the topic's schema */
+static void print_fields(const UsrlSchema *s, const uint8_t *buf, uint32_t len) {
+    if (len < s->total_size) {
+        printf("(%u bytes, schema '%s' needs %u) ", len, s->name, s->total_size);
+        print_hexdump(buf, (len > 16) ? 16 : len);
+        return;
+    }
+    for (uint32_t i = 0; i < s->field_count; i++) {
+        const UsrlField *f = &s->fields[i];
+        const uint8_t *p = buf + f->offset;
+        union { uint64_t u64; int64_t i64; double f64; uint32_t u32; int32_t i32; float f32; } v;
+        memcpy(&v, p, (f->type <= USRL_FIELD_F32) ? usrl_field_width(f) : 0);
+
+        printf("%s%s=", i ? " " : "", f->name);
+        switch (f->type) {
+            case USRL_FIELD_U64: printf("%lu", v.u64); break;
+            case USRL_FIELD_I64: printf("%ld", v.i64); break;
+            case USRL_FIELD_F64: printf("%g", v.f64); break;
+            case USRL_FIELD_U32: printf("%u", v.u32); break;
+            case USRL_FIELD_I32: printf("%d", v.i32); break;
+            case USRL_FIELD_F32: printf("%g", (double)v.f32); break;
+            case USRL_FIELD_STRING:
+                printf("\"%.*s\"", (int)strnlen((const char *)p, f->size), (const char *)p);
+                break;
+            case USRL_FIELD_VSTRING: {
+                UsrlVarView s = usrl_var_ref_view(buf, len, p);
+                printf("\"%.*s\"", (int)s.len, s.ptr ? (const char *)s.ptr : "");
+                break;
+            }
+            case USRL_FIELD_VBYTES: {
+                UsrlVarView b = usrl_var_ref_view(buf, len, p);
+                for (uint32_t k = 0; k < b.len && k < 16; k++) printf("%02X", b.ptr[k]);
+                if (b.len > 16) printf("..");
+                break;
+            }
+            default:
+                for (uint32_t b = 0; b < f->size && b < 16; b++) printf("%02X", p[b]);
+                if (f->size > 16) printf("..");
+                break;
+        }
+    }
+    printf("\n");
+}
+
 /* Smart Map: Reads header first to find total size, then maps everything */
 static void* map_system(void) {
     /* Note: In real USRL apps, usrl_core_map handles this. 
@@ -100,8 +147,7 @@ static void do_list(void *base) {
         TopicEntry *t = &topics[i];
         RingDesc *r = (RingDesc*)((uint8_t*)base + t->ring_desc_offset);
 
-        // Correct atomic load
-        uint64_t head = atomic_load_explicit(&r->w_head, memory_order_relaxed);
+        uint64_t head = usrl_ring_head(r);
 
         printf("%-20s | %-5s | %-8u | %-8u | %-12lu\n",
                t->name,
@@ -121,7 +167,7 @@ static void do_info(void *base, const char *topic_name) {
     }
 
     RingDesc *r = (RingDesc*)((uint8_t*)base + t->ring_desc_offset);
-    uint64_t head = atomic_load_explicit(&r->w_head, memory_order_relaxed);
+    uint64_t head = usrl_ring_head(r);
 
     printf("\nTopic: %s\n", t->name);
     printf("Type:  %s\n", (t->type == USRL_RING_TYPE_SWMR) ? "SWMR" : "MWMR");
@@ -132,6 +178,63 @@ static void do_info(void *base, const char *topic_name) {
     printf("  Base Offset: 0x%lx\n", r->base_offset);
     printf("\nMemory:\n");
     printf("  Ring Size:  %.2f MB\n", (double)(r->slot_count * r->slot_size) / (1024.0 * 1024.0));
+
+    UsrlSchema *schema = usrl_schema_attach(base, topic_name);
+    if (schema) {
+        printf("\nSchema: %s (id %u, v%u, fingerprint %08x, %u bytes)\n", schema->name,
+               schema->schema_id, schema->version, schema->fingerprint, schema->total_size);
+        static const char *type_names[] = {"u64",   "i64",    "f64",    "u32",    "i32",
+                                            "f32",   "bytes",  "string", "vbytes", "vstring"};
+        for (uint32_t i = 0; i < schema->field_count; i++) {
+            const UsrlField *f = &schema->fields[i];
+            printf("  %-24s %-6s @%-5u %u\n", f->name,
+                   (f->type <= USRL_FIELD_VSTRING) ? type_names[f->type] : "?", f->offset,
+                   USRL_FIELD_IS_VAR(f->type) ? f->size : usrl_field_width(f));
+        }
+        usrl_schema_free(schema);
+    }
+
+    static const char *bp_names[] = {"none", "drop", "block", "throttle"};
+    UsrlReaderTable *rt = (UsrlReaderTable *)((uint8_t *)base + t->readers_offset);
+    uint32_t mode = atomic_load_explicit(&rt->bp_mode, memory_order_relaxed);
+    uint32_t thr = atomic_load_explicit(&rt->lag_threshold, memory_order_relaxed);
+    printf("\nBackpressure: %s (lag threshold %u slots)\n",
+           (mode <= USRL_BP_THROTTLE) ? bp_names[mode] : "?",
+           thr ? thr : r->slot_count / 2);
+    UsrlReaderStats rs[USRL_MAX_READERS];
+    int nr = usrl_reader_stats(base, topic_name, rs, USRL_MAX_READERS);
+    if (nr > 0) {
+        printf("  %-7s | %-12s | %-8s | %-8s | %-12s | %-8s | %-10s\n",
+               "PID", "CURSOR", "LAG", "MAX LAG", "READS", "SKIPS", "RATE");
+    }
+    for (int i = 0; i < nr; i++) {
+        printf("  %-7u | %-12lu | %-8lu | %-8lu | %-12lu | %-8lu | %lu Hz\n",
+               rs[i].pid, rs[i].cursor, rs[i].lag, rs[i].max_lag, rs[i].reads,
+               rs[i].skips, rs[i].read_rate_hz);
+    }
+
+    UsrlWriterStats ws[USRL_MAX_WRITERS];
+    int n = usrl_writer_stats(base, topic_name, ws, USRL_MAX_WRITERS);
+    if (t->type == USRL_RING_TYPE_MWMR)
+        printf("\nWriters (%s):\n", (t->flags & USRL_TOPIC_FAIR) ? "fair share" : "unrestricted");
+    else
+        printf("\nWriters:\n");
+    UsrlWriterTable *wt = (UsrlWriterTable *)((uint8_t *)base + t->writers_offset);
+    uint32_t untracked = atomic_load_explicit(&wt->untracked, memory_order_relaxed);
+    if (untracked)
+        printf("  %u attach(es) found the table full: no counters%s\n", untracked,
+               (t->flags & USRL_TOPIC_FAIR) ? ", no fair share" : "");
+    if (n <= 0) {
+        printf("  (none attached)\n");
+        return;
+    }
+    printf("  %-6s | %-7s | %-6s | %-12s | %-10s | %-10s | %-10s\n",
+           "PUB", "PID", "WEIGHT", "PUBLISHED", "DROPPED", "TIMEOUTS", "THROTTLED");
+    for (int i = 0; i < n; i++) {
+        printf("  %-6u | %-7u | %-6u | %-12lu | %-10lu | %-10lu | %-10lu\n",
+               ws[i].pub_id, ws[i].pid, ws[i].weight, ws[i].published, ws[i].dropped,
+               ws[i].timeouts, ws[i].throttled);
+    }
 }
 
 static void do_tail(void *base, const char *topic_name) {
@@ -141,7 +244,13 @@ static void do_tail(void *base, const char *topic_name) {
         return;
     }
 
-    printf("Tailing topic '%s' (Ctrl+C to stop)...\n", topic_name);
+    /* Topics with a bound schema print decoded fields instead of bytes */
+    UsrlSchema *schema = usrl_schema_attach(base, topic_name);
+    if (schema)
+        printf("Tailing topic '%s' schema '%s' v%u (Ctrl+C to stop)...\n", topic_name,
+               schema->name, schema->version);
+    else
+        printf("Tailing topic '%s' (Ctrl+C to stop)...\n", topic_name);
 
     UsrlSubscriber sub;
     
@@ -150,11 +259,12 @@ static void do_tail(void *base, const char *topic_name) {
 
     // Set last_seq to head so we only see NEW messages
     RingDesc *d = sub.desc;
-    sub.last_seq = atomic_load_explicit(&d->w_head, memory_order_acquire);
+    sub.last_seq = usrl_ring_head(d);
 
     uint8_t *buf = malloc(d->slot_size);
     if (!buf) {
         fprintf(stderr, "OOM\n");
+        usrl_schema_free(schema);
         return;
     }
     
@@ -167,6 +277,17 @@ static void do_tail(void *base, const char *topic_name) {
             printf("[%u] ", pid);
             if (len == 0) {
                 printf("(Empty Message)\n");
+            } else if (schema) {
+                /* Writers of another version: decode with the layout they stamped */
+                if (sub.schema_ver && sub.schema_ver != schema->version) {
+                    UsrlSchema *other = usrl_schema_attach_version(base, topic_name, sub.schema_ver);
+                    if (other) {
+                        usrl_schema_free(schema);
+                        schema = other;
+                    }
+                }
+                if (sub.schema_ver && sub.schema_ver != schema->version) printf("v%u ", sub.schema_ver);
+                print_fields(schema, buf, (uint32_t)len);
             } else if (is_printable(buf, len)) {
                 // Ensure null termination for printf if not present
                 if (buf[len-1] != 0) {
@@ -188,6 +309,90 @@ static void do_tail(void *base, const char *topic_name) {
     }
     
     free(buf);
+    usrl_schema_free(schema);
+}
+
+static int do_checkpoint(void *base, const char *file) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = usrl_checkpoint_save(base, file);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (rc < 0) {
+        fprintf(stderr, "Checkpoint to '%s' failed (rc=%d).\n", file, rc);
+        return 1;
+    }
+    printf("Checkpointed %d topics to '%s' in %.1f ms\n", rc, file,
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    return 0;
+}
+
+static int do_restore(void *base, const char *file) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = usrl_checkpoint_restore(base, file);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (rc < 0) {
+        fprintf(stderr, "Restore from '%s' failed (rc=%d).\n", file, rc);
+        return 1;
+    }
+    printf("Restored %d topics from '%s' in %.1f ms\n", rc, file,
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    printf("(topics already published to, or with a different slot size, are skipped)\n");
+    return 0;
+}
+
+static int do_resize(void *base, const char *topic_name, const char *slots_arg) {
+    TopicEntry *t = usrl_get_topic(base, topic_name);
+    if (!t) {
+        fprintf(stderr, "Topic '%s' not found.\n", topic_name);
+        return 1;
+    }
+
+    uint32_t old_slots = t->slot_count;
+    long slots = strtol(slots_arg, NULL, 10);
+    if (slots <= 0 || slots > (long)UINT32_MAX) {
+        fprintf(stderr, "Invalid slot count '%s'.\n", slots_arg);
+        return 1;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = usrl_ring_resize(base, topic_name, (uint32_t)slots);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (rc != 0) {
+        const char *why = (rc == -2) ? "resize already in progress"
+                        : (rc == -4) ? "not enough free space in region"
+                        : "new size must be larger than current";
+        fprintf(stderr, "Resize of '%s' failed: %s (rc=%d).\n", topic_name, why, rc);
+        return 1;
+    }
+    printf("Resized '%s' from %u to %u slots in %.1f ms\n", topic_name,
+           old_slots, t->slot_count,
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    return 0;
+}
+
+static int do_bp(void *base, const char *topic_name, const char *mode_arg, const char *thr_arg) {
+    UsrlBackpressureMode mode;
+    if (strcmp(mode_arg, "none") == 0) mode = USRL_BP_NONE;
+    else if (strcmp(mode_arg, "drop") == 0) mode = USRL_BP_DROP;
+    else if (strcmp(mode_arg, "block") == 0) mode = USRL_BP_BLOCK;
+    else if (strcmp(mode_arg, "throttle") == 0) mode = USRL_BP_THROTTLE;
+    else {
+        fprintf(stderr, "Unknown mode '%s' (none|drop|block|throttle).\n", mode_arg);
+        return 1;
+    }
+
+    uint32_t thr = thr_arg ? (uint32_t)strtoul(thr_arg, NULL, 10) : 0;
+    if (usrl_bp_set_policy(base, topic_name, mode, thr) != 0) {
+        fprintf(stderr, "Topic '%s' not found.\n", topic_name);
+        return 1;
+    }
+    printf("Backpressure for '%s' set to %s\n", topic_name, mode_arg);
+    return 0;
 }
 
 /* --------------------------------------------------------------------------
@@ -200,6 +405,11 @@ void usage() {
     printf("  list            List all topics\n");
     printf("  info <topic>    Show topic details\n");
     printf("  tail <topic>    Follow topic data\n");
+    printf("  checkpoint <file>  Snapshot all rings to file (live)\n");
+    printf("  restore <file>     Load a snapshot into an unused region\n");
+    printf("  resize <topic> <slots>  Grow a topic's ring (live)\n");
+    printf("  bp <topic> <none|drop|block|throttle> [lag_threshold]\n");
+    printf("                  Set the topic's lag policy\n");
     exit(1);
 }
 
@@ -219,6 +429,22 @@ int main(int argc, char **argv) {
         if (argc < 3) usage();
         do_tail(base, argv[2]);
     }
+    else if (strcmp(argv[1], "checkpoint") == 0) {
+        if (argc < 3) usage();
+        return do_checkpoint(base, argv[2]);
+    }
+    else if (strcmp(argv[1], "restore") == 0) {
+        if (argc < 3) usage();
+        return do_restore(base, argv[2]);
+    }
+    else if (strcmp(argv[1], "resize") == 0) {
+        if (argc < 4) usage();
+        return do_resize(base, argv[2], argv[3]);
+    }
+    else if (strcmp(argv[1], "bp") == 0) {
+        if (argc < 4) usage();
+        return do_bp(base, argv[2], argv[3], (argc >= 5) ? argv[4] : NULL);
+    }
     else {
         usage();
     }
@@ -0,0 +1,551 @@
+/**
+ * @file usrl_exporter.c
+ * @brief OpenMetrics exporter for USRL regions.
+ *
+ * Maps each region read-only and serves its topic, writer and reader tables
+ * as OpenMetrics text over HTTP (TCP or a Unix socket). A scrape only loads
+ * from the region: counters are read relaxed, nothing is written, so
+ * publishers and subscribers never see their cache lines stolen for
+ * ownership by a scrape.
+ *
+ *   usrl-exporter [-l host:port | -u socket_path] [-1] [region ...]
+ *
+ * Regions default to /usrl_core. A region that disappears or is recreated
+ * is remapped on the next scrape. -1 writes one scrape to stdout and exits.
+ * Clients are served one at a time; a client that stops reading or sending
+ * for two seconds is dropped.
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_latency.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SHM_PATH "/usrl_core"
+#define DEFAULT_LISTEN "127.0.0.1:9410"
+#define MAX_REGIONS 32
+#define REQ_MAX 4096
+#define RECV_TIMEOUT_S 2
+#define SEND_TIMEOUT_S 2 /* one client at a time: a stalled reader must not hold the server */
+
+#define CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+/* --------------------------------------------------------------------------
+ * OUTPUT BUFFER
+ * -------------------------------------------------------------------------- */
+typedef struct {
+    char *p;
+    size_t len;
+    size_t cap;
+} Buf;
+
+static void buf_printf(Buf *b, const char *fmt, ...) {
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(b->p + b->len, b->cap - b->len, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if ((size_t)n < b->cap - b->len) {
+            b->len += (size_t)n;
+            return;
+        }
+        size_t cap = b->cap ? b->cap * 2 : 64 * 1024;
+        while (cap - b->len <= (size_t)n) cap *= 2;
+        char *p = realloc(b->p, cap);
+        if (!p) return;
+        b->p = p;
+        b->cap = cap;
+    }
+}
+
+/* Label values escape backslash, double quote and newline */
+static void buf_label(Buf *b, const char *s, size_t max) {
+    for (size_t i = 0; i < max && s[i]; i++) {
+        if (s[i] == '\\') buf_printf(b, "\\\\");
+        else if (s[i] == '"') buf_printf(b, "\\\"");
+        else if (s[i] == '\n') buf_printf(b, "\\n");
+        else buf_printf(b, "%c", s[i]);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * REGIONS
+ * -------------------------------------------------------------------------- */
+typedef struct {
+    const char *path;
+    void *base;
+    size_t size;
+    ino_t ino;
+} Region;
+
+static void region_unmap(Region *r) {
+    if (r->base) munmap(r->base, r->size);
+    r->base = NULL;
+    r->size = 0;
+}
+
+/*
+ * Make sure r->base maps the current object behind r->path. Returns 0 when
+ * mapped, -1 when the region is missing, still being created, or has a
+ * different layout version.
+ */
+static int region_refresh(Region *r) {
+    int fd = shm_open(r->path, O_RDONLY, 0);
+    if (fd < 0) {
+        region_unmap(r);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        region_unmap(r);
+        return -1;
+    }
+    if (r->base && st.st_ino == r->ino) {
+        close(fd);
+        return 0;
+    }
+    region_unmap(r);
+
+    CoreHeader hdr;
+    if (pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+        hdr.magic != USRL_MAGIC || hdr.version != USRL_LAYOUT_VERSION ||
+        hdr.mmap_size > (uint64_t)st.st_size) {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, hdr.mmap_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    r->base = base;
+    r->size = hdr.mmap_size;
+    r->ino = st.st_ino;
+    return 0;
+}
+
+static int in_region(const Region *r, uint64_t off, uint64_t len) {
+    return off != 0 && off + len >= off && off + len <= r->size;
+}
+
+static inline uint64_t ld64(const atomic_uint_fast64_t *p) {
+    return atomic_load_explicit((atomic_uint_fast64_t *)p, memory_order_relaxed);
+}
+
+static inline uint32_t ld32(const atomic_uint_least32_t *p) {
+    return atomic_load_explicit((atomic_uint_least32_t *)p, memory_order_relaxed);
+}
+
+/* --------------------------------------------------------------------------
+ * METRIC FAMILIES
+ * -------------------------------------------------------------------------- */
+typedef struct {
+    const Region *reg;
+    const TopicEntry *t;
+    const RingDesc *ring;
+    const UsrlWriterTable *wt;
+    const UsrlReaderTable *rt;
+    uint64_t head;
+} TopicView;
+
+typedef void (*EmitFn)(Buf *b, const char *name, const TopicView *v, size_t arg);
+
+typedef struct {
+    const char *name;
+    const char *type;
+    const char *help;
+    EmitFn emit;
+    size_t arg; /* field offset for the generic table emitters */
+} Family;
+
+static void labels(Buf *b, const TopicView *v) {
+    buf_printf(b, "region=\"");
+    buf_label(b, v->reg->path, SIZE_MAX);
+    buf_printf(b, "\",topic=\"");
+    buf_label(b, v->t->name, USRL_MAX_TOPIC_NAME);
+    buf_printf(b, "\",type=\"%s\"", v->t->type == USRL_RING_TYPE_MWMR ? "mwmr" : "swmr");
+}
+
+static void emit_head(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    (void)arg;
+    buf_printf(b, "%s_total{", name);
+    labels(b, v);
+    buf_printf(b, "} %lu\n", v->head);
+}
+
+static void emit_slots(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    (void)arg;
+    buf_printf(b, "%s{", name);
+    labels(b, v);
+    buf_printf(b, "} %u\n", v->ring->slot_count);
+}
+
+/* Fastest head rate any registered reader measured */
+static void emit_pub_rate(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    (void)arg;
+    int seen = 0;
+    uint64_t rate = 0;
+    for (int i = 0; i < USRL_MAX_READERS; i++) {
+        const UsrlReaderEntry *e = &v->rt->entries[i];
+        if (ld32(&e->owner) == 0) continue;
+        uint64_t r = ld64(&e->head_rate_hz);
+        if (r > rate) rate = r;
+        seen = 1;
+    }
+    if (!seen) return;
+    buf_printf(b, "%s{", name);
+    labels(b, v);
+    buf_printf(b, "} %lu\n", rate);
+}
+
+/* One sample per attached writer; arg is the counter's offset in the entry */
+static void emit_writer(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    for (int i = 0; i < USRL_MAX_WRITERS; i++) {
+        const UsrlWriterEntry *e = &v->wt->entries[i];
+        uint32_t owner = ld32(&e->owner);
+        if (owner == 0) continue;
+        buf_printf(b, "%s_total{", name);
+        labels(b, v);
+        buf_printf(b, ",pub_id=\"%u\",pid=\"%u\"} %lu\n", owner - 1, e->pid,
+                   ld64((const atomic_uint_fast64_t *)((const uint8_t *)e + arg)));
+    }
+}
+
+static void reader_labels(Buf *b, const TopicView *v, int slot, const UsrlReaderEntry *e) {
+    labels(b, v);
+    buf_printf(b, ",slot=\"%d\",pid=\"%u\"", slot, e->pid);
+}
+
+static void emit_lag(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    (void)arg;
+    for (int i = 0; i < USRL_MAX_READERS; i++) {
+        const UsrlReaderEntry *e = &v->rt->entries[i];
+        if (ld32(&e->owner) == 0) continue;
+        uint64_t cursor = ld64(&e->cursor);
+        buf_printf(b, "%s{", name);
+        reader_labels(b, v, i, e);
+        buf_printf(b, "} %lu\n", v->head > cursor ? v->head - cursor : 0);
+    }
+}
+
+/* arg is the field's offset in the entry; counters get the _total suffix */
+static void emit_reader(Buf *b, const char *name, const TopicView *v, size_t arg,
+                        const char *suffix) {
+    for (int i = 0; i < USRL_MAX_READERS; i++) {
+        const UsrlReaderEntry *e = &v->rt->entries[i];
+        if (ld32(&e->owner) == 0) continue;
+        buf_printf(b, "%s%s{", name, suffix);
+        reader_labels(b, v, i, e);
+        buf_printf(b, "} %lu\n", ld64((const atomic_uint_fast64_t *)((const uint8_t *)e + arg)));
+    }
+}
+
+static void emit_reader_counter(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    emit_reader(b, name, v, arg, "_total");
+}
+
+static void emit_reader_gauge(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    emit_reader(b, name, v, arg, "");
+}
+
+/*
+ * Cumulative buckets at each power of two (every USRL_LAT_SUB histogram
+ * buckets), in seconds. The last group also holds overflow, so it is +Inf.
+ * The count is summed from the buckets so it always matches +Inf.
+ */
+static void emit_latency(Buf *b, const char *name, const TopicView *v, size_t arg) {
+    (void)arg;
+    for (int i = 0; i < USRL_MAX_READERS; i++) {
+        const UsrlReaderEntry *e = &v->rt->entries[i];
+        if (ld32(&e->owner) == 0) continue;
+        uint64_t off = ld64(&e->lat_offset);
+        if (!in_region(v->reg, off, sizeof(UsrlLatencyHist))) continue;
+        const UsrlLatencyHist *h = (const UsrlLatencyHist *)((const uint8_t *)v->reg->base + off);
+
+        uint64_t cum = 0;
+        for (uint32_t k = 0; k < USRL_LAT_BUCKETS; k++) {
+            cum += ld64(&h->buckets[k]);
+            if ((k + 1) % USRL_LAT_SUB != 0) continue;
+            buf_printf(b, "%s_bucket{", name);
+            reader_labels(b, v, i, e);
+            if (k == USRL_LAT_BUCKETS - 1)
+                buf_printf(b, ",le=\"+Inf\"} %lu\n", cum);
+            else
+                buf_printf(b, ",le=\"%.9g\"} %lu\n", (double)usrl_latency_bucket_max(k) / 1e9, cum);
+        }
+        buf_printf(b, "%s_count{", name);
+        reader_labels(b, v, i, e);
+        buf_printf(b, "} %lu\n", cum);
+        buf_printf(b, "%s_sum{", name);
+        reader_labels(b, v, i, e);
+        buf_printf(b, "} %.9g\n", (double)ld64(&h->sum_ns) / 1e9);
+    }
+}
+
+static const Family g_families[] = {
+    {"usrl_topic_published", "counter", "Messages published (ring head)", emit_head, 0},
+    {"usrl_topic_slots", "gauge", "Ring slots", emit_slots, 0},
+    {"usrl_topic_publish_rate_hz", "gauge", "Publish rate seen by the fastest reader",
+     emit_pub_rate, 0},
+    {"usrl_writer_published", "counter", "Messages committed by this writer", emit_writer,
+     offsetof(UsrlWriterEntry, published)},
+    {"usrl_writer_dropped", "counter", "Publishes refused by rate limit, lag policy or full ring",
+     emit_writer, offsetof(UsrlWriterEntry, dropped)},
+    {"usrl_writer_timeouts", "counter", "MWMR publishes that timed out", emit_writer,
+     offsetof(UsrlWriterEntry, timeouts)},
+    {"usrl_writer_throttled", "counter", "MWMR publishes refused over fair share", emit_writer,
+     offsetof(UsrlWriterEntry, throttled)},
+    {"usrl_subscriber_lag", "gauge", "Messages between the head and this reader", emit_lag, 0},
+    {"usrl_subscriber_max_lag", "gauge", "Largest lag this reader has seen", emit_reader_gauge,
+     offsetof(UsrlReaderEntry, max_lag)},
+    {"usrl_subscriber_reads", "counter", "Messages delivered to this reader", emit_reader_counter,
+     offsetof(UsrlReaderEntry, reads)},
+    {"usrl_subscriber_skips", "counter", "Messages this reader lost to overrun",
+     emit_reader_counter, offsetof(UsrlReaderEntry, skips)},
+    {"usrl_subscriber_read_rate_hz", "gauge", "Read rate over the last window", emit_reader_gauge,
+     offsetof(UsrlReaderEntry, read_rate_hz)},
+    {"usrl_subscriber_latency_seconds", "histogram", "Publish-to-consume latency", emit_latency,
+     0},
+};
+
+/* --------------------------------------------------------------------------
+ * SCRAPE
+ * -------------------------------------------------------------------------- */
+static int topic_view(const Region *r, const TopicEntry *t, TopicView *v) {
+    if (!in_region(r, t->ring_desc_offset, sizeof(RingDesc)) ||
+        !in_region(r, t->writers_offset, sizeof(UsrlWriterTable)) ||
+        !in_region(r, t->readers_offset, sizeof(UsrlReaderTable)))
+        return -1;
+
+    const uint8_t *base = (const uint8_t *)r->base;
+    v->reg = r;
+    v->t = t;
+    v->ring = (const RingDesc *)(base + t->ring_desc_offset);
+    v->wt = (const UsrlWriterTable *)(base + t->writers_offset);
+    v->rt = (const UsrlReaderTable *)(base + t->readers_offset);
+    v->head = ld64(&v->ring->w_head) & ~USRL_HEAD_RESIZING;
+    return 0;
+}
+
+/* Topics visible in a mapped region; the count is the only acquire load */
+static uint32_t region_topics(const Region *r, const TopicEntry **out) {
+    const CoreHeader *hdr = (const CoreHeader *)r->base;
+    uint32_t n = atomic_load_explicit((atomic_uint_least32_t *)&hdr->topic_count,
+                                      memory_order_acquire);
+    if (n > hdr->topic_capacity) n = hdr->topic_capacity;
+    if (!in_region(r, hdr->topic_table_offset, (uint64_t)n * sizeof(TopicEntry))) return 0;
+    *out = (const TopicEntry *)((const uint8_t *)r->base + hdr->topic_table_offset);
+    return n;
+}
+
+static void scrape(Buf *b, Region *regs, int nregs) {
+    b->len = 0;
+    int up[MAX_REGIONS];
+    for (int i = 0; i < nregs; i++) up[i] = region_refresh(&regs[i]) == 0;
+
+    buf_printf(b, "# TYPE usrl_region_up gauge\n# HELP usrl_region_up Region is mapped\n");
+    for (int i = 0; i < nregs; i++) {
+        buf_printf(b, "usrl_region_up{region=\"");
+        buf_label(b, regs[i].path, SIZE_MAX);
+        buf_printf(b, "\"} %d\n", up[i]);
+    }
+
+    buf_printf(b, "# TYPE usrl_region_used_bytes gauge\n"
+                  "# HELP usrl_region_used_bytes Bytes allocated from the region\n");
+    for (int i = 0; i < nregs; i++) {
+        if (!up[i]) continue;
+        const CoreHeader *hdr = (const CoreHeader *)regs[i].base;
+        buf_printf(b, "usrl_region_used_bytes{region=\"");
+        buf_label(b, regs[i].path, SIZE_MAX);
+        buf_printf(b, "\"} %lu\n", ld64(&hdr->alloc_offset));
+    }
+
+    for (size_t f = 0; f < sizeof(g_families) / sizeof(g_families[0]); f++) {
+        const Family *fam = &g_families[f];
+        buf_printf(b, "# TYPE %s %s\n# HELP %s %s\n", fam->name, fam->type, fam->name, fam->help);
+        for (int i = 0; i < nregs; i++) {
+            if (!up[i]) continue;
+            const TopicEntry *topics = NULL;
+            uint32_t n = region_topics(&regs[i], &topics);
+            for (uint32_t k = 0; k < n; k++) {
+                TopicView v;
+                if (topic_view(&regs[i], &topics[k], &v) == 0) fam->emit(b, fam->name, &v, fam->arg);
+            }
+        }
+    }
+    buf_printf(b, "# EOF\n");
+}
+
+/* --------------------------------------------------------------------------
+ * HTTP
+ * -------------------------------------------------------------------------- */
+static int send_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void serve_one(int fd, Buf *b, Region *regs, int nregs) {
+    char req[REQ_MAX];
+    size_t len = 0;
+    while (len < sizeof(req) - 1) {
+        ssize_t n = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (n <= 0) break;
+        len += (size_t)n;
+        req[len] = '\0';
+        if (strstr(req, "\r\n\r\n") || strstr(req, "\n\n")) break;
+    }
+    req[len] = '\0';
+
+    char hdr[256];
+    if (strncmp(req, "GET /metrics", 12) != 0 || (req[12] != ' ' && req[12] != '?')) {
+        const char *msg = "Not Found\n";
+        int n = snprintf(hdr, sizeof(hdr),
+                         "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n"
+                         "Content-Length: %zu\r\nConnection: close\r\n\r\n%s",
+                         strlen(msg), msg);
+        send_all(fd, hdr, (size_t)n);
+        return;
+    }
+
+    scrape(b, regs, nregs);
+    int n = snprintf(hdr, sizeof(hdr),
+                     "HTTP/1.1 200 OK\r\nContent-Type: " CONTENT_TYPE "\r\n"
+                     "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                     b->len);
+    if (send_all(fd, hdr, (size_t)n) == 0) send_all(fd, b->p, b->len);
+}
+
+static int listen_tcp(const char *spec) {
+    char host[256];
+    const char *colon = strrchr(spec, ':');
+    if (!colon || (size_t)(colon - spec) >= sizeof(host)) return -1;
+    memcpy(host, spec, (size_t)(colon - spec));
+    host[colon - spec] = '\0';
+
+    struct addrinfo hints = {0}, *ai = NULL;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host[0] ? host : NULL, colon + 1, &hints, &ai) != 0) return -1;
+
+    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    int one = 1;
+    if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (fd >= 0 && (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 16) != 0)) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(ai);
+    return fd;
+}
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un sa = {0};
+    if (strlen(path) >= sizeof(sa.sun_path)) return -1;
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-l host:port | -u socket_path] [-1] [region ...]\n"
+            "  -l   HTTP on TCP (default " DEFAULT_LISTEN ")\n"
+            "  -u   HTTP on a Unix socket\n"
+            "  -1   print one scrape to stdout and exit\n"
+            "  regions default to " SHM_PATH "\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *tcp = DEFAULT_LISTEN;
+    const char *unix_path = NULL;
+    int once = 0;
+    Region regs[MAX_REGIONS];
+    int nregs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            tcp = argv[++i];
+        } else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) {
+            unix_path = argv[++i];
+        } else if (strcmp(argv[i], "-1") == 0) {
+            once = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else if (nregs < MAX_REGIONS) {
+            regs[nregs++] = (Region){argv[i], NULL, 0, 0};
+        }
+    }
+    if (nregs == 0) regs[nregs++] = (Region){SHM_PATH, NULL, 0, 0};
+
+    Buf b = {0};
+    if (once) {
+        scrape(&b, regs, nregs);
+        fwrite(b.p, 1, b.len, stdout);
+        return 0;
+    }
+
+    int lfd = unix_path ? listen_unix(unix_path) : listen_tcp(tcp);
+    if (lfd < 0) {
+        perror(unix_path ? unix_path : tcp);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    printf("usrl-exporter: serving /metrics on %s%s\n", unix_path ? "unix:" : "",
+           unix_path ? unix_path : tcp);
+    fflush(stdout);
+
+    struct timeval rtv = {RECV_TIMEOUT_S, 0};
+    struct timeval stv = {SEND_TIMEOUT_S, 0};
+    for (;;) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &rtv, sizeof(rtv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &stv, sizeof(stv));
+        serve_one(fd, &b, regs, nregs);
+        close(fd);
+    }
+
+    close(lfd);
+    return 1;
+}
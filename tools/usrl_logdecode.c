@@ -0,0 +1,272 @@
+/**
+ * @file usrl_logdecode.c
+ * @brief Render binary USRL logs (usrl_logging_init_binary / _publish).
+ *
+ * Reads frames from a log file, or follows a log topic, and prints the
+ * same "[sec.ms] [LEVEL] [module:line] message" lines the text backend
+ * writes. Call sites are learned from their DEF frames, per writing pid.
+ *
+ *   usrl-logdecode [-f] file
+ *   usrl-logdecode -t topic [region]
+ *
+ * -f keeps reading as the file grows. A topic reader that joins late
+ * prints records of sites it has no DEF for yet as "<site N>" with the
+ * raw arguments, until the writer's next periodic DEF.
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_logging.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/mman.h>
+
+#define SHM_PATH "/usrl_core"
+#define MAX_SITES 65536 /* (pid, site) pairs remembered */
+
+typedef struct {
+    uint32_t pid;
+    uint32_t site;
+    uint16_t line;
+    uint8_t nargs;
+    uint8_t level;
+    char types[USRL_BLOG_MAX_ARGS + 1];
+    char *module;
+    char *file;
+    char *fmt;
+} Site;
+
+static Site g_sites[MAX_SITES];
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static const char *level_name(unsigned level) {
+    switch (level) {
+        case USRL_LOG_ERROR: return "ERROR";
+        case USRL_LOG_WARN: return "WARN";
+        case USRL_LOG_INFO: return "INFO";
+        case USRL_LOG_DEBUG: return "DEBUG";
+        case USRL_LOG_TRACE: return "TRACE";
+        case 0xFF: return "METRIC";
+        default: return "UNKNOWN";
+    }
+}
+
+/* Open-addressed on (pid, site); a redefinition replaces the entry */
+static Site *site_slot(uint32_t pid, uint32_t site, int create) {
+    uint32_t h = (pid * 2654435761u) ^ (site * 40503u);
+    for (uint32_t i = 0; i < MAX_SITES; i++) {
+        Site *s = &g_sites[(h + i) & (MAX_SITES - 1)];
+        if (s->site == 0) return create ? s : NULL;
+        if (s->pid == pid && s->site == site) return s;
+    }
+    return NULL;
+}
+
+static void define(const UsrlBlogFrame *f, const uint8_t *body, uint32_t len) {
+    if (len < 4) return;
+    Site *s = site_slot(f->pid, f->site, 1);
+    if (!s) return;
+    uint8_t nargs = body[2];
+    if (nargs > USRL_BLOG_MAX_ARGS || 4u + nargs > len) return;
+
+    /* module, file and fmt follow the types, each NUL-terminated */
+    const char *strs[3];
+    uint32_t pos = 4u + nargs;
+    for (int i = 0; i < 3; i++) {
+        const void *nul = pos < len ? memchr(body + pos, '\0', len - pos) : NULL;
+        if (!nul) return;
+        strs[i] = (const char *)body + pos;
+        pos = (uint32_t)((const uint8_t *)nul - body) + 1;
+    }
+
+    free(s->module);
+    free(s->file);
+    free(s->fmt);
+    s->pid = f->pid;
+    s->site = f->site;
+    memcpy(&s->line, body, 2);
+    s->nargs = nargs;
+    s->level = body[3];
+    memcpy(s->types, body + 4, nargs);
+    s->types[nargs] = '\0';
+    s->module = strdup(strs[0]);
+    s->file = strdup(strs[1]);
+    s->fmt = strdup(strs[2]);
+}
+
+static void print_line(const UsrlBlogFrame *f, const char *text, uint32_t len) {
+    printf("[%lu.%03lu] [%s] %.*s\n", (uint64_t)(f->ts / 1000000000ULL),
+           (uint64_t)((f->ts % 1000000000ULL) / 1000000ULL), level_name(f->level), (int)len, text);
+}
+
+static void frame(const UsrlBlogFrame *f) {
+    const uint8_t *body = (const uint8_t *)(f + 1);
+    uint32_t len = f->len - (uint32_t)sizeof(*f);
+    char text[4096];
+
+    switch (f->type) {
+        case USRL_BLOG_DEF:
+            define(f, body, len);
+            break;
+        case USRL_BLOG_LOG: {
+            const Site *s = site_slot(f->pid, f->site, 0);
+            int n;
+            if (!s) {
+                n = snprintf(text, sizeof(text), "<site %u pid %u> (%u argument bytes)", f->site,
+                             f->pid, len);
+            } else {
+                n = snprintf(text, sizeof(text), "[%s:%u] ", s->module, s->line);
+                n += (int)usrl_log_render(s->fmt, s->types, s->nargs, body, len, text + n,
+                                          (uint32_t)(sizeof(text) - (size_t)n));
+            }
+            print_line(f, text, (uint32_t)n);
+            break;
+        }
+        case USRL_BLOG_TEXT:
+            print_line(f, (const char *)body, len);
+            break;
+        case USRL_BLOG_DROP: {
+            uint64_t count = 0;
+            if (len >= sizeof(count)) memcpy(&count, body, sizeof(count));
+            int n = snprintf(text, sizeof(text),
+                             "[log] pid %u thread buffer full, records dropped: %lu", f->pid,
+                             count);
+            print_line(f, text, (uint32_t)n);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static int decode_file(const char *path, int follow) {
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+
+    UsrlBlogFileHeader fh;
+    if (fread(&fh, sizeof(fh), 1, in) != 1 || fh.magic != USRL_BLOG_MAGIC ||
+        fh.version != USRL_BLOG_VERSION) {
+        fprintf(stderr, "usrl-logdecode: %s is not a binary USRL log\n", path);
+        fclose(in);
+        return 1;
+    }
+
+    uint8_t buf[USRL_BLOG_FRAME_MAX];
+    UsrlBlogFrame *f = (UsrlBlogFrame *)buf;
+    struct timespec nap = {0, 50 * 1000000L};
+    while (!g_stop) {
+        long pos = ftell(in);
+        if (fread(f, sizeof(*f), 1, in) == 1 && f->len >= sizeof(*f) &&
+            f->len <= sizeof(buf) &&
+            fread(buf + sizeof(*f), 1, f->len - sizeof(*f), in) == f->len - sizeof(*f)) {
+            frame(f);
+            continue;
+        }
+        if (!follow) break;
+        /* Partial frame: the writer is mid-flush, retry from its start */
+        fflush(stdout);
+        clearerr(in);
+        fseek(in, pos, SEEK_SET);
+        nanosleep(&nap, NULL);
+    }
+    fclose(in);
+    return 0;
+}
+
+static int decode_topic(const char *topic, const char *path) {
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    CoreHeader hdr;
+    ssize_t n = read(fd, &hdr, sizeof(hdr));
+    close(fd);
+    if (n != (ssize_t)sizeof(hdr) || hdr.magic != USRL_MAGIC) {
+        fprintf(stderr, "usrl-logdecode: %s is not a USRL region\n", path);
+        return 1;
+    }
+    void *base = usrl_core_map(path, hdr.mmap_size);
+    if (!base) return 1;
+
+    UsrlSubscriber sub;
+    memset(&sub, 0, sizeof(sub));
+    usrl_sub_init(&sub, base, topic);
+    if (!sub.desc) {
+        fprintf(stderr, "usrl-logdecode: topic '%s' not found in %s\n", topic, path);
+        usrl_core_unmap(base, hdr.mmap_size);
+        return 1;
+    }
+
+    uint8_t buf[USRL_BLOG_FRAME_MAX];
+    struct timespec nap = {0, 1000000L};
+    while (!g_stop) {
+        uint16_t pub_id;
+        int len = usrl_sub_next(&sub, buf, sizeof(buf), &pub_id);
+        if (len < (int)sizeof(UsrlBlogFrame)) {
+            if (len == USRL_RING_NO_DATA) {
+                fflush(stdout);
+                nanosleep(&nap, NULL);
+            }
+            continue;
+        }
+        UsrlBlogFrame *f = (UsrlBlogFrame *)buf;
+        if (f->len <= (uint32_t)len) frame(f);
+    }
+
+    usrl_core_unmap(base, hdr.mmap_size);
+    return 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-f] file\n"
+            "       %s -t topic [region]\n"
+            "  -f   follow the file as it grows\n"
+            "  -t   follow a log topic (region defaults to " SHM_PATH ")\n",
+            argv0, argv0);
+}
+
+int main(int argc, char **argv) {
+    int follow = 0;
+    const char *topic = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ft:h")) != -1) {
+        switch (opt) {
+            case 'f': follow = 1; break;
+            case 't': topic = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    int rc;
+    if (topic) {
+        rc = decode_topic(topic, optind < argc ? argv[optind] : SHM_PATH);
+    } else if (optind < argc) {
+        rc = decode_file(argv[optind], follow);
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
+    fflush(stdout);
+    return rc;
+}
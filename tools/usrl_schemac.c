@@ -0,0 +1,568 @@
+/**
+ * @file usrl_schemac.c
+ * @brief Schema compiler: one schema file, matching types in C, C++ and Python.
+ *
+ *   usrl-schemac [-o dir] schema.json|schema.usrl ...
+ *
+ * For each schema writes <name>.h (packed struct, descriptor builder and
+ * typed publish / receive wrappers), <name>.hpp (accessor class with
+ * constexpr offsets) and <name>.py (numpy.dtype). The fingerprint is the
+ * one usrl_schema_finalize() computes - the descriptor is built with the
+ * library itself - so generated code and runtime schemas always agree.
+ *
+ * JSON form:
+ *   {"name": "price_quote", "id": 1, "version": 1,
+ *    "fields": [{"name": "bid", "type": "f64"},
+ *               {"name": "symbol", "type": "string", "size": 8}]}
+ *
+ * IDL form ('#' and '//' comments):
+ *   schema price_quote 1 version 1 {
+ *       f64 bid;
+ *       string[8] symbol;
+ *   }
+ *
+ * Types: u64 i64 f64 u32 i32 f32, bytes[n] and string[n].
+ */
+
+#include "usrl_schema.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *name;
+    UsrlFieldType type;
+} TypeName;
+
+static const TypeName g_types[] = {
+    {"u64", USRL_FIELD_U64}, {"uint64", USRL_FIELD_U64},
+    {"i64", USRL_FIELD_I64}, {"int64", USRL_FIELD_I64},
+    {"f64", USRL_FIELD_F64}, {"double", USRL_FIELD_F64},
+    {"u32", USRL_FIELD_U32}, {"uint32", USRL_FIELD_U32},
+    {"i32", USRL_FIELD_I32}, {"int32", USRL_FIELD_I32},
+    {"f32", USRL_FIELD_F32}, {"float", USRL_FIELD_F32},
+    {"bytes", USRL_FIELD_BYTES}, {"string", USRL_FIELD_STRING},
+};
+
+/* Per-type spellings: C member, C++ value, numpy format, usrl_schema.h enum */
+static const char *c_type[] = {"uint64_t", "int64_t", "double", "uint32_t", "int32_t", "float"};
+static const char *np_type[] = {"<u8", "<i8", "<f8", "<u4", "<i4", "<f4"};
+static const char *enum_name[] = {"USRL_FIELD_U64", "USRL_FIELD_I64", "USRL_FIELD_F64",
+                                  "USRL_FIELD_U32", "USRL_FIELD_I32", "USRL_FIELD_F32",
+                                  "USRL_FIELD_BYTES", "USRL_FIELD_STRING"};
+
+typedef struct {
+    const char *path;
+    char *text;
+    char *p;
+    int line;
+} Src;
+
+static int fail(const Src *s, const char *msg, const char *what) {
+    fprintf(stderr, "%s:%d: %s%s%s\n", s->path, s->line, msg, what ? " " : "", what ? what : "");
+    return -1;
+}
+
+/* --------------------------------------------------------------------------
+ * Lexing (shared by both forms)
+ * -------------------------------------------------------------------------- */
+
+static void skip(Src *s) {
+    for (;;) {
+        while (isspace((unsigned char)*s->p)) {
+            if (*s->p == '\n') s->line++;
+            s->p++;
+        }
+        if (*s->p == '#' || (s->p[0] == '/' && s->p[1] == '/')) {
+            while (*s->p && *s->p != '\n') s->p++;
+            continue;
+        }
+        return;
+    }
+}
+
+static int accept(Src *s, char c) {
+    skip(s);
+    if (*s->p != c) return 0;
+    s->p++;
+    return 1;
+}
+
+static int expect(Src *s, char c) {
+    if (accept(s, c)) return 1;
+    char what[4] = {'\'', c, '\'', '\0'};
+    fail(s, "expected", what);
+    return 0;
+}
+
+/* Identifier or, in JSON, a quoted string; at most cap-1 bytes */
+static int word(Src *s, char *out, size_t cap, int quoted) {
+    skip(s);
+    size_t n = 0;
+    if (quoted) {
+        if (*s->p != '"') return fail(s, "expected a string", NULL);
+        s->p++;
+        while (*s->p && *s->p != '"' && *s->p != '\n') {
+            if (n + 1 >= cap) return fail(s, "string too long", NULL);
+            out[n++] = *s->p++;
+        }
+        if (*s->p != '"') return fail(s, "unterminated string", NULL);
+        s->p++;
+    } else {
+        while (isalnum((unsigned char)*s->p) || *s->p == '_') {
+            if (n + 1 >= cap) return fail(s, "name too long", NULL);
+            out[n++] = *s->p++;
+        }
+        if (n == 0) return fail(s, "expected a name", NULL);
+    }
+    out[n] = '\0';
+    return 0;
+}
+
+static int number(Src *s, uint32_t *out) {
+    skip(s);
+    if (!isdigit((unsigned char)*s->p)) return fail(s, "expected a number", NULL);
+    char *end;
+    unsigned long v = strtoul(s->p, &end, 0);
+    if (v > 0xFFFFFFFFul) return fail(s, "number out of range", NULL);
+    s->p = end;
+    *out = (uint32_t)v;
+    return 0;
+}
+
+static int is_ident(const char *name) {
+    if (!isalpha((unsigned char)name[0]) && name[0] != '_') return 0;
+    for (const char *c = name; *c; c++)
+        if (!isalnum((unsigned char)*c) && *c != '_') return 0;
+    return 1;
+}
+
+/* --------------------------------------------------------------------------
+ * Schema building: every field goes through usrl_schema_add_field()
+ * -------------------------------------------------------------------------- */
+
+static int add_field(Src *s, UsrlSchema *schema, const char *name, const char *type,
+                     uint32_t size) {
+    if (!is_ident(name) || strlen(name) >= USRL_SCHEMA_NAME_MAX)
+        return fail(s, "invalid field name", name);
+    if (usrl_schema_field_id(schema, name) != USRL_FIELD_INVALID)
+        return fail(s, "duplicate field", name);
+
+    for (size_t i = 0; i < sizeof(g_types) / sizeof(g_types[0]); i++) {
+        if (strcmp(g_types[i].name, type) != 0) continue;
+        UsrlFieldType t = g_types[i].type;
+        if (t == USRL_FIELD_BYTES || t == USRL_FIELD_STRING) {
+            if (size == 0) return fail(s, "bytes / string fields need a size:", name);
+        } else {
+            size = (t <= USRL_FIELD_F64) ? 8 : 4;
+        }
+        if (usrl_schema_add_field(schema, name, t, size) != 0)
+            return fail(s, "too many fields, the limit is", "32");
+        return 0;
+    }
+    /* A struct cannot hold them; build such messages with usrl_message_set_var() */
+    if (strcmp(type, "vbytes") == 0 || strcmp(type, "vstring") == 0)
+        return fail(s, "variable-length fields have no generated struct:", type);
+    return fail(s, "unknown type", type);
+}
+
+static UsrlSchema *parse_json(Src *s) {
+    char key[64], name[64] = "", type[64];
+    uint32_t id = 0, version = 1;
+    UsrlSchema *schema = usrl_schema_create(0, "");
+    if (!schema) return NULL;
+
+    if (!expect(s, '{')) goto bad;
+    do {
+        if (word(s, key, sizeof(key), 1) != 0 || !expect(s, ':')) goto bad;
+        if (strcmp(key, "name") == 0) {
+            if (word(s, name, sizeof(name), 1) != 0) goto bad;
+        } else if (strcmp(key, "id") == 0) {
+            if (number(s, &id) != 0) goto bad;
+        } else if (strcmp(key, "version") == 0) {
+            if (number(s, &version) != 0) goto bad;
+        } else if (strcmp(key, "fields") == 0) {
+            if (!expect(s, '[')) goto bad;
+            if (accept(s, ']')) continue;
+            do {
+                char fname[64] = "";
+                uint32_t size = 0;
+                type[0] = '\0';
+                if (!expect(s, '{')) goto bad;
+                do {
+                    if (word(s, key, sizeof(key), 1) != 0 || !expect(s, ':')) goto bad;
+                    int rc = strcmp(key, "name") == 0   ? word(s, fname, sizeof(fname), 1)
+                             : strcmp(key, "type") == 0 ? word(s, type, sizeof(type), 1)
+                             : strcmp(key, "size") == 0 ? number(s, &size)
+                                                        : fail(s, "unknown field key", key);
+                    if (rc != 0) goto bad;
+                } while (accept(s, ','));
+                if (!expect(s, '}') || add_field(s, schema, fname, type, size) != 0) goto bad;
+            } while (accept(s, ','));
+            if (!expect(s, ']')) goto bad;
+        } else {
+            fail(s, "unknown key", key);
+            goto bad;
+        }
+    } while (accept(s, ','));
+    if (!expect(s, '}')) goto bad;
+
+    free((void *)schema->name);
+    schema->name = strdup(name);
+    schema->schema_id = id;
+    schema->version = version;
+    return schema;
+
+bad:
+    usrl_schema_free(schema);
+    return NULL;
+}
+
+static UsrlSchema *parse_idl(Src *s) {
+    char kw[64], name[64], type[64], fname[64];
+    uint32_t id = 0, version = 1;
+
+    if (word(s, kw, sizeof(kw), 0) != 0 || strcmp(kw, "schema") != 0) {
+        fail(s, "expected 'schema'", NULL);
+        return NULL;
+    }
+    if (word(s, name, sizeof(name), 0) != 0 || number(s, &id) != 0) return NULL;
+    skip(s);
+    if (*s->p == 'v') {
+        if (word(s, kw, sizeof(kw), 0) != 0 || strcmp(kw, "version") != 0 ||
+            number(s, &version) != 0) {
+            fail(s, "expected 'version <n>'", NULL);
+            return NULL;
+        }
+    }
+
+    UsrlSchema *schema = usrl_schema_create(id, name);
+    if (!schema) return NULL;
+    schema->version = version;
+
+    if (!expect(s, '{')) goto bad;
+    while (!accept(s, '}')) {
+        uint32_t size = 0;
+        if (word(s, type, sizeof(type), 0) != 0) goto bad;
+        if (accept(s, '[') && (number(s, &size) != 0 || !expect(s, ']'))) goto bad;
+        if (word(s, fname, sizeof(fname), 0) != 0 || !expect(s, ';')) goto bad;
+        if (add_field(s, schema, fname, type, size) != 0) goto bad;
+    }
+    return schema;
+
+bad:
+    usrl_schema_free(schema);
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------
+ * Code generation
+ * -------------------------------------------------------------------------- */
+
+/* price_quote -> PriceQuote (upper = 0) or PRICE_QUOTE (upper = 1) */
+static void spell(const char *name, char *out, int upper) {
+    int start = 1;
+    for (; *name; name++) {
+        if (!upper && *name == '_') {
+            start = 1;
+            continue;
+        }
+        *out++ = (char)((upper || start) ? toupper((unsigned char)*name) : *name);
+        start = 0;
+    }
+    *out = '\0';
+}
+
+static uint32_t field_bytes(const UsrlField *f) {
+    return f->type <= USRL_FIELD_F64 ? 8 : f->type <= USRL_FIELD_F32 ? 4 : f->size;
+}
+
+static FILE *open_out(const char *dir, const char *name, const char *ext) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s%s", dir, name, ext);
+    FILE *f = fopen(path, "w");
+    if (!f) perror(path);
+    return f;
+}
+
+static void gen_c(FILE *o, const UsrlSchema *s, const char *src, const char *T, const char *M) {
+    const char *n = s->name;
+    fprintf(o,
+            "/*\n"
+            " * %s.h - generated by usrl-schemac from %s. Do not edit.\n"
+            " *\n"
+            " * Schema %s, id %u, version %u, fingerprint 0x%08x, %u bytes.\n"
+            " */\n\n"
+            "#ifndef USRL_GEN_%s_H\n#define USRL_GEN_%s_H\n\n"
+            "#include <stddef.h>\n#include <stdint.h>\n#include \"usrl.h\"\n"
+            "#ifndef __cplusplus\n#include \"usrl_ring.h\"\n#endif\n\n",
+            n, src, n, s->schema_id, s->version, s->fingerprint, s->total_size, M, M);
+    fprintf(o,
+            "#define %s_SCHEMA_ID   %uu\n#define %s_VERSION     %uu\n"
+            "#define %s_FINGERPRINT 0x%08xu\n#define %s_SIZE        %uu\n\n",
+            M, s->schema_id, M, s->version, M, s->fingerprint, M, s->total_size);
+
+    fprintf(o, "typedef struct __attribute__((packed)) {\n");
+    for (uint32_t i = 0; i < s->field_count; i++) {
+        const UsrlField *f = &s->fields[i];
+        if (f->type <= USRL_FIELD_F32)
+            fprintf(o, "    %s %s;\n", c_type[f->type], f->name);
+        else
+            fprintf(o, "    %s %s[%u];\n", f->type == USRL_FIELD_STRING ? "char" : "uint8_t",
+                    f->name, f->size);
+    }
+    fprintf(o, "} %s;\n\n", T);
+
+    fprintf(o, "#ifdef __cplusplus\n#define %s_ASSERT static_assert\n#else\n"
+               "#define %s_ASSERT _Static_assert\n#endif\n",
+            M, M);
+    fprintf(o, "%s_ASSERT(sizeof(%s) == %s_SIZE, \"%s size\");\n", M, T, M, T);
+    for (uint32_t i = 0; i < s->field_count; i++)
+        fprintf(o, "%s_ASSERT(offsetof(%s, %s) == %u, \"%s.%s offset\");\n", M, T,
+                s->fields[i].name, s->fields[i].offset, T, s->fields[i].name);
+    fprintf(o, "#undef %s_ASSERT\n\n", M);
+
+    fprintf(o,
+            "/* Runtime descriptor, for usrl_schema_register() / usrl_schema_bind() */\n"
+            "static inline UsrlSchema *%s_schema(void)\n{\n"
+            "    UsrlSchema *s = usrl_schema_create(%s_SCHEMA_ID, \"%s\");\n"
+            "    if (!s) return NULL;\n"
+            "    s->version = %s_VERSION;\n",
+            n, M, n, M);
+    for (uint32_t i = 0; i < s->field_count; i++)
+        fprintf(o, "    usrl_schema_add_field(s, \"%s\", %s, %u);\n", s->fields[i].name,
+                enum_name[s->fields[i].type], field_bytes(&s->fields[i]));
+    fprintf(o,
+            "    if (usrl_schema_finalize(s) != 0 || s->fingerprint != %s_FINGERPRINT) {\n"
+            "        usrl_schema_free(s);\n"
+            "        return NULL;\n"
+            "    }\n"
+            "    return s;\n}\n\n",
+            M);
+
+    fprintf(o,
+            "/* Non-zero if a schema found at runtime (usrl_sub_schema, ...) has this layout */\n"
+            "static inline int %s_matches(const UsrlSchema *s)\n{\n"
+            "    return s && s->fingerprint == %s_FINGERPRINT && s->total_size == %s_SIZE;\n"
+            "}\n\n",
+            n, M, M);
+
+    fprintf(o,
+            "/* Typed wrappers. Receive returns sizeof(%s) or the error of the call below. */\n"
+            "static inline int %s_send(usrl_pub_t *pub, const %s *m)\n{\n"
+            "    return usrl_pub_send(pub, m, sizeof(*m));\n}\n\n"
+            "static inline int %s_recv(usrl_sub_t *sub, %s *m)\n{\n"
+            "    int n = usrl_sub_recv(sub, m, sizeof(*m));\n"
+            "    return (n < 0 || n == (int)sizeof(*m)) ? n : -1;\n}\n\n",
+            T, n, T, n, T);
+    fprintf(o,
+            "#ifndef __cplusplus\n"
+            "static inline int %s_publish(UsrlPublisher *p, const %s *m)\n{\n"
+            "    return usrl_pub_publish(p, m, sizeof(*m));\n}\n\n"
+            "static inline int %s_mwmr_publish(UsrlMwmrPublisher *p, const %s *m)\n{\n"
+            "    return usrl_mwmr_pub_publish(p, m, sizeof(*m));\n}\n\n"
+            "static inline int %s_next(UsrlSubscriber *s, %s *m, uint16_t *pub_id)\n{\n"
+            "    int n = usrl_sub_next(s, (uint8_t *)m, sizeof(*m), pub_id);\n"
+            "    return (n < 0 || n == (int)sizeof(*m)) ? n : USRL_RING_ERROR;\n}\n"
+            "#endif\n\n",
+            n, T, n, T, n, T);
+    fprintf(o, "#endif /* USRL_GEN_%s_H */\n", M);
+}
+
+static void gen_cpp(FILE *o, const UsrlSchema *s, const char *src, const char *T, const char *M) {
+    const char *n = s->name;
+    fprintf(o,
+            "/*\n"
+            " * %s.hpp - generated by usrl-schemac from %s. Do not edit.\n"
+            " *\n"
+            " * usrl::%sView reads and writes a %s payload in place: a received\n"
+            " * buffer, a UsrlMessage's data, or a %s. Each accessor is one memcpy\n"
+            " * at a constexpr offset. Needs C++17.\n"
+            " */\n\n"
+            "#ifndef USRL_GEN_%s_HPP\n#define USRL_GEN_%s_HPP\n\n"
+            "#include <cstddef>\n#include <cstdint>\n#include <cstring>\n#include <string_view>\n\n"
+            "#include \"%s.h\"\n\nnamespace usrl {\n\n",
+            n, src, T, n, T, M, M, n);
+
+    fprintf(o, "class %sView {\npublic:\n", T);
+    fprintf(o,
+            "    static constexpr uint32_t schema_id = %uu;\n"
+            "    static constexpr uint32_t version = %uu;\n"
+            "    static constexpr uint32_t fingerprint = 0x%08xu;\n"
+            "    static constexpr uint32_t size = %uu;\n\n",
+            s->schema_id, s->version, s->fingerprint, s->total_size);
+    for (uint32_t i = 0; i < s->field_count; i++)
+        fprintf(o, "    static constexpr uint32_t %s_offset = %u;\n", s->fields[i].name,
+                s->fields[i].offset);
+    for (uint32_t i = 0; i < s->field_count; i++)
+        if (s->fields[i].type > USRL_FIELD_F32)
+            fprintf(o, "    static constexpr uint32_t %s_size = %u;\n", s->fields[i].name,
+                    s->fields[i].size);
+
+    fprintf(o, "\n    explicit %sView(void *data) : p_(static_cast<uint8_t *>(data)) {}\n"
+               "    explicit %sView(%s &m) : p_(reinterpret_cast<uint8_t *>(&m)) {}\n\n"
+               "    uint8_t *data() const { return p_; }\n",
+            T, T, T);
+
+    for (uint32_t i = 0; i < s->field_count; i++) {
+        const UsrlField *f = &s->fields[i];
+        const char *fn = f->name;
+        if (f->type <= USRL_FIELD_F32) {
+            const char *ct = c_type[f->type];
+            fprintf(o, "\n    %s %s() const { return load<%s>(%s_offset); }\n"
+                       "    void set_%s(%s v) { store(%s_offset, v); }\n",
+                    ct, fn, ct, fn, fn, ct, fn);
+        } else if (f->type == USRL_FIELD_STRING) {
+            fprintf(o,
+                    "\n    std::string_view %s() const\n    {\n"
+                    "        const char *c = reinterpret_cast<const char *>(p_ + %s_offset);\n"
+                    "        return {c, strnlen(c, %s_size)};\n    }\n"
+                    "    void set_%s(std::string_view v)\n    {\n"
+                    "        size_t len = v.size() < %s_size ? v.size() : %s_size;\n"
+                    "        std::memcpy(p_ + %s_offset, v.data(), len);\n"
+                    "        std::memset(p_ + %s_offset + len, 0, %s_size - len);\n    }\n",
+                    fn, fn, fn, fn, fn, fn, fn, fn, fn);
+        } else {
+            fprintf(o, "\n    const uint8_t *%s() const { return p_ + %s_offset; }\n"
+                       "    uint8_t *mutable_%s() { return p_ + %s_offset; }\n",
+                    fn, fn, fn, fn);
+        }
+    }
+
+    fprintf(o, "\nprivate:\n"
+               "    template <typename V> V load(uint32_t off) const\n    {\n"
+               "        V v;\n        std::memcpy(&v, p_ + off, sizeof(v));\n        return v;\n    }\n"
+               "    template <typename V> void store(uint32_t off, V v)\n    {\n"
+               "        std::memcpy(p_ + off, &v, sizeof(v));\n    }\n\n"
+               "    uint8_t *p_;\n};\n\n");
+
+    fprintf(o, "static_assert(%sView::size == sizeof(%s), \"%s size\");\n", T, T, T);
+    for (uint32_t i = 0; i < s->field_count; i++)
+        fprintf(o, "static_assert(%sView::%s_offset == offsetof(%s, %s), \"%s.%s offset\");\n", T,
+                s->fields[i].name, T, s->fields[i].name, T, s->fields[i].name);
+    fprintf(o, "\n} // namespace usrl\n\n#endif /* USRL_GEN_%s_HPP */\n", M);
+}
+
+static void gen_py(FILE *o, const UsrlSchema *s, const char *src) {
+    fprintf(o,
+            "# %s.py - generated by usrl-schemac from %s. Do not edit.\n"
+            "#\n"
+            "# numpy view of %s payloads: numpy.frombuffer(buf, dtype=dtype) decodes one\n"
+            "# message, or a whole array of them, without copying.\n\n"
+            "import numpy as np\n\n"
+            "SCHEMA_ID = %u\nVERSION = %u\nFINGERPRINT = 0x%08x\nSIZE = %u\n\n"
+            "dtype = np.dtype({\n    \"names\": [",
+            s->name, src, s->name, s->schema_id, s->version, s->fingerprint, s->total_size);
+    for (uint32_t i = 0; i < s->field_count; i++)
+        fprintf(o, "%s\"%s\"", i ? ", " : "", s->fields[i].name);
+    fprintf(o, "],\n    \"formats\": [");
+    for (uint32_t i = 0; i < s->field_count; i++) {
+        const UsrlField *f = &s->fields[i];
+        if (f->type <= USRL_FIELD_F32)
+            fprintf(o, "%s\"%s\"", i ? ", " : "", np_type[f->type]);
+        else if (f->type == USRL_FIELD_STRING)
+            fprintf(o, "%s\"S%u\"", i ? ", " : "", f->size);
+        else
+            fprintf(o, "%s\"(%u,)u1\"", i ? ", " : "", f->size);
+    }
+    fprintf(o, "],\n    \"offsets\": [");
+    for (uint32_t i = 0; i < s->field_count; i++)
+        fprintf(o, "%s%u", i ? ", " : "", s->fields[i].offset);
+    fprintf(o, "],\n    \"itemsize\": SIZE,\n})\n");
+}
+
+static int compile(const char *path, const char *dir) {
+    Src s = {path, NULL, NULL, 1};
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    s.text = malloc((size_t)size + 1);
+    if (!s.text || fread(s.text, 1, (size_t)size, in) != (size_t)size) {
+        fclose(in);
+        free(s.text);
+        fail(&s, "cannot read the file", NULL);
+        return 1;
+    }
+    fclose(in);
+    s.text[size] = '\0';
+    s.p = s.text;
+
+    skip(&s);
+    UsrlSchema *schema = (*s.p == '{') ? parse_json(&s) : parse_idl(&s);
+    int rc = 1;
+    if (!schema) goto out;
+    skip(&s);
+    if (*s.p) {
+        fail(&s, "trailing text after the schema", NULL);
+        goto out;
+    }
+    if (!is_ident(schema->name) || strlen(schema->name) >= USRL_SCHEMA_NAME_MAX) {
+        fail(&s, "invalid schema name", schema->name);
+        goto out;
+    }
+    if (usrl_schema_finalize(schema) != 0) {
+        fail(&s, "schema has no fields", NULL);
+        goto out;
+    }
+
+    /* Generated identifiers: PriceQuote / PRICE_QUOTE */
+    char T[USRL_SCHEMA_NAME_MAX], M[USRL_SCHEMA_NAME_MAX];
+    spell(schema->name, T, 0);
+    spell(schema->name, M, 1);
+    const char *src = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+
+    FILE *h = open_out(dir, schema->name, ".h");
+    FILE *hpp = open_out(dir, schema->name, ".hpp");
+    FILE *py = open_out(dir, schema->name, ".py");
+    if (h) gen_c(h, schema, src, T, M);
+    if (hpp) gen_cpp(hpp, schema, src, T, M);
+    if (py) gen_py(py, schema, src);
+    rc = (h && hpp && py) ? 0 : 1;
+    if (h && fclose(h) != 0) rc = 1;
+    if (hpp && fclose(hpp) != 0) rc = 1;
+    if (py && fclose(py) != 0) rc = 1;
+
+    if (rc == 0)
+        fprintf(stderr, "usrl-schemac: %s id %u v%u fingerprint 0x%08x, %u bytes -> %s/%s.{h,hpp,py}\n",
+                schema->name, schema->schema_id, schema->version, schema->fingerprint,
+                schema->total_size, dir, schema->name);
+out:
+    usrl_schema_free(schema);
+    free(s.text);
+    return rc;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-o dir] schema.json|schema.usrl ...\n"
+            "  -o   output directory (default .)\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = ".";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:h")) != -1) {
+        switch (opt) {
+            case 'o': dir = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int rc = 0;
+    for (int i = optind; i < argc; i++) rc |= compile(argv[i], dir);
+    return rc;
+}
@@ -34,6 +34,7 @@ typedef struct {
     double   rate_hz;
     double   bw_kbs;
     int      fill_pct;
+    uint64_t last_published[USRL_MAX_WRITERS]; /* per writer-table entry */
 } TopicStats;
 
 /* --------------------------------------------------------------------------
@@ -46,8 +47,8 @@ static uint64_t time_ms() {
     return (uint64_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 }
 
-static void* map_system(void) {
-    int fd = shm_open(SHM_PATH, O_RDWR, 0666);
+static void* map_system(const char *path) {
+    int fd = shm_open(path, O_RDWR, 0666);
     if (fd < 0) return NULL;
 
     CoreHeader hdr;
@@ -76,8 +77,75 @@ static void draw_bar(int pct) {
 /* --------------------------------------------------------------------------
  * MAIN LOOP
  * -------------------------------------------------------------------------- */
-int main(void) {
-    void *base = map_system();
+/* One line per attached writer: its own rate from the writer table */
+static void draw_writers(void *base, TopicEntry *t, TopicStats *s, double dt) {
+    UsrlWriterTable *wt = (UsrlWriterTable*)((uint8_t*)base + t->writers_offset);
+
+    for (int w = 0; w < USRL_MAX_WRITERS; w++) {
+        UsrlWriterEntry *e = &wt->entries[w];
+        uint32_t owner = atomic_load_explicit(&e->owner, memory_order_acquire);
+        uint64_t published = atomic_load_explicit(&e->published, memory_order_relaxed);
+        uint64_t diff = published - s->last_published[w];
+        s->last_published[w] = published;
+        if (owner == 0) continue;
+
+        uint64_t dropped = atomic_load_explicit(&e->dropped, memory_order_relaxed);
+        uint64_t timeouts = atomic_load_explicit(&e->timeouts, memory_order_relaxed);
+        char rate_str[32];
+        snprintf(rate_str, 32, "%.1f Hz", (double)diff / dt);
+
+        printf(CLR_GREY "  pub %-5u pid %-7u" CLR_RST " %-8s %s%-10s" CLR_RST " %-10s %-12lu",
+               owner - 1, e->pid, "", (diff > 0) ? CLR_GREEN : CLR_GREY, rate_str, "", published);
+        if (dropped || timeouts)
+            printf(CLR_YELLOW " drop %lu tmo %lu" CLR_RST, dropped, timeouts);
+        printf("\n");
+    }
+}
+
+static const char *fmt_ns(char *buf, size_t n, uint64_t ns) {
+    if (ns >= 1000000000ULL) snprintf(buf, n, "%.2fs", ns / 1e9);
+    else if (ns >= 1000000ULL) snprintf(buf, n, "%.2fms", ns / 1e6);
+    else if (ns >= 1000ULL) snprintf(buf, n, "%.1fus", ns / 1e3);
+    else snprintf(buf, n, "%luns", ns);
+    return buf;
+}
+
+/* Latency percentiles of readers that track them */
+static void draw_latency(void *base, TopicEntry *t, uint32_t slot) {
+    const UsrlLatencyHist *h = usrl_reader_latency(base, t->name, slot);
+    if (!h) return;
+
+    UsrlLatencySummary ls;
+    usrl_latency_summary(h, &ls);
+    if (ls.count == 0) return;
+
+    char p50[16], p99[16], p999[16], mx[16];
+    printf(CLR_GREY "            latency p50 %s  p99 %s  p99.9 %s  max %s  (%lu msgs)\n" CLR_RST,
+           fmt_ns(p50, 16, ls.p50_ns), fmt_ns(p99, 16, ls.p99_ns),
+           fmt_ns(p999, 16, ls.p999_ns), fmt_ns(mx, 16, ls.max_ns), ls.count);
+}
+
+/* One line per registered reader: live lag, rate it measured itself */
+static void draw_readers(void *base, TopicEntry *t) {
+    UsrlReaderStats rs[USRL_MAX_READERS];
+    int n = usrl_reader_stats(base, t->name, rs, USRL_MAX_READERS);
+
+    for (int i = 0; i < n; i++) {
+        char rate_str[32];
+        snprintf(rate_str, 32, "%lu Hz", rs[i].read_rate_hz);
+        const char *clr = (rs[i].lag > t->slot_count / 2) ? CLR_RED
+                        : (rs[i].lag > t->slot_count / 8) ? CLR_YELLOW : CLR_GREY;
+
+        printf(CLR_GREY "  sub       pid %-7u" CLR_RST " %-8s %-10s %-10s %-12lu %slag %lu (max %lu)" CLR_RST,
+               rs[i].pid, "", rate_str, "", rs[i].cursor, clr, rs[i].lag, rs[i].max_lag);
+        if (rs[i].skips) printf(CLR_YELLOW " skip %lu" CLR_RST, rs[i].skips);
+        printf("\n");
+        draw_latency(base, t, rs[i].slot);
+    }
+}
+
+int main(int argc, char **argv) {
+    void *base = map_system((argc > 1) ? argv[1] : SHM_PATH);
     if (!base) {
         fprintf(stderr, "Error: Could not open USRL SHM.\n");
         return 1;
@@ -86,13 +154,13 @@ int main(void) {
     CoreHeader *hdr = (CoreHeader*)base;
     TopicEntry *topics = (TopicEntry*)((uint8_t*)base + hdr->topic_table_offset);
 
-    // Alloc Stats
-    TopicStats *stats = calloc(hdr->topic_count, sizeof(TopicStats));
+    // Alloc Stats (for the whole table: topics can be added while we run)
+    TopicStats *stats = calloc(hdr->topic_capacity, sizeof(TopicStats));
 
     // Initialize heads
     for (uint32_t i=0; i < hdr->topic_count; i++) {
         RingDesc *r = (RingDesc*)((uint8_t*)base + topics[i].ring_desc_offset);
-        stats[i].last_head = atomic_load(&r->w_head);
+        stats[i].last_head = usrl_ring_head(r);
     }
 
     uint64_t last_time = time_ms();
@@ -103,13 +171,14 @@ int main(void) {
         uint64_t now = time_ms();
         double dt = (now - last_time) / 1000.0;
         if (dt <= 0) dt = 0.001;
+        uint32_t count = atomic_load_explicit(&hdr->topic_count, memory_order_acquire);
 
         // 1. Update Stats
-        for (uint32_t i=0; i < hdr->topic_count; i++) {
+        for (uint32_t i=0; i < count; i++) {
             TopicEntry *t = &topics[i];
             RingDesc *r = (RingDesc*)((uint8_t*)base + t->ring_desc_offset);
 
-            uint64_t head = atomic_load(&r->w_head);
+            uint64_t head = usrl_ring_head(r);
             uint64_t diff = head - stats[i].last_head;
 
             stats[i].rate_hz = (double)diff / dt;
@@ -127,13 +196,13 @@ int main(void) {
         // 2. Draw UI
         printf(CLR_CLS);
         printf(CLR_BOLD "USRL SYSTEM MONITOR" CLR_RST " | %.1fs uptime\n", (double)clock()/CLOCKS_PER_SEC);
-        printf("System Memory: %lu MB | Topics: %u\n\n", hdr->mmap_size/(1024*1024), hdr->topic_count);
+        printf("System Memory: %lu MB | Topics: %u\n\n", hdr->mmap_size/(1024*1024), count);
 
         printf(CLR_BOLD "%-20s %-6s %-8s %-10s %-10s %-12s\n" CLR_RST,
                "TOPIC", "TYPE", "SIZE", "RATE", "BW", "TOTAL");
         printf("--------------------------------------------------------------------------\n");
 
-        for (uint32_t i=0; i < hdr->topic_count; i++) {
+        for (uint32_t i=0; i < count; i++) {
             TopicEntry *t = &topics[i];
             TopicStats *s = &stats[i];
 
@@ -155,6 +224,9 @@ int main(void) {
                    rate_str,
                    bw_str,
                    s->current_head);
+
+            draw_writers(base, t, s, dt);
+            draw_readers(base, t);
         }
 
         printf("\n" CLR_GREY "Press Ctrl+C to exit" CLR_RST "\n");
@@ -0,0 +1,79 @@
+/**
+ * @file usrl_trace.c
+ * @brief Control and export the USRL trace region.
+ *
+ *   usrl-trace [-o out.json] [-r name]   export Chrome trace JSON (default stdout)
+ *   usrl-trace -c [-r name]              create the region, recording nothing yet
+ *   usrl-trace -x [-r name]              remove the region
+ *
+ * Processes record into the region once they call usrl_trace_open() (or
+ * usrl_tracing_init()). Export while they run: each ring keeps its newest
+ * records, so the file covers the last few thousand messages per thread.
+ */
+
+#include "usrl_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-o out.json] [-c] [-x] [-n rings] [-s records] [-r name]\n"
+            "  -o   write Chrome trace JSON here (default stdout)\n"
+            "  -c   create the region (with -n / -s geometry) and exit\n"
+            "  -x   remove the region and exit\n"
+            "  -r   region name (default " USRL_TRACE_SHM ")\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *out = "-";
+    const char *name = USRL_TRACE_SHM;
+    int create = 0, remove = 0;
+    uint32_t rings = 0, records = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:cxn:s:r:h")) != -1) {
+        switch (opt) {
+            case 'o': out = optarg; break;
+            case 'c': create = 1; break;
+            case 'x': remove = 1; break;
+            case 'n': rings = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 's': records = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'r': name = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (remove) {
+        if (shm_unlink(name) != 0) {
+            perror(name);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (create) {
+        if (usrl_trace_open(name, rings, records) != 0) {
+            fprintf(stderr, "usrl-trace: cannot create %s\n", name);
+            return 1;
+        }
+        usrl_trace_close();
+        return 0;
+    }
+
+    int n = usrl_trace_export_chrome(name, out);
+    if (n == -1) {
+        fprintf(stderr, "usrl-trace: no trace region %s\n", name);
+        return 1;
+    }
+    if (n < 0) {
+        perror(out);
+        return 1;
+    }
+    if (strcmp(out, "-") != 0) fprintf(stderr, "usrl-trace: %d records -> %s\n", n, out);
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file usrl_watchdog.c
+ * @brief Liveness watchdog for USRL regions.
+ *
+ * Polls usrl_health_liveness() and reports each change - a participant
+ * going dead, stalled, or stuck mid-claim, and the condition clearing - as
+ * a line on stdout and a UsrlWatchdogEvent on the control topic
+ * (USRL_WATCHDOG_TOPIC, created in the region if there is room). The
+ * topic is MWMR so several watchdogs on one region can all publish to it.
+ *
+ *   usrl-watchdog [-c claim_ms] [-i interval_ms] [-T topic] [region]
+ *
+ * An MWMR claim held longer than claim_ms is flagged within
+ * claim_ms + interval_ms. Heartbeat promises are checked against the
+ * participant's own period, dead pids on every poll.
+ */
+
+#define _GNU_SOURCE
+#include "usrl_core.h"
+#include "usrl_ring.h"
+#include "usrl_health.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/mman.h>
+
+#define SHM_PATH "/usrl_core"
+#define MAX_FINDINGS 1024
+#define EVENT_SLOTS 256
+#define SELF_PERIOD_MS 1000 /* promise for the watchdog's own writer entry */
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *map_region(const char *path, uint64_t *size) {
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    CoreHeader hdr;
+    ssize_t n = read(fd, &hdr, sizeof(hdr));
+    close(fd);
+    if (n != (ssize_t)sizeof(hdr) || hdr.magic != USRL_MAGIC) return NULL;
+    *size = hdr.mmap_size;
+    return usrl_core_map(path, hdr.mmap_size);
+}
+
+/* Same participant in the same condition */
+static int same(const UsrlLiveness *a, const UsrlLiveness *b) {
+    return a->state == b->state && a->role == b->role && a->slot == b->slot &&
+           a->pid == b->pid && strncmp(a->topic, b->topic, USRL_MAX_TOPIC_NAME) == 0;
+}
+
+static int contains(const UsrlLiveness *set, int n, const UsrlLiveness *l) {
+    for (int i = 0; i < n; i++)
+        if (same(&set[i], l)) return 1;
+    return 0;
+}
+
+static const char *state_name(uint32_t s) {
+    switch (s) {
+        case USRL_LIVE_DEAD: return "DEAD";
+        case USRL_LIVE_STALLED: return "STALLED";
+        case USRL_LIVE_CLAIM_STALL: return "CLAIM_STALL";
+        default: return "?";
+    }
+}
+
+static void report(UsrlMwmrPublisher *pub, const UsrlLiveness *l, int cleared, uint64_t t) {
+    if (l->role == USRL_ROLE_WRITER)
+        printf("%s %-11s topic=%s writer=%u pub_id=%u pid=%u claim=%lu age=%.3fms\n",
+               cleared ? "CLEAR" : "RAISE", state_name(l->state), l->topic, l->slot, l->pub_id,
+               l->pid, l->seq, l->age_ns / 1e6);
+    else
+        printf("%s %-11s topic=%s reader=%u pid=%u cursor=%lu age=%.3fms\n",
+               cleared ? "CLEAR" : "RAISE", state_name(l->state), l->topic, l->slot, l->pid,
+               l->seq, l->age_ns / 1e6);
+    fflush(stdout);
+
+    if (!pub->desc) return;
+    UsrlWatchdogEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.time_ns = t;
+    ev.cleared = (uint32_t)cleared;
+    ev.what = *l;
+    usrl_mwmr_pub_publish(pub, &ev, sizeof(ev));
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-c claim_ms] [-i interval_ms] [-T topic] [region]\n"
+            "  -c   flag MWMR claims open longer than this (default 10)\n"
+            "  -i   poll interval (default 10)\n"
+            "  -T   control topic for events (default " USRL_WATCHDOG_TOPIC ")\n"
+            "  region defaults to " SHM_PATH "\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    uint64_t claim_ms = 10;
+    uint64_t interval_ms = 10;
+    const char *topic = USRL_WATCHDOG_TOPIC;
+    const char *path = SHM_PATH;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:i:T:h")) != -1) {
+        switch (opt) {
+            case 'c': claim_ms = strtoull(optarg, NULL, 10); break;
+            case 'i': interval_ms = strtoull(optarg, NULL, 10); break;
+            case 'T': topic = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind < argc) path = argv[optind];
+    if (interval_ms == 0) interval_ms = 1;
+
+    uint64_t size = 0;
+    void *base = map_region(path, &size);
+    if (!base) {
+        fprintf(stderr, "usrl-watchdog: cannot map %s\n", path);
+        return 1;
+    }
+
+    /* Events go to the control topic when the region has room for it */
+    UsrlMwmrPublisher pub;
+    memset(&pub, 0, sizeof(pub));
+    UsrlTopicConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    strncpy(cfg.name, topic, USRL_MAX_TOPIC_NAME - 1);
+    cfg.slot_count = EVENT_SLOTS;
+    cfg.slot_size = sizeof(UsrlWatchdogEvent);
+    cfg.type = USRL_RING_TYPE_MWMR;
+    int rc = usrl_core_add_topic(base, &cfg);
+    if (rc == 0 || rc == 1) {
+        /* Refuses a topic someone else made SWMR: it has a writer already */
+        usrl_mwmr_pub_init(&pub, base, topic, usrl_core_pub_id(base));
+        if (!pub.desc)
+            fprintf(stderr, "usrl-watchdog: topic '%s' is not MWMR; events on stdout only\n",
+                    topic);
+    } else {
+        fprintf(stderr, "usrl-watchdog: no room for topic '%s' (rc=%d); events on stdout only\n",
+                topic, rc);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    printf("usrl-watchdog: %s claim>%lums every %lums -> %s\n", path, claim_ms, interval_ms,
+           pub.desc ? topic : "stdout");
+    fflush(stdout);
+
+    static UsrlLiveness prev[MAX_FINDINGS], cur[MAX_FINDINGS];
+    int nprev = 0;
+    struct timespec nap = {(time_t)(interval_ms / 1000), (long)(interval_ms % 1000) * 1000000L};
+
+    while (!g_stop) {
+        if (pub.writer) usrl_heartbeat(&pub.writer->hb, SELF_PERIOD_MS);
+
+        int found = usrl_health_liveness(base, claim_ms, cur, MAX_FINDINGS);
+        if (found < 0) {
+            fprintf(stderr, "usrl-watchdog: region %s is no longer valid\n", path);
+            break;
+        }
+        int ncur = found < MAX_FINDINGS ? found : MAX_FINDINGS;
+        uint64_t t = now_ns();
+
+        for (int i = 0; i < ncur; i++)
+            if (!contains(prev, nprev, &cur[i])) report(&pub, &cur[i], 0, t);
+        for (int i = 0; i < nprev; i++)
+            if (!contains(cur, ncur, &prev[i])) report(&pub, &prev[i], 1, t);
+
+        memcpy(prev, cur, (size_t)ncur * sizeof(cur[0]));
+        nprev = ncur;
+        nanosleep(&nap, NULL);
+    }
+
+    if (pub.writer) usrl_writer_detach(base, usrl_get_topic(base, topic), pub.writer);
+    usrl_core_unmap(base, size);
+    return 0;
+}
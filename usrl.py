@@ -49,14 +49,18 @@ USRL_RING_MWMR = 1
 USRL_RING_NO_DATA = -11
 
 class UsrlSysConfig(Structure):
-    _fields_ = [("app_name", c_char_p), ("log_level", c_int), ("log_file_path", c_char_p)]
+    _fields_ = [
+        ("app_name", c_char_p), ("log_level", c_int), ("log_file_path", c_char_p),
+        ("log_buffer_kb", c_uint32),
+        ("shm_region", c_char_p), ("shm_region_size_mb", c_uint32), ("max_topics", c_uint32)
+    ]
 
 class UsrlPubConfig(Structure):
     _fields_ = [
         ("topic", c_char_p), ("ring_type", c_int),
         ("slot_count", c_uint32), ("slot_size", c_uint32),
         ("rate_limit_hz", c_uint64), ("block_on_full", c_bool),
-        ("schema_name", c_char_p)
+        ("schema_name", c_char_p), ("rate_burst", c_uint32)
     ]
 
 class UsrlHealth(Structure):
@@ -65,6 +69,13 @@ class UsrlHealth(Structure):
         ("rate_hz", c_uint64), ("lag", c_uint64), ("healthy", c_bool)
     ]
 
+class UsrlLatency(Structure):
+    _fields_ = [
+        ("count", c_uint64), ("mean_ns", c_uint64), ("p50_ns", c_uint64),
+        ("p90_ns", c_uint64), ("p99_ns", c_uint64), ("p999_ns", c_uint64),
+        ("max_ns", c_uint64)
+    ]
+
 # Opaque Handles
 UsrlCtxPtr = c_void_p
 UsrlPubPtr = c_void_p
@@ -94,6 +105,9 @@ _lib.usrl_pub_send.restype = c_int
 _lib.usrl_pub_get_health.argtypes = [UsrlPubPtr, POINTER(UsrlHealth)]
 _lib.usrl_pub_get_health.restype = None
 
+_lib.usrl_pub_heartbeat.argtypes = [UsrlPubPtr, c_uint32]
+_lib.usrl_pub_heartbeat.restype = c_int
+
 _lib.usrl_pub_destroy.argtypes = [UsrlPubPtr]
 _lib.usrl_pub_destroy.restype = None
 
@@ -104,9 +118,21 @@ _lib.usrl_sub_create.restype = UsrlSubPtr
 _lib.usrl_sub_recv.argtypes = [UsrlSubPtr, c_void_p, c_uint32]
 _lib.usrl_sub_recv.restype = c_int
 
+_lib.usrl_sub_recv_columnar.argtypes = [UsrlSubPtr, POINTER(c_void_p), c_uint32]
+_lib.usrl_sub_recv_columnar.restype = c_int
+
 _lib.usrl_sub_get_health.argtypes = [UsrlSubPtr, POINTER(UsrlHealth)]
 _lib.usrl_sub_get_health.restype = None
 
+_lib.usrl_sub_enable_latency.argtypes = [UsrlSubPtr]
+_lib.usrl_sub_enable_latency.restype = c_int
+
+_lib.usrl_sub_get_latency_histogram.argtypes = [UsrlSubPtr, POINTER(UsrlLatency)]
+_lib.usrl_sub_get_latency_histogram.restype = c_int
+
+_lib.usrl_sub_heartbeat.argtypes = [UsrlSubPtr, c_uint32]
+_lib.usrl_sub_heartbeat.restype = c_int
+
 _lib.usrl_sub_destroy.argtypes = [UsrlSubPtr]
 _lib.usrl_sub_destroy.restype = None
 
@@ -120,11 +146,16 @@ if hasattr(_lib, 'usrl_schema_validate'):
 # ============================================================================
 
 class USRL:
-    def __init__(self, app_name="py_usrl", log_level=1, log_file_path=None):
+    def __init__(self, app_name="py_usrl", log_level=1, log_file_path=None,
+                 region=None, region_size_mb=0, max_topics=0, log_buffer_kb=0):
         self._cfg = UsrlSysConfig(
             app_name.encode('utf-8') if app_name is not None else None,
             int(log_level),
-            log_file_path.encode('utf-8') if log_file_path else None
+            log_file_path.encode('utf-8') if log_file_path else None,
+            int(log_buffer_kb),
+            region.encode('utf-8') if region else None,
+            int(region_size_mb),
+            int(max_topics)
         )
         self._ctx = _lib.usrl_init(byref(self._cfg))
         if not self._ctx:
@@ -132,8 +163,9 @@ class USRL:
         self.publishers = []
         self.subscribers = []
 
-    def publisher(self, topic, slots=4096, size=1024, rate_hz=0, block=False, mwmr=False, schema=None):
-        pub = Publisher(self._ctx, topic, slots, size, rate_hz, block, mwmr, schema)
+    def publisher(self, topic, slots=4096, size=1024, rate_hz=0, block=False, mwmr=False, schema=None,
+                  burst=0):
+        pub = Publisher(self._ctx, topic, slots, size, rate_hz, block, mwmr, schema, burst)
         self.publishers.append(pub)
         return pub
 
@@ -167,7 +199,7 @@ class USRL:
 
 
 class Publisher:
-    def __init__(self, ctx, topic, slots, size, rate_hz, block, mwmr, schema):
+    def __init__(self, ctx, topic, slots, size, rate_hz, block, mwmr, schema, burst=0):
         self._cfg = UsrlPubConfig()
         # store bytes so they remain alive while the C call uses the pointer ephemeral buffer
         self._topic_b = topic.encode('utf-8')
@@ -178,6 +210,7 @@ class Publisher:
         self._cfg.rate_limit_hz = int(rate_hz)
         self._cfg.block_on_full = bool(block)
         self._cfg.schema_name = schema.encode('utf-8') if schema else None
+        self._cfg.rate_burst = int(burst)
 
         self._handle = _lib.usrl_pub_create(ctx, byref(self._cfg))
         if not self._handle:
@@ -244,6 +277,10 @@ class Publisher:
             "rate": int(h.rate_hz), "healthy": bool(h.healthy)
         }
 
+    def heartbeat(self, period_ms=0):
+        """Beat for usrl-watchdog; promise the next within period_ms (0 = no promise)."""
+        return _lib.usrl_pub_heartbeat(self._handle, period_ms) == 0
+
     def destroy(self):
         if getattr(self, "_handle", None):
             _lib.usrl_pub_destroy(self._handle)
@@ -306,6 +343,26 @@ class Subscriber:
             return None
         return None
 
+    def recv_columns(self, dtype, max_rows=4096):
+        """
+        Receive up to max_rows messages of a topic with a schema, as one NumPy
+        array per field: {name: array}. dtype lists the schema's fields in
+        order (the `dtype` of a usrl-schemac generated module).
+        Returns None if no data. The arrays are reused by the next call.
+        """
+        import numpy as np
+        key = (dtype, max_rows)
+        if getattr(self, "_cols_key", None) != key:
+            self._cols = [np.empty(max_rows, dtype=dtype.fields[n][0]) for n in dtype.names]
+            self._col_ptrs = (c_void_p * len(self._cols))(*[c.ctypes.data for c in self._cols])
+            self._cols_key = key
+        ret = _lib.usrl_sub_recv_columnar(self._handle, self._col_ptrs, max_rows)
+        if ret < 0:
+            raise RuntimeError("Topic has no schema")
+        if ret == 0:
+            return None
+        return {n: c[:ret] for n, c in zip(dtype.names, self._cols)}
+
     def stats(self):
         h = UsrlHealth()
         _lib.usrl_sub_get_health(self._handle, byref(h))
@@ -314,6 +371,21 @@ class Subscriber:
             "lag": int(h.lag), "healthy": bool(h.healthy)
         }
 
+    def enable_latency(self):
+        """Record publish-to-consume latency for every message received."""
+        return _lib.usrl_sub_enable_latency(self._handle) == 0
+
+    def latency(self):
+        """Latency percentiles in ns, or None if tracking is not enabled."""
+        l = UsrlLatency()
+        if _lib.usrl_sub_get_latency_histogram(self._handle, byref(l)) != 0:
+            return None
+        return {f: int(getattr(l, f)) for f, _ in UsrlLatency._fields_}
+
+    def heartbeat(self, period_ms=0):
+        """Beat for usrl-watchdog; promise the next within period_ms (0 = no promise)."""
+        return _lib.usrl_sub_heartbeat(self._handle, period_ms) == 0
+
     def destroy(self):
         if getattr(self, "_handle", None):
             _lib.usrl_sub_destroy(self._handle)